@@ -0,0 +1,46 @@
+#include <sstream>
+
+#include <openanim/Loaders/Asf.h>
+
+#include "Benchmark.h"
+
+BENCHMARK(asf) {
+	if(!context.enabled("amc/load"))
+		return;
+
+	// a chain of 30 bones, and 20000 frames of their motion
+	const unsigned boneCount = 30;
+	const unsigned frameCount = 20000;
+
+	std::stringstream skeleton;
+	skeleton << ":units" << std::endl << "angle deg" << std::endl;
+	skeleton << ":root" << std::endl << "order TX TY TZ RX RY RZ" << std::endl << "axis XYZ" << std::endl;
+	skeleton << ":bonedata" << std::endl;
+	for(unsigned b = 0; b < boneCount; ++b)
+		skeleton << "begin" << std::endl << "name bone_" << b << std::endl << "direction 0 1 0" << std::endl
+			<< "length 2.5" << std::endl << "axis 0 0 " << b * 3 << " XYZ" << std::endl << "dof rx ry rz" << std::endl << "end" << std::endl;
+	skeleton << ":hierarchy" << std::endl << "begin" << std::endl << "root bone_0" << std::endl;
+	for(unsigned b = 1; b < boneCount; ++b)
+		skeleton << "bone_" << b - 1 << " bone_" << b << std::endl;
+	skeleton << "end" << std::endl;
+
+	const std::string asfText = skeleton.str();
+	const openanim::Asf asf(asfText.c_str(), asfText.size());
+
+	std::stringstream motion;
+	motion << ":FULLY-SPECIFIED" << std::endl << ":DEGREES" << std::endl;
+	motion.setf(std::ios::fixed);
+	for(unsigned f = 0; f < frameCount; ++f) {
+		motion << f + 1 << std::endl;
+		motion << "root " << (float)f * 0.1f << " 17.5 " << -(float)f * 0.05f << " 0.0 " << (float)(f % 360) << " 0.0" << std::endl;
+		for(unsigned b = 0; b < boneCount; ++b)
+			motion << "bone_" << b << " " << (float)((f + b) % 360) - 180.0f << " " << (float)(b % 7) * 1.5f << " " << -(float)(f % 90) * 0.25f << std::endl;
+	}
+
+	const std::string amcText = motion.str();
+
+	context.measure("amc/load", [&]() {
+		const openanim::AnimationClip clip = asf.loadMotion(amcText.c_str(), amcText.size());
+		benchmarks::consume(clip.keyCount());
+	});
+}
@@ -0,0 +1,44 @@
+#include <sstream>
+
+#include <openanim/ClipBuilder.h>
+#include <openanim/Asset.h>
+
+#include "Benchmark.h"
+#include "Rig.h"
+
+BENCHMARK(asset) {
+	if(!context.enabled("asset/load"))
+		return;
+
+	// an asset of 32 clips of a 200-joint rig
+	const openanim::Skeleton rig = benchmarks::makeRig(200);
+
+	std::vector<openanim::AnimationClip> clips;
+	for(unsigned c = 0; c < 32; ++c) {
+		openanim::ClipBuilder builder(rig.pose().sharedHierarchy(), 30.0f);
+
+		openanim::Pose pose = rig.pose();
+		for(unsigned f = 0; f < 30; ++f) {
+			for(std::size_t ji = 0; ji < pose.size(); ++ji)
+				pose[ji] = benchmarks::randomTransform();
+			builder.addFrame(pose);
+		}
+
+		clips.push_back(builder.build());
+	}
+
+	std::vector<const openanim::AnimationClip*> pointers;
+	for(auto& c : clips)
+		pointers.push_back(&c);
+
+	std::stringstream stream;
+	openanim::Asset::write(stream, rig.pose(), pointers.data(), pointers.size());
+	const std::string image = stream.str();
+	const std::vector<char, openanim::AlignedAllocator<char>> data(image.begin(), image.end());
+
+	// loading from memory - the validation and the setup of all objects, without any I/O
+	context.measure("asset/load", [&]() {
+		const openanim::Asset asset(data.data(), data.size());
+		benchmarks::consume(asset.clipCount());
+	});
+}
@@ -0,0 +1,42 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+
+namespace benchmarks {
+
+namespace {
+	std::vector<std::pair<std::string, Function>>& functions() {
+		static std::vector<std::pair<std::string, Function>> s_functions;
+		return s_functions;
+	}
+}
+
+Registration::Registration(const char* name, const Function& fn) {
+	functions().push_back(std::make_pair(std::string(name), fn));
+}
+
+const std::vector<std::pair<std::string, Function>>& registry() {
+	return functions();
+}
+
+////////
+
+Context::Context(const std::string& filter, double minTime, unsigned repeats) : m_filter(filter), m_minTime(minTime), m_repeats(repeats) {
+}
+
+bool Context::enabled(const std::string& name) const {
+	return m_filter.empty() || name.find(m_filter) != std::string::npos;
+}
+
+const std::vector<Result>& Context::results() const {
+	return m_results;
+}
+
+void Context::record(const std::string& name, std::size_t iterations, std::vector<double>& times) {
+	std::sort(times.begin(), times.end());
+	const double median = times[times.size() / 2];
+
+	m_results.push_back(Result{name, iterations, median / (double)iterations * 1e9});
+}
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+
+namespace benchmarks {
+
+/// result of a single measurement
+struct Result {
+	std::string name;
+	std::size_t iterations;
+	/// median time of one iteration, in nanoseconds
+	double nanoseconds;
+};
+
+/// Runs measurements of a benchmark and collects their results. Each measured operation is first
+/// calibrated (the number of iterations is doubled until the minimum time is reached), and then
+/// timed repeatedly; the median of the repeats is reported.
+class Context {
+	public:
+		Context(const std::string& filter, double minTime, unsigned repeats);
+
+		/// measures an operation, reporting its time under the given name
+		template<typename FN>
+		void measure(const std::string& name, FN fn);
+
+		/// returns true if a measurement of this name will be run (allows to skip expensive setup)
+		bool enabled(const std::string& name) const;
+
+		const std::vector<Result>& results() const;
+
+	protected:
+	private:
+		template<typename FN>
+		double run(FN& fn, std::size_t iterations);
+
+		void record(const std::string& name, std::size_t iterations, std::vector<double>& times);
+
+		std::string m_filter;
+		double m_minTime;
+		unsigned m_repeats;
+
+		std::vector<Result> m_results;
+};
+
+/// a registered benchmark function
+typedef std::function<void(Context&)> Function;
+
+/// registers a benchmark function (used by the BENCHMARK macro)
+struct Registration {
+	Registration(const char* name, const Function& fn);
+};
+
+/// all registered benchmarks, in the order of registration
+const std::vector<std::pair<std::string, Function>>& registry();
+
+/// prevents the compiler from optimizing away the computation of a value
+template<typename T>
+inline void consume(const T& value) {
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+////
+
+template<typename FN>
+double Context::run(FN& fn, std::size_t iterations) {
+	const auto begin = std::chrono::steady_clock::now();
+	for(std::size_t i = 0; i < iterations; ++i)
+		fn();
+	const auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double>(end - begin).count();
+}
+
+template<typename FN>
+void Context::measure(const std::string& name, FN fn) {
+	if(!enabled(name))
+		return;
+
+	// calibration - the number of iterations needed to reach the minimum time
+	std::size_t iterations = 1;
+	double time = run(fn, iterations);
+	while(time < m_minTime) {
+		iterations = time > 0.0 ? std::max(iterations * 2, (std::size_t)((double)iterations * m_minTime / time * 1.2)) : iterations * 2;
+		time = run(fn, iterations);
+	}
+
+	std::vector<double> times;
+	for(unsigned r = 0; r < m_repeats; ++r)
+		times.push_back(run(fn, iterations));
+
+	record(name, iterations, times);
+}
+
+}
+
+#define BENCHMARK(NAME) \
+	static void NAME(benchmarks::Context& context); \
+	static benchmarks::Registration NAME##_registration(#NAME, &NAME); \
+	static void NAME(benchmarks::Context& context)
@@ -0,0 +1,40 @@
+#include <sstream>
+
+#include <openanim/Loaders/Bvh.h>
+
+#include "Benchmark.h"
+
+BENCHMARK(bvh) {
+	if(!context.enabled("bvh/load"))
+		return;
+
+	// a chain of 60 joints, 1000 frames of 3 rotation channels each (plus the root position)
+	const unsigned jointCount = 60;
+	const unsigned frameCount = 1000;
+
+	std::stringstream text;
+	text << "HIERARCHY" << std::endl;
+	for(unsigned j = 0; j < jointCount; ++j) {
+		text << (j == 0 ? "ROOT" : "JOINT") << " joint_" << j << std::endl << "{" << std::endl;
+		text << "OFFSET 0.000000 12.500000 0.000000" << std::endl;
+		text << "CHANNELS " << (j == 0 ? "6 Xposition Yposition Zposition " : "3 ") << "Zrotation Xrotation Yrotation" << std::endl;
+	}
+	for(unsigned j = 0; j < jointCount; ++j)
+		text << "}" << std::endl;
+
+	text << "MOTION" << std::endl << "Frames: " << frameCount << std::endl << "Frame Time: 0.008333" << std::endl;
+	text.setf(std::ios::fixed);
+	for(unsigned f = 0; f < frameCount; ++f) {
+		text << (float)f * 0.1f << " 90.000000 " << -(float)f * 0.05f;
+		for(unsigned j = 0; j < jointCount; ++j)
+			text << " " << (float)((f + j) % 360) - 180.0f << " " << (float)(j % 7) * 1.5f << " " << -(float)(f % 90) * 0.25f;
+		text << std::endl;
+	}
+
+	const std::string data = text.str();
+
+	context.measure("bvh/load", [&]() {
+		const openanim::Bvh bvh(data.c_str(), data.size());
+		benchmarks::consume(bvh.clip().keyCount());
+	});
+}
@@ -0,0 +1,29 @@
+#include <sstream>
+
+#include <openanim/HalfPose.h>
+
+#include "Benchmark.h"
+#include "Rig.h"
+
+BENCHMARK(half_pose) {
+	for(unsigned size : benchmarks::s_rigSizes) {
+		std::stringstream suffix;
+		suffix << "/" << size;
+
+		if(!context.enabled("half_pose/compress" + suffix.str()) && !context.enabled("half_pose/decompress" + suffix.str()))
+			continue;
+
+		const openanim::Skeleton rig = benchmarks::makeRig(size);
+
+		openanim::HalfPose compressed(rig.pose());
+		openanim::Pose pose = rig.pose();
+
+		context.measure("half_pose/compress" + suffix.str(), [&]() {
+			compressed.compress(rig.pose());
+		});
+
+		context.measure("half_pose/decompress" + suffix.str(), [&]() {
+			compressed.decompress(pose);
+		});
+	}
+}
@@ -0,0 +1,133 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include <cstdlib>
+
+#include <boost/program_options.hpp>
+
+#include "Benchmark.h"
+
+using std::cout;
+using std::endl;
+
+namespace po = boost::program_options;
+
+namespace {
+	/// writes results as tab-separated values (name, iterations, nanoseconds per iteration)
+	void write(std::ostream& out, const std::vector<benchmarks::Result>& results) {
+		out << "# name\titerations\tns" << endl;
+		for(auto& r : results)
+			out << r.name << '\t' << r.iterations << '\t' << std::fixed << std::setprecision(3) << r.nanoseconds << endl;
+	}
+
+	/// reads results written by write()
+	std::map<std::string, double> read(std::istream& in) {
+		std::map<std::string, double> result;
+
+		std::string line;
+		while(std::getline(in, line)) {
+			if(line.empty() || line[0] == '#')
+				continue;
+
+			std::stringstream ss(line);
+			std::string name;
+			std::size_t iterations;
+			double ns;
+			if(ss >> name >> iterations >> ns)
+				result[name] = ns;
+		}
+
+		return result;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	po::options_description desc("Allowed options");
+	desc.add_options()
+		("help", "produce help message")
+		("list", "list all benchmarks")
+		("filter", po::value<std::string>()->default_value(""), "run only measurements with names containing this string")
+		("min-time", po::value<double>()->default_value(0.1), "minimum time of a single timed run (seconds)")
+		("repeats", po::value<unsigned>()->default_value(5), "number of timed runs of each measurement (the median is reported)")
+		("output", po::value<std::string>(), "write the results to a file (in addition to the standard output)")
+		("baseline", po::value<std::string>(), "compare the results with a previously written output file")
+		("threshold", po::value<double>()->default_value(0.1), "relative slowdown reported as a regression in the baseline comparison")
+	;
+
+	po::variables_map vm;
+	try {
+		po::store(po::parse_command_line(argc, argv, desc), vm);
+		po::notify(vm);
+	}
+	catch(std::exception& e) {
+		std::cerr << e.what() << endl << endl << desc << endl;
+		return 1;
+	}
+
+	if(vm.count("help")) {
+		cout << desc << endl;
+		return 0;
+	}
+
+	if(vm.count("list")) {
+		for(auto& b : benchmarks::registry())
+			cout << b.first << endl;
+		return 0;
+	}
+
+	// the synthetic rigs are random, but reproducible
+	srand(0);
+
+	benchmarks::Context context(vm["filter"].as<std::string>(), vm["min-time"].as<double>(), vm["repeats"].as<unsigned>());
+	for(auto& b : benchmarks::registry())
+		b.second(context);
+
+	write(cout, context.results());
+
+	if(vm.count("output")) {
+		std::ofstream out(vm["output"].as<std::string>().c_str());
+		if(!out.good()) {
+			std::cerr << "cannot write " << vm["output"].as<std::string>() << endl;
+			return 1;
+		}
+		write(out, context.results());
+	}
+
+	if(vm.count("baseline")) {
+		std::ifstream in(vm["baseline"].as<std::string>().c_str());
+		if(!in.good()) {
+			std::cerr << "cannot read " << vm["baseline"].as<std::string>() << endl;
+			return 1;
+		}
+		const std::map<std::string, double> baseline = read(in);
+		const double threshold = vm["threshold"].as<double>();
+
+		unsigned regressions = 0;
+
+		cout << endl << "# name\tbaseline_ns\tns\tratio" << endl;
+		for(auto& r : context.results()) {
+			auto it = baseline.find(r.name);
+			if(it == baseline.end()) {
+				cout << r.name << "\t-\t" << r.nanoseconds << "\t-" << endl;
+				continue;
+			}
+
+			const double ratio = r.nanoseconds / it->second;
+			cout << r.name << '\t' << it->second << '\t' << r.nanoseconds << '\t' << ratio;
+			if(ratio > 1.0 + threshold) {
+				cout << "\tREGRESSION";
+				++regressions;
+			}
+			cout << endl;
+		}
+
+		if(regressions > 0) {
+			cout << endl << regressions << " regression(s) found" << endl;
+			return 2;
+		}
+	}
+
+	return 0;
+}
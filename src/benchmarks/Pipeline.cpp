@@ -0,0 +1,84 @@
+#include <sstream>
+
+#include <openanim/Skeleton.h>
+#include <openanim/ClipBuilder.h>
+#include <openanim/ClipSampler.h>
+#include <openanim/Blending.h>
+#include <openanim/Kinematics.h>
+#include <openanim/Palette.h>
+
+#include "Benchmark.h"
+#include "Rig.h"
+
+namespace {
+	openanim::AnimationClip makeClip(const openanim::Skeleton& rig, unsigned frames) {
+		openanim::ClipBuilder builder(rig.pose().sharedHierarchy(), 30.0f);
+
+		openanim::Pose pose = rig.pose();
+		for(unsigned f = 0; f < frames; ++f) {
+			for(std::size_t ji = 0; ji < pose.size(); ++ji)
+				pose[ji] = benchmarks::randomTransform();
+			builder.addFrame(pose);
+		}
+
+		return builder.build();
+	}
+}
+
+BENCHMARK(pose_pipeline) {
+	for(unsigned size : benchmarks::s_rigSizes) {
+		std::stringstream suffix;
+		suffix << "/" << size;
+
+		// the setup is expensive - skip it if no measurement of this size is enabled
+		bool enabled = false;
+		for(const char* stage : {"sample", "blend", "local_to_world", "palette", "frame"})
+			enabled |= context.enabled(std::string("pipeline/") + stage + suffix.str());
+		if(!enabled)
+			continue;
+
+		const openanim::Skeleton rig = benchmarks::makeRig(size);
+		const openanim::AnimationClip walk = makeClip(rig, 30);
+		const openanim::AnimationClip run = makeClip(rig, 30);
+
+		const openanim::Kinematics kinematics(rig.pose().hierarchy());
+		const openanim::Palette palette(rig.worldPose());
+
+		openanim::ClipSampler walkSampler(walk), runSampler(run);
+		walkSampler.setLooping(true);
+		runSampler.setLooping(true);
+
+		openanim::Pose p1 = rig.pose(), p2 = rig.pose(), local = rig.pose(), world = rig.pose();
+		std::vector<float> matrices(size * openanim::Palette::s_matrixSize);
+
+		float time = 0.0f;
+
+		context.measure("pipeline/sample" + suffix.str(), [&]() {
+			walkSampler.sample(time, p1);
+			time += 1.0f / 60.0f;
+		});
+
+		context.measure("pipeline/blend" + suffix.str(), [&]() {
+			openanim::blend(p1, p2, 0.3f, local);
+		});
+
+		context.measure("pipeline/local_to_world" + suffix.str(), [&]() {
+			kinematics.localToWorld(local, world);
+		});
+
+		context.measure("pipeline/palette" + suffix.str(), [&]() {
+			palette.writeMatrices(world, matrices.data());
+		});
+
+		// the whole frame - two clips sampled and blended, forward kinematics and the skinning palette
+		context.measure("pipeline/frame" + suffix.str(), [&]() {
+			walkSampler.sample(time, p1);
+			runSampler.sample(time, p2);
+			openanim::blend(p1, p2, 0.3f, local);
+			kinematics.localToWorld(local, world);
+			palette.writeMatrices(world, matrices.data());
+
+			time += 1.0f / 60.0f;
+		});
+	}
+}
@@ -0,0 +1,38 @@
+#include <sstream>
+
+#include <openanim/Skeleton.h>
+#include <openanim/PoseArena.h>
+#include <openanim/Blending.h>
+
+#include "Benchmark.h"
+#include "Rig.h"
+
+BENCHMARK(pose_arena) {
+	for(unsigned size : benchmarks::s_rigSizes) {
+		std::stringstream suffix;
+		suffix << "/" << size;
+
+		if(!context.enabled("pose_arena/heap" + suffix.str()) && !context.enabled("pose_arena/arena" + suffix.str()))
+			continue;
+
+		const openanim::Skeleton rig = benchmarks::makeRig(size);
+		const auto& hierarchy = rig.pose().sharedHierarchy();
+
+		// a frame's worth of transient poses - two intermediates and a blended result
+		context.measure("pose_arena/heap" + suffix.str(), [&]() {
+			openanim::Pose p1(rig.pose()), p2(hierarchy), result(hierarchy);
+			openanim::blend(p1, p2, 0.5f, result);
+			benchmarks::consume(result.translations());
+		});
+
+		openanim::PoseArena arena;
+		context.measure("pose_arena/arena" + suffix.str(), [&]() {
+			{
+				openanim::Pose p1(rig.pose(), arena), p2(hierarchy, arena), result(hierarchy, arena);
+				openanim::blend(p1, p2, 0.5f, result);
+				benchmarks::consume(result.translations());
+			}
+			arena.reset();
+		});
+	}
+}
@@ -0,0 +1,39 @@
+#include "Rig.h"
+
+#include <sstream>
+
+#include <ImathEuler.h>
+
+namespace benchmarks {
+
+const unsigned s_rigSizes[4] = {50, 200, 1000, 5000};
+
+openanim::Transform randomTransform() {
+	const Imath::Eulerf angles(
+		(float)(rand() % 628) / 100.0f,
+		(float)(rand() % 628) / 100.0f,
+		(float)(rand() % 628) / 100.0f);
+	const Imath::V3f translation(
+		(float)(rand() % 200 - 100) / 10.0f,
+		(float)(rand() % 200 - 100) / 10.0f,
+		(float)(rand() % 200 - 100) / 10.0f);
+
+	return openanim::Transform(angles.toQuat(), translation);
+}
+
+openanim::Skeleton makeRig(unsigned jointCount) {
+	std::vector<openanim::Skeleton::Entry> table;
+	table.reserve(jointCount);
+
+	table.push_back(openanim::Skeleton::Entry{"root", -1, randomTransform()});
+	for(unsigned a = 1; a < jointCount; ++a) {
+		std::stringstream name;
+		name << "joint_" << a;
+
+		table.push_back(openanim::Skeleton::Entry{name.str(), rand() % (int)a, randomTransform()});
+	}
+
+	return openanim::Skeleton(table);
+}
+
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <openanim/Skeleton.h>
+
+namespace benchmarks {
+
+/// a random rigid transformation
+openanim::Transform randomTransform();
+
+/// a synthetic rig - a random tree of jointCount joints with random transformations
+openanim::Skeleton makeRig(unsigned jointCount);
+
+/// joint counts of the synthetic rigs used by the scaling benchmarks
+extern const unsigned s_rigSizes[4];
+
+}
@@ -0,0 +1,86 @@
+#include <sstream>
+
+#include <openanim/Skeleton.h>
+
+#include "Benchmark.h"
+#include "Rig.h"
+
+BENCHMARK(hierarchy_edits) {
+	for(unsigned size : benchmarks::s_rigSizes) {
+		// the names and parents are generated upfront, to measure only the hierarchy operations
+		std::vector<std::string> names(size);
+		std::vector<int> parents(size, -1);
+		for(unsigned a = 0; a < size; ++a) {
+			std::stringstream name;
+			name << "joint_" << a;
+			names[a] = name.str();
+			if(a > 0)
+				parents[a] = rand() % a;
+		}
+
+		std::stringstream suffix;
+		suffix << "/" << size;
+
+		// incremental edits are quadratic - only the smaller rigs
+		if(size <= 1000) {
+			context.measure("hierarchy/add_child" + suffix.str(), [&]() {
+				openanim::Hierarchy h;
+				h.addRoot(names[0]);
+
+				// a random parent among the existing items (their indices shift with each insertion)
+				for(unsigned a = 1; a < size; ++a)
+					h.addChild(h[parents[a]], names[a]);
+
+				benchmarks::consume(h.size());
+			});
+
+			context.measure("skeleton/add_child" + suffix.str(), [&]() {
+				openanim::Skeleton s;
+				s.addRoot(names[0], openanim::Transform());
+
+				for(unsigned a = 1; a < size; ++a)
+					s.addChild(s[parents[a]], openanim::Transform(), names[a]);
+
+				benchmarks::consume(s.size());
+			});
+		}
+
+		context.measure("hierarchy/bulk" + suffix.str(), [&]() {
+			const openanim::Hierarchy h(names, parents);
+			benchmarks::consume(h.size());
+		});
+
+		context.measure("skeleton/edit" + suffix.str(), [&]() {
+			openanim::Skeleton s;
+			s.addRoot(names[0], openanim::Transform());
+			{
+				openanim::Skeleton::Edit edit(s);
+				for(unsigned a = 1; a < size; ++a)
+					edit.addChild(parents[a], openanim::Transform(), names[a]);
+			}
+
+			benchmarks::consume(s.size());
+		});
+	}
+}
+
+BENCHMARK(skeleton_copy) {
+	for(unsigned size : benchmarks::s_rigSizes) {
+		std::stringstream suffix;
+		suffix << "/" << size;
+
+		const openanim::Skeleton source = benchmarks::makeRig(size);
+
+		context.measure("skeleton/copy" + suffix.str(), [&]() {
+			const openanim::Skeleton copy(source);
+			benchmarks::consume(copy.size());
+		});
+
+		openanim::Skeleton moved = source;
+		context.measure("skeleton/move" + suffix.str(), [&]() {
+			openanim::Skeleton tmp(std::move(moved));
+			moved = std::move(tmp);
+			benchmarks::consume(moved.size());
+		});
+	}
+}
@@ -0,0 +1,28 @@
+#include <openanim/Transform.h>
+
+#include "Benchmark.h"
+#include "Rig.h"
+
+BENCHMARK(transform) {
+	// a small set of transformations, to keep the data in the cache
+	std::vector<openanim::Transform> transforms;
+	for(unsigned a = 0; a < 64; ++a)
+		transforms.push_back(benchmarks::randomTransform());
+
+	std::size_t index = 0;
+
+	context.measure("transform/multiply", [&]() {
+		benchmarks::consume(transforms[index % 64] * transforms[(index + 1) % 64]);
+		++index;
+	});
+
+	context.measure("transform/to_matrix44", [&]() {
+		benchmarks::consume(transforms[index % 64].toMatrix44());
+		++index;
+	});
+
+	context.measure("transform/inverse", [&]() {
+		benchmarks::consume(transforms[index % 64].inverse());
+		++index;
+	});
+}
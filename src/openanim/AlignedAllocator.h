@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace openanim {
+
+/// a minimal std::allocator replacement returning memory aligned to ALIGNMENT bytes.
+/// Used for contiguous arrays of joint data, to allow aligned SIMD loads.
+template<typename T, std::size_t ALIGNMENT = 32>
+class AlignedAllocator {
+	public:
+		typedef T value_type;
+		typedef T* pointer;
+		typedef const T* const_pointer;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef std::size_t size_type;
+		typedef std::ptrdiff_t difference_type;
+
+		template<typename U>
+		struct rebind {
+			typedef AlignedAllocator<U, ALIGNMENT> other;
+		};
+
+		AlignedAllocator();
+		template<typename U>
+		AlignedAllocator(const AlignedAllocator<U, ALIGNMENT>& a);
+
+		T* allocate(std::size_t n);
+		void deallocate(T* ptr, std::size_t n);
+
+		bool operator == (const AlignedAllocator& a) const;
+		bool operator != (const AlignedAllocator& a) const;
+
+		static_assert((ALIGNMENT & (ALIGNMENT-1)) == 0, "alignment has to be a power of two");
+		static_assert(ALIGNMENT >= sizeof(void*), "alignment has to be large enough to store a pointer");
+};
+
+////
+
+template<typename T, std::size_t ALIGNMENT>
+AlignedAllocator<T, ALIGNMENT>::AlignedAllocator() {
+}
+
+template<typename T, std::size_t ALIGNMENT>
+template<typename U>
+AlignedAllocator<T, ALIGNMENT>::AlignedAllocator(const AlignedAllocator<U, ALIGNMENT>& a) {
+}
+
+template<typename T, std::size_t ALIGNMENT>
+T* AlignedAllocator<T, ALIGNMENT>::allocate(std::size_t n) {
+	// over-allocate, and store the original pointer just in front of the aligned block
+	char* raw = static_cast<char*>(::operator new(n * sizeof(T) + ALIGNMENT));
+	char* aligned = reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(raw) + ALIGNMENT) & ~(std::uintptr_t)(ALIGNMENT-1));
+	reinterpret_cast<void**>(aligned)[-1] = raw;
+
+	return reinterpret_cast<T*>(aligned);
+}
+
+template<typename T, std::size_t ALIGNMENT>
+void AlignedAllocator<T, ALIGNMENT>::deallocate(T* ptr, std::size_t n) {
+	if(ptr != NULL)
+		::operator delete(reinterpret_cast<void**>(ptr)[-1]);
+}
+
+template<typename T, std::size_t ALIGNMENT>
+bool AlignedAllocator<T, ALIGNMENT>::operator == (const AlignedAllocator& a) const {
+	return true;
+}
+
+template<typename T, std::size_t ALIGNMENT>
+bool AlignedAllocator<T, ALIGNMENT>::operator != (const AlignedAllocator& a) const {
+	return false;
+}
+
+}
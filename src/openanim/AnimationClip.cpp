@@ -0,0 +1,172 @@
+#include "AnimationClip.h"
+
+#include <cassert>
+#include <algorithm>
+
+#include "Quantization.h"
+#include "Instrumentation.h"
+
+namespace openanim {
+
+namespace {
+	// number of keys searched linearly from a cursor, before falling back to binary search
+	static const unsigned s_maxCursorSteps = 4;
+}
+
+AnimationClip::AnimationClip() : m_hierarchy(new Hierarchy()), m_fps(24.0f), m_frameCount(0) {
+}
+
+const Hierarchy& AnimationClip::hierarchy() const {
+	return *m_hierarchy;
+}
+
+const std::shared_ptr<const Hierarchy>& AnimationClip::sharedHierarchy() const {
+	return m_hierarchy;
+}
+
+float AnimationClip::fps() const {
+	return m_fps;
+}
+
+std::size_t AnimationClip::frameCount() const {
+	return m_frameCount;
+}
+
+float AnimationClip::duration() const {
+	if(m_frameCount == 0)
+		return 0.0f;
+	return (float)(m_frameCount - 1) / m_fps;
+}
+
+const AnimationClip::Track& AnimationClip::rotationTrack(std::size_t joint) const {
+	assert(joint < m_rotations.size());
+	return m_rotations[joint];
+}
+
+const AnimationClip::Track& AnimationClip::translationTrack(std::size_t joint) const {
+	assert(joint < m_translations.size());
+	return m_translations[joint];
+}
+
+std::size_t AnimationClip::keyCount() const {
+	return m_times.size();
+}
+
+std::size_t AnimationClip::dataSize() const {
+	return (m_rotations.size() + m_translations.size()) * sizeof(Track) +
+		m_times.size() * sizeof(std::uint32_t) + m_values.size() * sizeof(std::uint16_t);
+}
+
+std::uint32_t AnimationClip::findKey(const Track& track, float frame) const {
+	assert(track.encoding == Quantized);
+	assert(track.keys_end - track.keys_begin >= 2);
+
+	// a key on each frame - no need to search
+	if(track.keys_end - track.keys_begin == m_frameCount)
+		return track.keys_begin + std::min((std::uint32_t)frame, (std::uint32_t)m_frameCount - 2);
+
+	// the last key not after the frame, but never the last key of the track
+	auto it = std::upper_bound(m_times.begin() + track.keys_begin + 1, m_times.begin() + track.keys_end - 1, (std::uint32_t)frame);
+	return (it - m_times.begin()) - 1;
+}
+
+std::uint32_t AnimationClip::seekKey(const Track& track, std::uint32_t cursor, float frame) const {
+	assert(track.encoding == Quantized);
+	assert(cursor >= track.keys_begin && cursor + 1 < track.keys_end);
+
+	const std::uint32_t f = (std::uint32_t)frame;
+
+	// small steps forward (playback) or backward (reverse playback)
+	for(unsigned step = 0; (step < s_maxCursorSteps) && (cursor + 2 < track.keys_end) && (m_times[cursor+1] <= f); ++step)
+		++cursor;
+	for(unsigned step = 0; (step < s_maxCursorSteps) && (cursor > track.keys_begin) && (m_times[cursor] > f); ++step)
+		--cursor;
+
+	if((m_times[cursor] <= f || cursor == track.keys_begin) && (f < m_times[cursor+1] || cursor + 2 == track.keys_end))
+		return cursor;
+
+	// large jumps (scrubbing) need a full search
+	return findKey(track, frame);
+}
+
+Imath::Quatf AnimationClip::rotation(const Track& track, std::uint32_t key, float frame) const {
+	const float weight = (frame - (float)m_times[key]) / (float)(m_times[key+1] - m_times[key]);
+
+	return quantization::nlerp(
+		quantization::decodeRotation(&m_values[key*3]),
+		quantization::decodeRotation(&m_values[(key+1)*3]),
+		weight);
+}
+
+Imath::V3f AnimationClip::translation(const Track& track, std::uint32_t key, float frame) const {
+	const float weight = (frame - (float)m_times[key]) / (float)(m_times[key+1] - m_times[key]);
+
+	Imath::V3f result;
+	for(unsigned a = 0; a < 3; ++a) {
+		const float v1 = quantization::decodeUnit(m_values[key*3 + a]);
+		const float v2 = quantization::decodeUnit(m_values[(key+1)*3 + a]);
+
+		result[a] = track.offset[a] + (v1 + (v2 - v1) * weight) * track.scale[a];
+	}
+
+	return result;
+}
+
+void AnimationClip::sample(float time, Pose& pose) const {
+	OPENANIM_TIMER("clip/sample");
+
+	assert(pose.sharedHierarchy() == m_hierarchy);
+
+	if(m_frameCount == 0)
+		return;
+
+	sampleFrame(std::min(std::max(time * m_fps, 0.0f), (float)(m_frameCount - 1)), pose, NULL);
+}
+
+void AnimationClip::sampleFrame(float frame, Pose& pose, std::uint32_t* cursors) const {
+	assert(m_frameCount > 0);
+	assert(frame >= 0.0f && frame <= (float)(m_frameCount - 1));
+
+	Imath::Quatf* rotations = pose.rotations();
+	for(std::size_t ji = 0; ji < m_rotations.size(); ++ji) {
+		const Track& track = m_rotations[ji];
+
+		switch(track.encoding) {
+			case Identity:
+				rotations[ji] = Imath::Quatf();
+				break;
+			case Constant:
+				rotations[ji] = Imath::Quatf(track.offset[0], track.offset[1], track.offset[2], track.offset[3]);
+				break;
+			case Quantized: {
+				const std::uint32_t key = cursors ? (cursors[ji] = seekKey(track, cursors[ji], frame)) : findKey(track, frame);
+				rotations[ji] = rotation(track, key, frame);
+				break;
+			}
+		}
+	}
+
+	if(cursors)
+		cursors += m_rotations.size();
+
+	Imath::V3f* translations = pose.translations();
+	for(std::size_t ji = 0; ji < m_translations.size(); ++ji) {
+		const Track& track = m_translations[ji];
+
+		switch(track.encoding) {
+			case Identity:
+				translations[ji] = Imath::V3f(0, 0, 0);
+				break;
+			case Constant:
+				translations[ji] = Imath::V3f(track.offset[0], track.offset[1], track.offset[2]);
+				break;
+			case Quantized: {
+				const std::uint32_t key = cursors ? (cursors[ji] = seekKey(track, cursors[ji], frame)) : findKey(track, frame);
+				translations[ji] = translation(track, key, frame);
+				break;
+			}
+		}
+	}
+}
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include <boost/serialization/access.hpp>
+
+#include <ImathVec.h>
+#include <ImathQuat.h>
+
+#include "Hierarchy.h"
+#include "Pose.h"
+#include "Array.h"
+
+namespace openanim {
+
+/// AnimationClip stores the local transformations of all joints of a Hierarchy, sampled at a constant
+/// frame rate. Each joint has a separate rotation and translation track, stored in one of the compressed
+/// encodings - constant tracks are reduced to a single value (or nothing, for identity), and animated
+/// tracks keep only the keys needed to reconstruct the animation within a tolerance (see ClipBuilder).
+/// Rotation keys are quantized to 48 bits using the "smallest three" method, translation keys to 3x16 bits
+/// within the range of values of each track.
+class AnimationClip {
+	public:
+		enum Encoding {
+			Identity,
+			Constant,
+			Quantized
+		};
+
+		struct Track {
+			Encoding encoding;
+			// range of keys of this track in the key arrays (only for Quantized encoding)
+			std::uint32_t keys_begin, keys_end;
+			// constant value (rotation as r,x,y,z), or the minimum of the translation quantization range
+			float offset[4];
+			// size of the translation quantization range
+			float scale[3];
+		};
+
+		/// creates an empty clip of an empty hierarchy
+		AnimationClip();
+
+		const Hierarchy& hierarchy() const;
+		const std::shared_ptr<const Hierarchy>& sharedHierarchy() const;
+
+		float fps() const;
+		std::size_t frameCount() const;
+		/// duration of the clip in seconds
+		float duration() const;
+
+		/// samples the clip at given time (in seconds, clamped to the clip's range). The pose has to be
+		/// compatible with the clip (share its hierarchy).
+		void sample(float time, Pose& pose) const;
+
+		const Track& rotationTrack(std::size_t joint) const;
+		const Track& translationTrack(std::size_t joint) const;
+
+		/// number of all keys stored in the clip
+		std::size_t keyCount() const;
+		/// size of the compressed animation data, in bytes
+		std::size_t dataSize() const;
+
+	protected:
+	private:
+		/// Boost.Serialization support (see Serialization.h)
+		template<typename ARCHIVE>
+		void serialize(ARCHIVE& ar, const unsigned int version);
+
+		/// finds the key preceding a frame (binary search, unless the track has a key on each frame)
+		std::uint32_t findKey(const Track& track, float frame) const;
+		/// finds the key preceding a frame, starting from a key cursor. Small steps from the cursor are
+		/// searched linearly, larger jumps fall back to findKey().
+		std::uint32_t seekKey(const Track& track, std::uint32_t cursor, float frame) const;
+
+		/// samples all tracks at a frame. If not NULL, cursors contain one key cursor for each track
+		/// (rotation tracks first, then translation tracks), which are used to find the keys and updated.
+		void sampleFrame(float frame, Pose& pose, std::uint32_t* cursors) const;
+
+		Imath::Quatf rotation(const Track& track, std::uint32_t key, float frame) const;
+		Imath::V3f translation(const Track& track, std::uint32_t key, float frame) const;
+
+		std::shared_ptr<const Hierarchy> m_hierarchy;
+
+		float m_fps;
+		std::size_t m_frameCount;
+
+		// tracks and keys are either owned by the clip, or refer to the memory of an Asset
+		Array<Track> m_rotations, m_translations;
+
+		// frame index of each key
+		Array<std::uint32_t> m_times;
+		// 3 quantized values of each key
+		Array<std::uint16_t> m_values;
+
+	friend class ClipBuilder;
+	friend class ClipSampler;
+	friend class Asset;
+	friend class boost::serialization::access;
+};
+
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cassert>
+
+namespace openanim {
+
+/// A contiguous array, either owning its elements (stored in a std::vector), or referring to external
+/// read-only memory kept alive by a shared storage pointer (e.g., a memory-mapped file, see Asset).
+/// Elements are accessed through a plain pointer in both cases; only the owning form can be modified.
+/// Copies of a referring array share the external memory.
+template<typename T>
+class Array {
+	public:
+		typedef const T* const_iterator;
+
+		/// creates an empty owning array
+		Array();
+		/// refers to size elements of external memory, which stays valid as long as storage is alive
+		Array(const T* data, std::size_t size, const std::shared_ptr<const void>& storage);
+
+		Array(const Array& a);
+		Array& operator = (const Array& a);
+		Array(Array&& a);
+		Array& operator = (Array&& a);
+
+		bool empty() const;
+		std::size_t size() const;
+
+		const T* data() const;
+		const T& operator[](std::size_t index) const;
+
+		const_iterator begin() const;
+		const_iterator end() const;
+
+		/// returns true if this array refers to external memory
+		bool isExternal() const;
+
+		/// modifiers, available only for owning arrays
+		T& operator[](std::size_t index);
+		void push_back(const T& value);
+		void append(const T* begin, const T* end);
+		void resize(std::size_t size);
+
+	protected:
+	private:
+		std::vector<T> m_vector;
+		std::shared_ptr<const void> m_storage;
+
+		const T* m_data;
+		std::size_t m_size;
+};
+
+////
+
+template<typename T>
+Array<T>::Array() : m_data(NULL), m_size(0) {
+}
+
+template<typename T>
+Array<T>::Array(const T* data, std::size_t size, const std::shared_ptr<const void>& storage) : m_storage(storage), m_data(data), m_size(size) {
+	assert(storage != NULL);
+}
+
+template<typename T>
+Array<T>::Array(const Array& a) : m_vector(a.m_vector), m_storage(a.m_storage), m_data(a.m_storage ? a.m_data : m_vector.data()), m_size(a.m_size) {
+}
+
+template<typename T>
+Array<T>& Array<T>::operator = (const Array& a) {
+	m_vector = a.m_vector;
+	m_storage = a.m_storage;
+	m_data = a.m_storage ? a.m_data : m_vector.data();
+	m_size = a.m_size;
+
+	return *this;
+}
+
+template<typename T>
+Array<T>::Array(Array&& a) : m_vector(std::move(a.m_vector)), m_storage(std::move(a.m_storage)), m_data(m_storage ? a.m_data : m_vector.data()), m_size(a.m_size) {
+	a.m_data = NULL;
+	a.m_size = 0;
+}
+
+template<typename T>
+Array<T>& Array<T>::operator = (Array&& a) {
+	m_vector = std::move(a.m_vector);
+	m_storage = std::move(a.m_storage);
+	m_data = m_storage ? a.m_data : m_vector.data();
+	m_size = a.m_size;
+
+	a.m_data = NULL;
+	a.m_size = 0;
+
+	return *this;
+}
+
+template<typename T>
+bool Array<T>::empty() const {
+	return m_size == 0;
+}
+
+template<typename T>
+std::size_t Array<T>::size() const {
+	return m_size;
+}
+
+template<typename T>
+const T* Array<T>::data() const {
+	return m_data;
+}
+
+template<typename T>
+const T& Array<T>::operator[](std::size_t index) const {
+	assert(index < m_size);
+	return m_data[index];
+}
+
+template<typename T>
+typename Array<T>::const_iterator Array<T>::begin() const {
+	return m_data;
+}
+
+template<typename T>
+typename Array<T>::const_iterator Array<T>::end() const {
+	return m_data + m_size;
+}
+
+template<typename T>
+bool Array<T>::isExternal() const {
+	return m_storage != NULL;
+}
+
+template<typename T>
+T& Array<T>::operator[](std::size_t index) {
+	assert(!isExternal());
+	assert(index < m_size);
+	return m_vector[index];
+}
+
+template<typename T>
+void Array<T>::push_back(const T& value) {
+	assert(!isExternal());
+
+	m_vector.push_back(value);
+	m_data = m_vector.data();
+	m_size = m_vector.size();
+}
+
+template<typename T>
+void Array<T>::append(const T* begin, const T* end) {
+	assert(!isExternal());
+
+	m_vector.insert(m_vector.end(), begin, end);
+	m_data = m_vector.data();
+	m_size = m_vector.size();
+}
+
+template<typename T>
+void Array<T>::resize(std::size_t size) {
+	assert(!isExternal());
+
+	m_vector.resize(size);
+	m_data = m_vector.data();
+	m_size = m_vector.size();
+}
+
+}
@@ -0,0 +1,348 @@
+#include "Asset.h"
+
+#include <cassert>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+#include "MappedFile.h"
+#include "Instrumentation.h"
+
+namespace openanim {
+
+namespace {
+	static const char s_magic[8] = {'o', 'p', 'e', 'n', 'a', 'n', 'i', 'm'};
+	// written in the native byte order, to detect files of a different one
+	static const std::uint32_t s_byteOrder = 0x01020304;
+
+	/// the file header, at offset 0. All offsets are from the beginning of the file.
+	struct Header {
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t byteOrder;
+		// size of the whole asset in bytes
+		std::uint64_t size;
+
+		std::uint32_t jointCount;
+		std::uint32_t layout;
+		// number of slots of the name index, and the size of the name pool in bytes
+		std::uint32_t indexSize;
+		std::uint32_t clipCount;
+		std::uint64_t namesSize;
+
+		// section offsets
+		std::uint64_t items, names, index, translations, rotations, clips;
+	};
+
+	/// a hierarchy item, with fixed-size fields
+	struct Item {
+		std::uint32_t name_offset;
+		std::int32_t parent;
+		std::uint32_t children_begin, children_end;
+	};
+
+	/// an entry of the clip table
+	struct Clip {
+		float fps;
+		std::uint32_t frameCount;
+		// number of rotation tracks (followed by the same number of translation tracks), and of keys
+		std::uint32_t trackCount;
+		std::uint32_t keyCount;
+
+		// section offsets
+		std::uint64_t tracks, times, values;
+	};
+
+	std::uint64_t align(std::uint64_t offset) {
+		return (offset + Asset::s_alignment - 1) & ~(std::uint64_t)(Asset::s_alignment - 1);
+	}
+
+	/// sequential writer of aligned sections
+	class Writer {
+		public:
+			explicit Writer(std::ostream& out) : m_out(&out), m_position(0) {
+			}
+
+			void write(std::uint64_t offset, const void* data, std::size_t size) {
+				assert(offset >= m_position);
+
+				static const char padding[Asset::s_alignment] = {0};
+				while(m_position < offset) {
+					const std::size_t count = std::min<std::uint64_t>(offset - m_position, Asset::s_alignment);
+					m_out->write(padding, count);
+					m_position += count;
+				}
+
+				m_out->write(static_cast<const char*>(data), size);
+				m_position += size;
+			}
+
+		private:
+			std::ostream* m_out;
+			std::uint64_t m_position;
+	};
+
+	/// throws if a section doesn't lie within an image of given size, or isn't aligned
+	void checkSection(std::uint64_t offset, std::uint64_t size, std::uint64_t imageSize, const char* name) {
+		if(offset % Asset::s_alignment != 0 || offset > imageSize || size > imageSize - offset)
+			throw std::runtime_error(std::string("invalid asset - section '") + name + "' out of bounds");
+	}
+}
+
+const std::uint32_t Asset::s_version;
+const std::size_t Asset::s_alignment;
+
+Asset::Asset(const std::string& filename) {
+	std::size_t size = 0;
+	m_storage = detail::mapFile(filename, "asset", size);
+
+	load(size);
+}
+
+Asset::Asset(const void* data, std::size_t size) : m_storage(data, [](const void*) {}) {
+	load(size);
+}
+
+void Asset::load(std::size_t size) {
+	OPENANIM_TIMER("asset/load");
+
+	static_assert(sizeof(Hierarchy::Slot) == 8, "name index slots are stored in place");
+	static_assert(sizeof(AnimationClip::Track) == 40, "clip tracks are used in place");
+	static_assert(sizeof(AnimationClip::Encoding) == sizeof(std::uint32_t), "track encodings are stored as 32 bit values");
+
+	const char* data = static_cast<const char*>(m_storage.get());
+	assert((reinterpret_cast<std::uintptr_t>(data) % s_alignment) == 0 && "asset images have to be aligned");
+
+	// the header
+	if(size < sizeof(Header))
+		throw std::runtime_error("invalid asset - too small");
+
+	const Header& header = *reinterpret_cast<const Header*>(data);
+	if(std::memcmp(header.magic, s_magic, sizeof(s_magic)) != 0)
+		throw std::runtime_error("invalid asset - not an openanim asset");
+	if(header.byteOrder != s_byteOrder)
+		throw std::runtime_error("invalid asset - different byte order");
+	if(header.version != s_version)
+		throw std::runtime_error("invalid asset - unsupported version");
+	if(header.size > size)
+		throw std::runtime_error("invalid asset - truncated");
+	if(header.layout > Hierarchy::DepthFirst)
+		throw std::runtime_error("invalid asset - unknown hierarchy layout");
+	if((header.indexSize & (header.indexSize - 1)) != 0 || header.indexSize < header.jointCount * 2)
+		throw std::runtime_error("invalid asset - invalid name index");
+
+	checkSection(header.items, (std::uint64_t)header.jointCount * sizeof(Item), header.size, "items");
+	checkSection(header.names, header.namesSize, header.size, "names");
+	checkSection(header.index, (std::uint64_t)header.indexSize * sizeof(Hierarchy::Slot), header.size, "index");
+	checkSection(header.translations, (std::uint64_t)header.jointCount * sizeof(Imath::V3f), header.size, "translations");
+	checkSection(header.rotations, (std::uint64_t)header.jointCount * sizeof(Imath::Quatf), header.size, "rotations");
+	checkSection(header.clips, (std::uint64_t)header.clipCount * sizeof(Clip), header.size, "clips");
+
+	if(header.namesSize > 0 && data[header.names + header.namesSize - 1] != '\0')
+		throw std::runtime_error("invalid asset - unterminated name pool");
+
+	// the hierarchy - bulk copies of the name pool and the index, and the items
+	std::shared_ptr<Hierarchy> hierarchy = std::make_shared<Hierarchy>();
+	hierarchy->m_layout = (Hierarchy::Layout)header.layout;
+
+	// the ranges of items have to agree with their parents, for the traversals (Children, BoneMask) to stay
+	// within the hierarchy - in the BreadthFirst layout the children ranges follow each other and cover all
+	// items but the root, in the DepthFirst layout each subtree is nested in the subtree of its parent
+	const Item* items = reinterpret_cast<const Item*>(data + header.items);
+	hierarchy->m_items.resize(header.jointCount);
+	std::size_t nextChild = 1;
+	std::vector<std::size_t> subtrees;
+	for(std::size_t i = 0; i < header.jointCount; ++i) {
+		const Item& item = items[i];
+		// the first item is the root, all other items have a parent preceding them
+		const bool parentValid = (i == 0) ? (item.parent == -1) : (item.parent >= 0 && item.parent < (std::int32_t)i);
+		bool rangeValid = item.children_begin <= item.children_end && item.children_end <= header.jointCount;
+
+		if(header.layout == Hierarchy::BreadthFirst) {
+			rangeValid = rangeValid && item.children_begin > i;
+			if(rangeValid && item.children_begin != item.children_end) {
+				rangeValid = item.children_begin == nextChild;
+				for(std::size_t c = item.children_begin; rangeValid && c < item.children_end; ++c)
+					rangeValid = items[c].parent == (std::int32_t)i;
+				nextChild = item.children_end;
+			}
+		}
+		else {
+			// the innermost subtree containing this item has to be its parent's
+			while(!subtrees.empty() && items[subtrees.back()].children_end <= i)
+				subtrees.pop_back();
+
+			rangeValid = rangeValid && item.children_begin == i + 1 && (i == 0 ||
+				(!subtrees.empty() && subtrees.back() == (std::size_t)item.parent && item.children_end <= items[item.parent].children_end));
+			subtrees.push_back(i);
+		}
+
+		if(item.name_offset >= header.namesSize || !parentValid || !rangeValid)
+			throw std::runtime_error("invalid asset - invalid hierarchy item");
+
+		hierarchy->m_items[i] = Hierarchy::Item{item.name_offset, item.parent, item.children_begin, item.children_end};
+	}
+	if(header.layout == Hierarchy::BreadthFirst && header.jointCount > 0 && nextChild != header.jointCount)
+		throw std::runtime_error("invalid asset - invalid hierarchy item");
+
+	hierarchy->m_names.assign(data + header.names, data + header.names + header.namesSize);
+
+	// lookups stop at an empty slot, so the index needs at least one
+	const Hierarchy::Slot* index = reinterpret_cast<const Hierarchy::Slot*>(data + header.index);
+	bool emptySlot = false;
+	for(std::size_t i = 0; i < header.indexSize; ++i) {
+		if(index[i].item < -1 || index[i].item >= (int)header.jointCount)
+			throw std::runtime_error("invalid asset - invalid name index slot");
+		emptySlot |= (index[i].item == -1);
+	}
+	if(header.indexSize > 0 && !emptySlot)
+		throw std::runtime_error("invalid asset - name index without an empty slot");
+
+	hierarchy->m_index.assign(index, index + header.indexSize);
+
+	m_hierarchy = hierarchy;
+
+	// the bind pose
+	m_bindPose = Pose(m_hierarchy);
+	std::memcpy(m_bindPose.translations(), data + header.translations, header.jointCount * sizeof(Imath::V3f));
+	std::memcpy(m_bindPose.rotations(), data + header.rotations, header.jointCount * sizeof(Imath::Quatf));
+
+	// the clips, referring to the track and key data in place
+	const Clip* clips = reinterpret_cast<const Clip*>(data + header.clips);
+	m_clips.reserve(header.clipCount);
+	for(std::size_t c = 0; c < header.clipCount; ++c) {
+		const Clip& entry = clips[c];
+
+		if(!(entry.fps > 0.0f) || !std::isfinite(entry.fps))
+			throw std::runtime_error("invalid asset - invalid clip frame rate");
+		if(entry.trackCount != 0 && entry.trackCount != header.jointCount)
+			throw std::runtime_error("invalid asset - invalid clip track count");
+		checkSection(entry.tracks, (std::uint64_t)entry.trackCount * 2 * sizeof(AnimationClip::Track), header.size, "tracks");
+		checkSection(entry.times, (std::uint64_t)entry.keyCount * sizeof(std::uint32_t), header.size, "times");
+		checkSection(entry.values, (std::uint64_t)entry.keyCount * 3 * sizeof(std::uint16_t), header.size, "values");
+
+		const AnimationClip::Track* tracks = reinterpret_cast<const AnimationClip::Track*>(data + entry.tracks);
+		const std::uint32_t* times = reinterpret_cast<const std::uint32_t*>(data + entry.times);
+		for(std::size_t t = 0; t < (std::size_t)entry.trackCount * 2; ++t) {
+			const AnimationClip::Track& track = tracks[t];
+
+			// the encoding is checked as a plain integer, before it is used as the enum
+			std::uint32_t encoding;
+			std::memcpy(&encoding, &track.encoding, sizeof(encoding));
+
+			if(encoding > AnimationClip::Quantized || track.keys_begin > track.keys_end || track.keys_end > entry.keyCount)
+				throw std::runtime_error("invalid asset - invalid clip track");
+
+			// constant values are stored in the track itself, only quantized tracks have keys (at least two,
+			// to interpolate between)
+			const std::uint32_t keys = track.keys_end - track.keys_begin;
+			if((encoding == AnimationClip::Quantized) ? (keys < 2) : (keys != 0))
+				throw std::runtime_error("invalid asset - invalid clip track key count");
+
+			// key times are increasing frame indices within the clip
+			for(std::uint32_t k = track.keys_begin; k < track.keys_end; ++k)
+				if(times[k] >= entry.frameCount || (k > track.keys_begin && times[k] <= times[k-1]))
+					throw std::runtime_error("invalid asset - invalid clip key times");
+		}
+
+		AnimationClip clip;
+		clip.m_hierarchy = m_hierarchy;
+		clip.m_fps = entry.fps;
+		clip.m_frameCount = entry.frameCount;
+		clip.m_rotations = Array<AnimationClip::Track>(tracks, entry.trackCount, m_storage);
+		clip.m_translations = Array<AnimationClip::Track>(tracks + entry.trackCount, entry.trackCount, m_storage);
+		clip.m_times = Array<std::uint32_t>(times, entry.keyCount, m_storage);
+		clip.m_values = Array<std::uint16_t>(reinterpret_cast<const std::uint16_t*>(data + entry.values), entry.keyCount * 3, m_storage);
+
+		m_clips.push_back(std::move(clip));
+	}
+}
+
+const Hierarchy& Asset::hierarchy() const {
+	return *m_hierarchy;
+}
+
+const std::shared_ptr<const Hierarchy>& Asset::sharedHierarchy() const {
+	return m_hierarchy;
+}
+
+const Pose& Asset::bindPose() const {
+	return m_bindPose;
+}
+
+std::size_t Asset::clipCount() const {
+	return m_clips.size();
+}
+
+const AnimationClip& Asset::clip(std::size_t index) const {
+	assert(index < m_clips.size());
+	return m_clips[index];
+}
+
+void Asset::write(std::ostream& out, const Pose& bindPose, const AnimationClip* const* clips, std::size_t clipCount) {
+	const Hierarchy& h = bindPose.hierarchy();
+
+	// the layout of all sections
+	Header header;
+	std::memcpy(header.magic, s_magic, sizeof(s_magic));
+	header.version = s_version;
+	header.byteOrder = s_byteOrder;
+	header.jointCount = h.size();
+	header.layout = h.layout();
+	header.indexSize = h.m_index.size();
+	header.clipCount = clipCount;
+	header.namesSize = h.m_names.size();
+
+	header.items = align(sizeof(Header));
+	header.names = align(header.items + h.size() * sizeof(Item));
+	header.index = align(header.names + h.m_names.size());
+	header.translations = align(header.index + h.m_index.size() * sizeof(Hierarchy::Slot));
+	header.rotations = align(header.translations + h.size() * sizeof(Imath::V3f));
+	header.clips = align(header.rotations + h.size() * sizeof(Imath::Quatf));
+
+	std::vector<Clip> entries(clipCount);
+	std::uint64_t end = header.clips + clipCount * sizeof(Clip);
+	for(std::size_t c = 0; c < clipCount; ++c) {
+		const AnimationClip& clip = *clips[c];
+		assert(clip.sharedHierarchy() == bindPose.sharedHierarchy());
+
+		Clip& entry = entries[c];
+		entry.fps = clip.m_fps;
+		entry.frameCount = clip.m_frameCount;
+		entry.trackCount = clip.m_rotations.size();
+		entry.keyCount = clip.m_times.size();
+
+		entry.tracks = align(end);
+		entry.times = align(entry.tracks + entry.trackCount * 2 * sizeof(AnimationClip::Track));
+		entry.values = align(entry.times + entry.keyCount * sizeof(std::uint32_t));
+		end = entry.values + entry.keyCount * 3 * sizeof(std::uint16_t);
+	}
+	header.size = end;
+
+	// and the data
+	std::vector<Item> items(h.size());
+	for(std::size_t i = 0; i < h.size(); ++i)
+		items[i] = Item{(std::uint32_t)h[i].name_offset, h[i].parent, (std::uint32_t)h[i].children_begin, (std::uint32_t)h[i].children_end};
+
+	Writer writer(out);
+	writer.write(0, &header, sizeof(Header));
+	writer.write(header.items, items.data(), items.size() * sizeof(Item));
+	writer.write(header.names, h.m_names.data(), h.m_names.size());
+	writer.write(header.index, h.m_index.data(), h.m_index.size() * sizeof(Hierarchy::Slot));
+	writer.write(header.translations, bindPose.translations(), h.size() * sizeof(Imath::V3f));
+	writer.write(header.rotations, bindPose.rotations(), h.size() * sizeof(Imath::Quatf));
+	writer.write(header.clips, entries.data(), entries.size() * sizeof(Clip));
+
+	for(std::size_t c = 0; c < clipCount; ++c) {
+		const AnimationClip& clip = *clips[c];
+		const Clip& entry = entries[c];
+
+		writer.write(entry.tracks, clip.m_rotations.data(), entry.trackCount * sizeof(AnimationClip::Track));
+		writer.write(entry.tracks + entry.trackCount * sizeof(AnimationClip::Track), clip.m_translations.data(), entry.trackCount * sizeof(AnimationClip::Track));
+		writer.write(entry.times, clip.m_times.data(), entry.keyCount * sizeof(std::uint32_t));
+		writer.write(entry.values, clip.m_values.data(), entry.keyCount * 3 * sizeof(std::uint16_t));
+	}
+}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <cstdint>
+
+#include <boost/noncopyable.hpp>
+
+#include "Hierarchy.h"
+#include "Pose.h"
+#include "AnimationClip.h"
+
+namespace openanim {
+
+/// Asset is a memory-mapped binary file holding a Hierarchy, its bind pose, and any number of clips.
+/// The format is versioned and relocatable - all sections are referred to by their offsets from the
+/// beginning of the file, and are aligned to s_alignment bytes. Loading validates the header, the bounds
+/// of all sections, and the consistency of the hierarchy items, the clip tracks and their key times (a
+/// single pass over each), without touching the key values. The hierarchy and the bind pose are
+/// copied by a few bulk copies (no parsing or per-joint allocations), while the track and key data of
+/// all clips are used in place - they are read from the page cache on first access, and stay mapped
+/// as long as the asset or any clip copied from it is alive.
+/// The format uses the native byte order (a file of a different byte order is rejected).
+class Asset : public boost::noncopyable {
+	public:
+		/// version of the format written by write(), and the only one accepted by the loading constructors
+		static const std::uint32_t s_version = 1;
+		/// alignment of all sections (and the required alignment of in-memory asset images)
+		static const std::size_t s_alignment = 32;
+
+		/// maps an asset file. Throws std::runtime_error if the file can't be mapped, or if it isn't a
+		/// valid asset of the current version.
+		explicit Asset(const std::string& filename);
+		/// uses an asset image in memory (aligned to s_alignment), which has to stay valid for the lifetime
+		/// of the asset and all clips copied from it. Throws std::runtime_error for invalid images.
+		Asset(const void* data, std::size_t size);
+
+		const Hierarchy& hierarchy() const;
+		const std::shared_ptr<const Hierarchy>& sharedHierarchy() const;
+
+		const Pose& bindPose() const;
+
+		std::size_t clipCount() const;
+		const AnimationClip& clip(std::size_t index) const;
+
+		/// writes an asset from a bind pose (and its hierarchy), and clips compatible with it
+		static void write(std::ostream& out, const Pose& bindPose, const AnimationClip* const* clips, std::size_t clipCount);
+
+	protected:
+	private:
+		/// validates the image and creates the hierarchy, the bind pose and the clips
+		void load(std::size_t size);
+
+		// the mapped file (or the in-memory image)
+		std::shared_ptr<const void> m_storage;
+
+		std::shared_ptr<const Hierarchy> m_hierarchy;
+		Pose m_bindPose;
+		std::vector<AnimationClip> m_clips;
+};
+
+}
@@ -0,0 +1,242 @@
+#include "BlendGraph.h"
+
+#include <cassert>
+#include <algorithm>
+
+#include "Instrumentation.h"
+
+namespace openanim {
+
+BlendGraph::BlendGraph(const std::shared_ptr<const Hierarchy>& h) : m_hierarchy(h), m_kinematics(*h), m_version(0), m_computed(0) {
+	assert(h != NULL);
+}
+
+const Hierarchy& BlendGraph::hierarchy() const {
+	return *m_hierarchy;
+}
+
+const std::shared_ptr<const Hierarchy>& BlendGraph::sharedHierarchy() const {
+	return m_hierarchy;
+}
+
+std::size_t BlendGraph::size() const {
+	return m_nodes.size();
+}
+
+BlendGraph::NodeId BlendGraph::add(Type type, int a, int b, float weight, std::size_t data) {
+	// inputs have to exist already, which keeps the node table in evaluation order
+	assert(a < (int)m_nodes.size());
+	assert(b < (int)m_nodes.size());
+
+	Node n;
+	n.type = type;
+	n.inputs[0] = a;
+	n.inputs[1] = b;
+	n.weight = weight;
+	n.interpolation = Nlerp;
+	n.data = data;
+
+	n.pose = -1;
+	n.output = NULL;
+	n.version = 0;
+	n.inputVersions[0] = 0;
+	n.inputVersions[1] = 0;
+	n.changed = true;
+
+	m_nodes.push_back(n);
+	m_needed.push_back(0);
+
+	return m_nodes.size() - 1;
+}
+
+BlendGraph::NodeId BlendGraph::addClip(const AnimationClip& clip, bool looping) {
+	assert(clip.sharedHierarchy() == m_hierarchy);
+
+	m_samplers.push_back(ClipSampler(clip));
+	m_samplers.back().setLooping(looping);
+	m_times.push_back(0.0f);
+
+	return add(Clip, -1, -1, 1.0f, m_samplers.size() - 1);
+}
+
+BlendGraph::NodeId BlendGraph::addBlend(NodeId a, NodeId b, float weight, Interpolation interpolation) {
+	const NodeId result = add(Blend, a, b, weight, 0);
+	m_nodes[result].interpolation = interpolation;
+	return result;
+}
+
+BlendGraph::NodeId BlendGraph::addAdditive(NodeId base, NodeId layer, float weight) {
+	return add(Additive, base, layer, weight, 0);
+}
+
+BlendGraph::NodeId BlendGraph::addMask(NodeId a, NodeId b, const BoneMask& mask, float weight) {
+	assert(mask.sharedHierarchy() == m_hierarchy);
+
+	m_masks.push_back(mask);
+	return add(Mask, a, b, weight, m_masks.size() - 1);
+}
+
+BlendGraph::NodeId BlendGraph::addWorld(NodeId local) {
+	return add(World, local, -1, 1.0f, 0);
+}
+
+void BlendGraph::setTime(NodeId clip, float time) {
+	assert(clip < m_nodes.size() && m_nodes[clip].type == Clip);
+
+	Node& n = m_nodes[clip];
+	if(m_times[n.data] != time) {
+		m_times[n.data] = time;
+		n.changed = true;
+	}
+}
+
+float BlendGraph::time(NodeId clip) const {
+	assert(clip < m_nodes.size() && m_nodes[clip].type == Clip);
+	return m_times[m_nodes[clip].data];
+}
+
+void BlendGraph::setWeight(NodeId node, float weight) {
+	assert(node < m_nodes.size());
+	assert(m_nodes[node].type == Blend || m_nodes[node].type == Additive || m_nodes[node].type == Mask);
+
+	Node& n = m_nodes[node];
+	if(n.weight != weight) {
+		n.weight = weight;
+		n.changed = true;
+	}
+}
+
+float BlendGraph::weight(NodeId node) const {
+	assert(node < m_nodes.size());
+	return m_nodes[node].weight;
+}
+
+int BlendGraph::passThrough(const Node& n) const {
+	switch(n.type) {
+		case Blend:
+			if(n.weight <= 0.0f)
+				return n.inputs[0];
+			if(n.weight >= 1.0f)
+				return n.inputs[1];
+			break;
+		case Additive:
+			if(n.weight == 0.0f)
+				return n.inputs[0];
+			break;
+		case Mask:
+			if(n.weight == 0.0f || m_masks[n.data].count() == 0)
+				return n.inputs[0];
+			break;
+		default:
+			break;
+	}
+
+	return -1;
+}
+
+void BlendGraph::update(NodeId id) {
+	Node& n = m_nodes[id];
+
+	// pruned node - the output is the output of one of the inputs, and the node's pose can be reused
+	const int through = passThrough(n);
+	if(through >= 0) {
+		if(n.pose >= 0) {
+			m_freePoses.push_back(n.pose);
+			n.pose = -1;
+		}
+
+		n.output = m_nodes[through].output;
+		n.version = m_nodes[through].version;
+
+		return;
+	}
+
+	// cached output - neither the parameters nor the inputs changed since the last computation
+	bool changed = n.changed || n.pose < 0;
+	for(unsigned i = 0; i < 2; ++i)
+		if(n.inputs[i] >= 0 && m_nodes[n.inputs[i]].version != n.inputVersions[i])
+			changed = true;
+	if(!changed)
+		return;
+
+	if(n.pose < 0) {
+		if(!m_freePoses.empty()) {
+			n.pose = m_freePoses.back();
+			m_freePoses.pop_back();
+		}
+		else {
+			m_poses.push_back(Pose(m_hierarchy));
+			n.pose = m_poses.size() - 1;
+		}
+	}
+
+	Pose& result = m_poses[n.pose];
+	const Pose* a = n.inputs[0] >= 0 ? m_nodes[n.inputs[0]].output : NULL;
+	const Pose* b = n.inputs[1] >= 0 ? m_nodes[n.inputs[1]].output : NULL;
+
+	switch(n.type) {
+		case Clip:
+			m_samplers[n.data].sample(m_times[n.data], result);
+			break;
+		case Blend:
+			blend(*a, *b, n.weight, result, n.interpolation);
+			break;
+		case Additive:
+			blendAdditive(*a, *b, n.weight, result);
+			break;
+		case Mask:
+			blend(*a, *b, n.weight, m_masks[n.data], result);
+			break;
+		case World:
+			m_kinematics.localToWorld(*a, result);
+			break;
+	}
+
+	n.output = &result;
+	n.version = ++m_version;
+	for(unsigned i = 0; i < 2; ++i)
+		n.inputVersions[i] = n.inputs[i] >= 0 ? m_nodes[n.inputs[i]].version : 0;
+	n.changed = false;
+
+	++m_computed;
+}
+
+const Pose& BlendGraph::evaluate(NodeId output) {
+	OPENANIM_TIMER("blend_graph/evaluate");
+
+	assert(output < m_nodes.size());
+
+	// marks the nodes contributing to the output - inputs always precede their nodes, so a single
+	// backwards pass is enough
+	std::fill(m_needed.begin(), m_needed.begin() + output + 1, 0);
+	m_needed[output] = 1;
+
+	for(NodeId id = output + 1; id-- > 0; )
+		if(m_needed[id]) {
+			const Node& n = m_nodes[id];
+
+			const int through = passThrough(n);
+			if(through >= 0)
+				m_needed[through] = 1;
+			else
+				for(unsigned i = 0; i < 2; ++i)
+					if(n.inputs[i] >= 0)
+						m_needed[n.inputs[i]] = 1;
+		}
+
+	// and updates them in order
+	m_computed = 0;
+	for(NodeId id = 0; id <= output; ++id)
+		if(m_needed[id])
+			update(id);
+
+	OPENANIM_COUNT("blend_graph/computed", m_computed);
+
+	return *m_nodes[output].output;
+}
+
+std::size_t BlendGraph::computedCount() const {
+	return m_computed;
+}
+
+}
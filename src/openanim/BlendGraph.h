@@ -0,0 +1,124 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <cstdint>
+
+#include <boost/noncopyable.hpp>
+
+#include "Pose.h"
+#include "AnimationClip.h"
+#include "ClipSampler.h"
+#include "BoneMask.h"
+#include "Blending.h"
+#include "Kinematics.h"
+
+namespace openanim {
+
+/// BlendGraph is a lazily evaluated animation blend graph of a single Hierarchy. Nodes (clip samples,
+/// two-way blends, additive layers, masked blends and forward kinematics) are stored in a flat table in
+/// their creation order - inputs of a node have to be created before it, which makes the creation order
+/// a valid evaluation order.
+/// Evaluation of an output node processes only the nodes contributing to it: branches with zero weight
+/// are pruned (a blend with weight 0 or 1 passes one of its inputs through without any computation),
+/// and each node keeps its output across evaluations, recomputing it only if its parameters or any of
+/// its inputs changed. Outputs are held in a pool of poses, reused by nodes as they become active.
+/// A graph is not thread-safe.
+class BlendGraph : public boost::noncopyable {
+	public:
+		typedef std::size_t NodeId;
+
+		explicit BlendGraph(const std::shared_ptr<const Hierarchy>& h);
+
+		const Hierarchy& hierarchy() const;
+		const std::shared_ptr<const Hierarchy>& sharedHierarchy() const;
+
+		/// number of nodes
+		std::size_t size() const;
+
+		/// adds a node sampling a clip at the time set by setTime(). The clip has to be compatible with
+		/// the graph's hierarchy, and has to outlive the graph.
+		NodeId addClip(const AnimationClip& clip, bool looping = false);
+		/// adds a two-way blend node (see openanim::blend()) - the result is input a for weight 0, and b for weight 1
+		NodeId addBlend(NodeId a, NodeId b, float weight = 0.0f, Interpolation interpolation = Nlerp);
+		/// adds an additive node (see openanim::blendAdditive()), applying an additive layer on a base pose
+		NodeId addAdditive(NodeId base, NodeId layer, float weight = 1.0f);
+		/// adds a masked blend node - input b blended over input a by the weight multiplied by the mask
+		NodeId addMask(NodeId a, NodeId b, const BoneMask& mask, float weight = 1.0f);
+		/// adds a forward kinematics node, converting a local pose to world space
+		NodeId addWorld(NodeId local);
+
+		/// sampling time of a clip node (in seconds)
+		void setTime(NodeId clip, float time);
+		float time(NodeId clip) const;
+
+		/// weight of a blend, additive or mask node
+		void setWeight(NodeId node, float weight);
+		float weight(NodeId node) const;
+
+		/// evaluates a node, returning its output. The reference is valid until the graph is evaluated or changed.
+		const Pose& evaluate(NodeId output);
+
+		/// number of nodes actually computed by the last evaluate() call (not pruned, passed-through or cached)
+		std::size_t computedCount() const;
+
+	protected:
+	private:
+		enum Type {
+			Clip,
+			Blend,
+			Additive,
+			Mask,
+			World
+		};
+
+		struct Node {
+			Type type;
+			// input nodes (-1 if not used)
+			int inputs[2];
+			float weight;
+			Interpolation interpolation;
+			// index of the sampler (Clip) or of the mask (Mask)
+			std::size_t data;
+
+			// index of the output pose in the pool (-1 if none), and the current output (own pose, or
+			// the output of an input passed through)
+			int pose;
+			const Pose* output;
+			// version of the output, and versions of the inputs it was computed from
+			std::uint64_t version;
+			std::uint64_t inputVersions[2];
+			// parameters changed since the last computation
+			bool changed;
+		};
+
+		NodeId add(Type type, int a, int b, float weight, std::size_t data);
+
+		/// the input node passed through to the output of a node without any computation because of
+		/// its weight (-1 if the node has to be computed)
+		int passThrough(const Node& n) const;
+
+		/// updates the output of a single node (all its live inputs have to be up to date)
+		void update(NodeId id);
+
+		std::shared_ptr<const Hierarchy> m_hierarchy;
+		Kinematics m_kinematics;
+
+		std::vector<Node> m_nodes;
+		std::vector<ClipSampler> m_samplers;
+		std::vector<float> m_times;
+		std::vector<BoneMask> m_masks;
+
+		// pool of output poses (a deque keeps their addresses stable), and indices of the unused ones
+		std::deque<Pose> m_poses;
+		std::vector<int> m_freePoses;
+
+		// temporary flags of nodes needed by the current evaluation
+		std::vector<char> m_needed;
+
+		std::uint64_t m_version;
+		std::size_t m_computed;
+};
+
+}
@@ -0,0 +1,318 @@
+#include "Blending.h"
+
+#include <cassert>
+#include <algorithm>
+
+#include "Simd.h"
+#include "Instrumentation.h"
+
+namespace openanim {
+
+namespace {
+	/// runs a kernel over elements [begin, end) - in SIMD batches, followed by a scalar tail
+	template<typename KERNEL>
+	void process(std::size_t begin, std::size_t end, const KERNEL& kernel) {
+		std::size_t i = begin;
+		for(; i + simd::native::width <= end; i += simd::native::width)
+			kernel.template run<simd::native>(i);
+		for(; i < end; ++i)
+			kernel.template run<simd::float1>(i);
+	}
+
+	/// runs a kernel over all joints with non-zero mask weight
+	template<typename KERNEL>
+	void process(const BoneMask& mask, const KERNEL& kernel) {
+		for(auto& r : mask.ranges())
+			process(r.begin, r.end, kernel);
+	}
+
+	/// copies the transformations of joints outside of a mask
+	void copyUnmasked(const Pose& source, const BoneMask& mask, Pose& target) {
+		if(&source == &target)
+			return;
+
+		std::size_t begin = 0;
+		for(std::size_t r = 0; r <= mask.ranges().size(); ++r) {
+			const std::size_t end = r < mask.ranges().size() ? mask.ranges()[r].begin : source.size();
+
+			std::copy(source.translations() + begin, source.translations() + end, target.translations() + begin);
+			std::copy(source.rotations() + begin, source.rotations() + end, target.rotations() + begin);
+
+			if(r < mask.ranges().size())
+				begin = mask.ranges()[r].end;
+		}
+	}
+
+	/// the same weight for all joints
+	struct UniformWeight {
+		float weight;
+
+		template<typename F>
+		F get(std::size_t) const {
+			return F::set1(weight);
+		}
+	};
+
+	/// per-joint weight multiplied by a global weight
+	struct MaskedWeight {
+		const float* weights;
+		float weight;
+
+		template<typename F>
+		F get(std::size_t i) const {
+			return F::loadu(weights + i) * F::set1(weight);
+		}
+	};
+
+	/// Hamilton product of rotation quaternions (p * q, i.e., q is applied first)
+	template<typename F>
+	void rotationProduct(const simd::Transforms<F>& p, const simd::Transforms<F>& q, simd::Transforms<F>& result) {
+		result.qr = p.qr*q.qr - p.qx*q.qx - p.qy*q.qy - p.qz*q.qz;
+		result.qx = p.qr*q.qx + q.qr*p.qx + p.qy*q.qz - p.qz*q.qy;
+		result.qy = p.qr*q.qy + q.qr*p.qy + p.qz*q.qx - p.qx*q.qz;
+		result.qz = p.qr*q.qz + q.qr*p.qz + p.qx*q.qy - p.qy*q.qx;
+	}
+
+	/// flips the rotation of a to the hemisphere of reference
+	template<typename F>
+	void alignRotation(const simd::Transforms<F>& reference, simd::Transforms<F>& a) {
+		const F d = simd::dot(reference, a);
+
+		a.qr = simd::flipSign(a.qr, d);
+		a.qx = simd::flipSign(a.qx, d);
+		a.qy = simd::flipSign(a.qy, d);
+		a.qz = simd::flipSign(a.qz, d);
+	}
+
+	template<typename WEIGHT>
+	struct Lerp {
+		const Pose& p1;
+		const Pose& p2;
+		Pose& result;
+		WEIGHT weight;
+
+		template<typename F>
+		void run(std::size_t i) const {
+			simd::Transforms<F> a, b;
+			simd::load(a, p1.translations() + i, p1.rotations() + i);
+			simd::load(b, p2.translations() + i, p2.rotations() + i);
+
+			alignRotation(a, b);
+
+			const F w = weight.template get<F>(i);
+			a.tx = a.tx + (b.tx - a.tx) * w;
+			a.ty = a.ty + (b.ty - a.ty) * w;
+			a.tz = a.tz + (b.tz - a.tz) * w;
+			a.qr = a.qr + (b.qr - a.qr) * w;
+			a.qx = a.qx + (b.qx - a.qx) * w;
+			a.qy = a.qy + (b.qy - a.qy) * w;
+			a.qz = a.qz + (b.qz - a.qz) * w;
+
+			simd::normalize(a);
+
+			simd::store(a, result.translations() + i, result.rotations() + i);
+		}
+	};
+
+	/// weighted sum of poses, with each weight multiplied by scale (normalizing the weights)
+	struct WeightedSum {
+		const Pose* const* poses;
+		const float* weights;
+		float scale;
+		std::size_t count;
+		Pose& result;
+
+		template<typename F>
+		void run(std::size_t i) const {
+			simd::Transforms<F> first, current, sum;
+			simd::load(first, poses[0]->translations() + i, poses[0]->rotations() + i);
+
+			F w = F::set1(weights[0] * scale);
+			sum.tx = first.tx * w;
+			sum.ty = first.ty * w;
+			sum.tz = first.tz * w;
+			sum.qr = first.qr * w;
+			sum.qx = first.qx * w;
+			sum.qy = first.qy * w;
+			sum.qz = first.qz * w;
+
+			for(std::size_t p = 1; p < count; ++p) {
+				simd::load(current, poses[p]->translations() + i, poses[p]->rotations() + i);
+				alignRotation(first, current);
+
+				w = F::set1(weights[p] * scale);
+				sum.tx = sum.tx + current.tx * w;
+				sum.ty = sum.ty + current.ty * w;
+				sum.tz = sum.tz + current.tz * w;
+				sum.qr = sum.qr + current.qr * w;
+				sum.qx = sum.qx + current.qx * w;
+				sum.qy = sum.qy + current.qy * w;
+				sum.qz = sum.qz + current.qz * w;
+			}
+
+			simd::normalize(sum);
+
+			simd::store(sum, result.translations() + i, result.rotations() + i);
+		}
+	};
+
+	struct Difference {
+		const Pose& pose;
+		const Pose& reference;
+		Pose& result;
+
+		template<typename F>
+		void run(std::size_t i) const {
+			simd::Transforms<F> p, ref, diff;
+			simd::load(p, pose.translations() + i, pose.rotations() + i);
+			simd::load(ref, reference.translations() + i, reference.rotations() + i);
+
+			// inverse reference rotation
+			ref.qx = -ref.qx;
+			ref.qy = -ref.qy;
+			ref.qz = -ref.qz;
+			rotationProduct(ref, p, diff);
+
+			diff.tx = p.tx - ref.tx;
+			diff.ty = p.ty - ref.ty;
+			diff.tz = p.tz - ref.tz;
+
+			simd::store(diff, result.translations() + i, result.rotations() + i);
+		}
+	};
+
+	template<typename WEIGHT>
+	struct Additive {
+		const Pose& base;
+		const Pose& layer;
+		Pose& result;
+		WEIGHT weight;
+
+		template<typename F>
+		void run(std::size_t i) const {
+			simd::Transforms<F> b, l, r;
+			simd::load(b, base.translations() + i, base.rotations() + i);
+			simd::load(l, layer.translations() + i, layer.rotations() + i);
+
+			// scale the layer rotation - nlerp from identity, in the hemisphere of identity
+			const F w = weight.template get<F>(i);
+			const F one = F::set1(1.0f);
+
+			l.qx = simd::flipSign(l.qx, l.qr) * w;
+			l.qy = simd::flipSign(l.qy, l.qr) * w;
+			l.qz = simd::flipSign(l.qz, l.qr) * w;
+			l.qr = one + (simd::flipSign(l.qr, l.qr) - one) * w;
+			simd::normalize(l);
+
+			rotationProduct(b, l, r);
+
+			r.tx = b.tx + l.tx * w;
+			r.ty = b.ty + l.ty * w;
+			r.tz = b.tz + l.tz * w;
+
+			simd::store(r, result.translations() + i, result.rotations() + i);
+		}
+	};
+
+	/// scalar spherical interpolation of rotations of joints [begin, end)
+	template<typename WEIGHT>
+	void slerp(const Pose& p1, const Pose& p2, std::size_t begin, std::size_t end, const WEIGHT& weight, Pose& result) {
+		for(std::size_t i = begin; i < end; ++i) {
+			const float w = weight.template get<simd::float1>(i).v;
+
+			const Imath::Quatf& q1 = p1.rotations()[i];
+			Imath::Quatf q2 = p2.rotations()[i];
+			if((q1 ^ q2) < 0.0f)
+				q2 = -q2;
+
+			result.rotations()[i] = Imath::slerp(q1, q2, w);
+			result.translations()[i] = p1.translations()[i] + (p2.translations()[i] - p1.translations()[i]) * w;
+		}
+	}
+}
+
+void blend(const Pose& p1, const Pose& p2, float weight, Pose& result, Interpolation interpolation) {
+	OPENANIM_TIMER("blending/blend");
+
+	assert(p1.isCompatibleWith(p2));
+	assert(p1.isCompatibleWith(result));
+
+	if(interpolation == Nlerp)
+		process(0, p1.size(), Lerp<UniformWeight>{p1, p2, result, UniformWeight{weight}});
+	else
+		slerp(p1, p2, 0, p1.size(), UniformWeight{weight}, result);
+}
+
+void blend(const Pose& p1, const Pose& p2, float weight, const BoneMask& mask, Pose& result, Interpolation interpolation) {
+	OPENANIM_TIMER("blending/blend_masked");
+
+	assert(p1.isCompatibleWith(p2));
+	assert(p1.isCompatibleWith(result));
+	assert(&p1.hierarchy() == &mask.hierarchy());
+
+	copyUnmasked(p1, mask, result);
+
+	const MaskedWeight w{mask.weights(), weight};
+	if(interpolation == Nlerp)
+		process(mask, Lerp<MaskedWeight>{p1, p2, result, w});
+	else
+		for(auto& r : mask.ranges())
+			slerp(p1, p2, r.begin, r.end, w, result);
+}
+
+void blend(const Pose* const* poses, const float* weights, std::size_t count, Pose& result) {
+	OPENANIM_TIMER("blending/blend_n");
+
+	assert(count > 0);
+
+	float sum = 0.0f;
+	for(std::size_t p = 0; p < count; ++p) {
+		assert(poses[p]->isCompatibleWith(result));
+		assert(weights[p] >= 0.0f);
+		sum += weights[p];
+	}
+
+	// no weight at all - the result is the first pose
+	if(sum <= 0.0f) {
+		if(poses[0] != &result) {
+			std::copy(poses[0]->translations(), poses[0]->translations() + result.size(), result.translations());
+			std::copy(poses[0]->rotations(), poses[0]->rotations() + result.size(), result.rotations());
+		}
+
+		return;
+	}
+
+	process(0, result.size(), WeightedSum{poses, weights, 1.0f / sum, count, result});
+}
+
+void makeAdditive(const Pose& pose, const Pose& reference, Pose& layer) {
+	OPENANIM_TIMER("blending/make_additive");
+
+	assert(pose.isCompatibleWith(reference));
+	assert(pose.isCompatibleWith(layer));
+
+	process(0, pose.size(), Difference{pose, reference, layer});
+}
+
+void blendAdditive(const Pose& base, const Pose& layer, float weight, Pose& result) {
+	OPENANIM_TIMER("blending/additive");
+
+	assert(base.isCompatibleWith(layer));
+	assert(base.isCompatibleWith(result));
+
+	process(0, base.size(), Additive<UniformWeight>{base, layer, result, UniformWeight{weight}});
+}
+
+void blendAdditive(const Pose& base, const Pose& layer, float weight, const BoneMask& mask, Pose& result) {
+	OPENANIM_TIMER("blending/additive_masked");
+
+	assert(base.isCompatibleWith(layer));
+	assert(base.isCompatibleWith(result));
+	assert(&base.hierarchy() == &mask.hierarchy());
+
+	copyUnmasked(base, mask, result);
+
+	process(mask, Additive<MaskedWeight>{base, layer, result, MaskedWeight{mask.weights(), weight}});
+}
+
+}
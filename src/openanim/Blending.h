@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Pose.h"
+#include "BoneMask.h"
+
+namespace openanim {
+
+/// Whole-pose blending. All operations work on the contiguous arrays of compatible poses (sharing the
+/// same Hierarchy instance), in SIMD batches. The result can be one of the input poses. Rotations are
+/// always blended along the shorter arc (quaternion hemisphere correction is done without branching).
+
+/// interpolation of rotations in two-way blending
+enum Interpolation {
+	/// normalized linear interpolation (fast, vectorized)
+	Nlerp,
+	/// spherical linear interpolation (constant angular velocity, scalar)
+	Slerp
+};
+
+/// two-way blend - the result is p1 for weight 0, and p2 for weight 1
+void blend(const Pose& p1, const Pose& p2, float weight, Pose& result, Interpolation interpolation = Nlerp);
+/// masked two-way blend - the weight of each joint is multiplied by its mask weight. Joints outside the
+/// mask are not processed, and keep the transformations of p1.
+void blend(const Pose& p1, const Pose& p2, float weight, const BoneMask& mask, Pose& result, Interpolation interpolation = Nlerp);
+
+/// weighted blend of count poses (any number of them). Weights have to be non-negative, and are
+/// normalized by their sum; if all weights are zero, the result is a copy of the first pose.
+void blend(const Pose* const* poses, const float* weights, std::size_t count, Pose& result);
+
+/// creates an additive layer - the difference between a pose and a reference pose. Applying the layer
+/// to the reference pose using blendAdditive() with weight 1 results in the original pose.
+void makeAdditive(const Pose& pose, const Pose& reference, Pose& layer);
+
+/// applies an additive layer (see makeAdditive()) on top of a base pose. Rotations of the layer are
+/// applied in the local space of each joint and scaled by the weight; translations are added.
+void blendAdditive(const Pose& base, const Pose& layer, float weight, Pose& result);
+/// masked additive blend - the weight of each joint is multiplied by its mask weight. Joints outside
+/// the mask are not processed, and keep the transformations of the base pose.
+void blendAdditive(const Pose& base, const Pose& layer, float weight, const BoneMask& mask, Pose& result);
+
+}
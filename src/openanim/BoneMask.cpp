@@ -0,0 +1,104 @@
+#include "BoneMask.h"
+
+#include <cassert>
+#include <algorithm>
+
+namespace openanim {
+
+BoneMask::BoneMask(const std::shared_ptr<const Hierarchy>& h) : m_hierarchy(h), m_weights(h->size(), 0.0f), m_count(0) {
+}
+
+void BoneMask::set(std::size_t joint, float weight) {
+	assert(joint < m_weights.size());
+	assert(weight >= 0.0f);
+
+	m_weights[joint] = weight;
+
+	update();
+}
+
+void BoneMask::setSubtree(std::size_t joint, float weight) {
+	assert(joint < m_weights.size());
+	assert(weight >= 0.0f);
+
+	const Hierarchy& h = *m_hierarchy;
+
+	// in the depth-first layout, the whole subtree is a single range
+	if(h.layout() == Hierarchy::DepthFirst) {
+		std::fill(m_weights.begin() + joint, m_weights.begin() + h.subtreeEnd(joint), weight);
+
+		update();
+		return;
+	}
+
+	// the children ranges of consecutive joints are adjacent in the flat layout, which means that
+	// each level of a subtree is a single contiguous range, spanning the children of the previous level
+	std::size_t begin = joint;
+	std::size_t end = joint + 1;
+	while(begin < end) {
+		for(std::size_t ji = begin; ji < end; ++ji) {
+			assert(ji == begin || h[ji].children_begin == h[ji-1].children_end);
+			m_weights[ji] = weight;
+		}
+
+		const std::size_t childrenBegin = h[begin].children_begin;
+		end = h[end-1].children_end;
+		begin = childrenBegin;
+	}
+
+	update();
+}
+
+void BoneMask::setSubtree(const std::string& name, float weight) {
+	const int joint = m_hierarchy->find(name);
+	assert(joint >= 0 && "joint not found in the hierarchy");
+
+	setSubtree(joint, weight);
+}
+
+const Hierarchy& BoneMask::hierarchy() const {
+	return *m_hierarchy;
+}
+
+const std::shared_ptr<const Hierarchy>& BoneMask::sharedHierarchy() const {
+	return m_hierarchy;
+}
+
+float BoneMask::weight(std::size_t joint) const {
+	assert(joint < m_weights.size());
+	return m_weights[joint];
+}
+
+const float* BoneMask::weights() const {
+	return m_weights.data();
+}
+
+const std::vector<BoneMask::Range>& BoneMask::ranges() const {
+	return m_ranges;
+}
+
+std::size_t BoneMask::count() const {
+	return m_count;
+}
+
+void BoneMask::update() {
+	m_ranges.clear();
+	m_count = 0;
+
+	std::size_t ji = 0;
+	while(ji < m_weights.size()) {
+		if(m_weights[ji] == 0.0f)
+			++ji;
+
+		else {
+			const std::size_t begin = ji;
+			while(ji < m_weights.size() && m_weights[ji] != 0.0f)
+				++ji;
+
+			m_ranges.push_back(Range{begin, ji});
+			m_count += ji - begin;
+		}
+	}
+}
+
+}
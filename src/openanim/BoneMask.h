@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include "Hierarchy.h"
+
+namespace openanim {
+
+/// A per-joint weight mask used to limit blending to parts of a hierarchy (e.g., an upper-body layer).
+/// Weights are stored in a flat array indexed by the joint index, together with a precomputed list of
+/// ranges of consecutive joints with non-zero weights, allowing masked operations to skip untouched
+/// joints entirely. A mask is built once for a particular Hierarchy instance and is only compatible
+/// with poses sharing that instance.
+class BoneMask {
+	public:
+		/// a range of consecutive joint indices [begin, end)
+		struct Range {
+			std::size_t begin, end;
+		};
+
+		/// creates an empty mask (no joints affected) of the hierarchy h
+		explicit BoneMask(const std::shared_ptr<const Hierarchy>& h);
+
+		/// sets the weight of a single joint
+		void set(std::size_t joint, float weight);
+		/// sets the weight of a joint and all its descendants
+		void setSubtree(std::size_t joint, float weight);
+		/// sets the weight of a subtree of a joint given by its name
+		void setSubtree(const std::string& name, float weight);
+
+		const Hierarchy& hierarchy() const;
+		const std::shared_ptr<const Hierarchy>& sharedHierarchy() const;
+
+		/// weight of a single joint (0 for joints outside the mask)
+		float weight(std::size_t joint) const;
+		/// the contiguous array of per-joint weights (hierarchy().size() elements)
+		const float* weights() const;
+
+		/// sorted non-overlapping ranges of joints with non-zero weight
+		const std::vector<Range>& ranges() const;
+		/// number of joints with non-zero weight
+		std::size_t count() const;
+
+	protected:
+	private:
+		/// rebuilds the ranges from the weights
+		void update();
+
+		std::shared_ptr<const Hierarchy> m_hierarchy;
+
+		std::vector<float> m_weights;
+		std::vector<Range> m_ranges;
+		std::size_t m_count;
+};
+
+}
@@ -1,20 +1,58 @@
 #pragma once
 
 #include <cassert>
+#include <iterator>
+#include <utility>
+
+#include "Hierarchy.h"
 
 namespace openanim {
 
 /// an encapsulation of an iterator range for the children of a particular joint.
-/// All joints are stored in a flat array, and ths class just returns two iterators
-/// with the right offsets.
+/// All joints are stored in a flat array. In the BreadthFirst layout the children are
+/// a contiguous range, and this class just returns two iterators with the right offsets.
+/// In the DepthFirst layout the iteration skips the subtree of each child (see Hierarchy),
+/// which makes size() and operator[] linear in the number of children.
 template<typename JOINT, typename CONTAINER>
 class Children {
 	public:
-		typedef typename CONTAINER::const_iterator const_iterator;
+		/// input iterator over the children, wrapping an iterator of the container (dereferencing
+		/// returns whatever the container's iterator does - a joint proxy)
+		template<typename ITERATOR>
+		class Iterator {
+			public:
+				typedef std::input_iterator_tag iterator_category;
+				typedef typename std::iterator_traits<ITERATOR>::value_type value_type;
+				typedef typename std::iterator_traits<ITERATOR>::difference_type difference_type;
+				typedef typename std::iterator_traits<ITERATOR>::pointer pointer;
+				typedef typename std::iterator_traits<ITERATOR>::reference reference;
+
+				Iterator();
+
+				reference operator*() const;
+				pointer operator->() const;
+
+				Iterator& operator++();
+				Iterator operator++(int);
+
+				bool operator == (const Iterator& it) const;
+				bool operator != (const Iterator& it) const;
+
+			private:
+				Iterator(const ITERATOR& it, std::size_t index, const Hierarchy* hierarchy);
+
+				ITERATOR m_it;
+				std::size_t m_index;
+				const Hierarchy* m_hierarchy;
+
+			friend class Children;
+		};
+
+		typedef Iterator<decltype(std::declval<const CONTAINER&>().begin())> const_iterator;
 		const_iterator begin() const;
 		const_iterator end() const;
 
-		typedef typename CONTAINER::iterator iterator;
+		typedef Iterator<decltype(std::declval<CONTAINER&>().begin())> iterator;
 		iterator begin();
 		iterator end();
 
@@ -22,15 +60,22 @@ class Children {
 		bool empty() const;
 
 		std::size_t size() const;
-		JOINT& operator[](std::size_t index);
-		const JOINT& operator[](std::size_t index) const;
+		JOINT operator[](std::size_t index);
+		const JOINT operator[](std::size_t index) const;
 
 	private:
 		Children();
-		Children(std::size_t begin, std::size_t end, CONTAINER& joints);
+		Children(const Hierarchy& hierarchy, std::size_t parent, CONTAINER& joints);
+
+		/// index of the next sibling of a child
+		std::size_t next(std::size_t index) const;
+		/// index of the n-th child
+		std::size_t child(std::size_t n) const;
 
 		std::size_t m_begin, m_end;
 		CONTAINER* m_joints;
+		// only for the DepthFirst layout, NULL otherwise
+		const Hierarchy* m_hierarchy;
 
 	friend CONTAINER;
 };
@@ -38,35 +83,118 @@ class Children {
 ////
 
 template<typename JOINT, typename CONTAINER>
-Children<JOINT, CONTAINER>::Children() : m_begin(0), m_end(0), m_joints(NULL) {
+template<typename ITERATOR>
+Children<JOINT, CONTAINER>::Iterator<ITERATOR>::Iterator() : m_index(0), m_hierarchy(NULL) {
+}
+
+template<typename JOINT, typename CONTAINER>
+template<typename ITERATOR>
+Children<JOINT, CONTAINER>::Iterator<ITERATOR>::Iterator(const ITERATOR& it, std::size_t index, const Hierarchy* hierarchy) : m_it(it), m_index(index), m_hierarchy(hierarchy) {
+}
+
+template<typename JOINT, typename CONTAINER>
+template<typename ITERATOR>
+typename Children<JOINT, CONTAINER>::template Iterator<ITERATOR>::reference Children<JOINT, CONTAINER>::Iterator<ITERATOR>::operator*() const {
+	return *m_it;
+}
+
+template<typename JOINT, typename CONTAINER>
+template<typename ITERATOR>
+typename Children<JOINT, CONTAINER>::template Iterator<ITERATOR>::pointer Children<JOINT, CONTAINER>::Iterator<ITERATOR>::operator->() const {
+	return m_it.operator->();
+}
+
+template<typename JOINT, typename CONTAINER>
+template<typename ITERATOR>
+typename Children<JOINT, CONTAINER>::template Iterator<ITERATOR>& Children<JOINT, CONTAINER>::Iterator<ITERATOR>::operator++() {
+	const std::size_t next = (m_hierarchy == NULL) ? m_index + 1 : m_hierarchy->subtreeEnd(m_index);
+
+	m_it += next - m_index;
+	m_index = next;
+
+	return *this;
+}
+
+template<typename JOINT, typename CONTAINER>
+template<typename ITERATOR>
+typename Children<JOINT, CONTAINER>::template Iterator<ITERATOR> Children<JOINT, CONTAINER>::Iterator<ITERATOR>::operator++(int) {
+	Iterator result(*this);
+	++(*this);
+	return result;
+}
+
+template<typename JOINT, typename CONTAINER>
+template<typename ITERATOR>
+bool Children<JOINT, CONTAINER>::Iterator<ITERATOR>::operator == (const Iterator& it) const {
+	return m_index == it.m_index;
+}
+
+template<typename JOINT, typename CONTAINER>
+template<typename ITERATOR>
+bool Children<JOINT, CONTAINER>::Iterator<ITERATOR>::operator != (const Iterator& it) const {
+	return m_index != it.m_index;
+}
+
+////
+
+template<typename JOINT, typename CONTAINER>
+Children<JOINT, CONTAINER>::Children() : m_begin(0), m_end(0), m_joints(NULL), m_hierarchy(NULL) {
+}
+
+template<typename JOINT, typename CONTAINER>
+Children<JOINT, CONTAINER>::Children(const Hierarchy& hierarchy, std::size_t parent, CONTAINER& joints) : m_joints(&joints), m_hierarchy(NULL) {
+	assert(parent < hierarchy.size());
+
+	// in the depth-first layout, the children are spread over the whole subtree of the parent
+	if(hierarchy.layout() == Hierarchy::DepthFirst) {
+		m_begin = parent + 1;
+		m_end = hierarchy.subtreeEnd(parent);
+		m_hierarchy = &hierarchy;
+	}
+	else {
+		m_begin = hierarchy[parent].children_begin;
+		m_end = hierarchy[parent].children_end;
+	}
+}
+
+template<typename JOINT, typename CONTAINER>
+std::size_t Children<JOINT, CONTAINER>::next(std::size_t index) const {
+	return (m_hierarchy == NULL) ? index + 1 : m_hierarchy->subtreeEnd(index);
 }
 
 template<typename JOINT, typename CONTAINER>
-Children<JOINT, CONTAINER>::Children(std::size_t begin, std::size_t end, CONTAINER& joints) : m_begin(begin), m_end(end), m_joints(&joints) {
+std::size_t Children<JOINT, CONTAINER>::child(std::size_t n) const {
+	if(m_hierarchy == NULL)
+		return m_begin + n;
+
+	std::size_t result = m_begin;
+	for(std::size_t c = 0; c < n; ++c)
+		result = next(result);
+	return result;
 }
 
 template<typename JOINT, typename CONTAINER>
 typename Children<JOINT, CONTAINER>::const_iterator Children<JOINT, CONTAINER>::begin() const {
 	assert(valid());
-	return m_joints->begin() + m_begin;
+	return const_iterator(static_cast<const CONTAINER*>(m_joints)->begin() + m_begin, m_begin, m_hierarchy);
 }
 
 template<typename JOINT, typename CONTAINER>
 typename Children<JOINT, CONTAINER>::const_iterator Children<JOINT, CONTAINER>::end() const {
 	assert(valid());
-	return m_joints->begin() + m_end;
+	return const_iterator(static_cast<const CONTAINER*>(m_joints)->begin() + m_end, m_end, m_hierarchy);
 }
 
 template<typename JOINT, typename CONTAINER>
 typename Children<JOINT, CONTAINER>::iterator Children<JOINT, CONTAINER>::begin() {
 	assert(valid());
-	return m_joints->begin() + m_begin;
+	return iterator(m_joints->begin() + m_begin, m_begin, m_hierarchy);
 }
 
 template<typename JOINT, typename CONTAINER>
 typename Children<JOINT, CONTAINER>::iterator Children<JOINT, CONTAINER>::end() {
 	assert(valid());
-	return m_joints->end() + m_end;
+	return iterator(m_joints->begin() + m_end, m_end, m_hierarchy);
 }
 
 template<typename JOINT, typename CONTAINER>
@@ -82,22 +210,28 @@ bool Children<JOINT, CONTAINER>::empty() const {
 template<typename JOINT, typename CONTAINER>
 std::size_t Children<JOINT, CONTAINER>::size() const {
 	assert(valid());
-	return m_end - m_begin;
+
+	if(m_hierarchy == NULL)
+		return m_end - m_begin;
+
+	std::size_t result = 0;
+	for(std::size_t c = m_begin; c < m_end; c = next(c))
+		++result;
+	return result;
 }
 
 template<typename JOINT, typename CONTAINER>
-JOINT& Children<JOINT, CONTAINER>::operator[](std::size_t index) {
+JOINT Children<JOINT, CONTAINER>::operator[](std::size_t index) {
 	assert(valid());
-	assert(index < m_joints->size());
-	return (*m_joints)[index];
+	assert(index < size());
+	return (*m_joints)[child(index)];
 }
 
 template<typename JOINT, typename CONTAINER>
-const JOINT& Children<JOINT, CONTAINER>::operator[](std::size_t index) const {
+const JOINT Children<JOINT, CONTAINER>::operator[](std::size_t index) const {
 	assert(valid());
-	assert(index < m_joints->size());
-	return (*m_joints)[index];
-}
-	
+	assert(index < size());
+	return (*m_joints)[child(index)];
 }
 
+}
@@ -0,0 +1,197 @@
+#include "ClipBuilder.h"
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#include "Quantization.h"
+
+namespace openanim {
+
+namespace {
+	// maximum number of frames between two keys - limits the cost of the key reduction
+	static const std::size_t s_maxKeySpan = 255;
+
+	/// greedy key reduction - returns indices of keys needed to reconstruct all values within the
+	/// tolerance using linear interpolation. The first and last values are always kept.
+	template<typename T, typename LERP, typename ERROR>
+	std::vector<std::uint32_t> reduceKeys(const std::vector<T>& values, float tolerance, LERP lerp, ERROR error) {
+		assert(values.size() >= 2);
+
+		std::vector<std::uint32_t> result(1, 0);
+
+		std::size_t last = 0;
+		for(std::size_t candidate = 2; candidate < values.size(); ++candidate) {
+			// can all values between the last key and the candidate be interpolated?
+			bool fits = candidate - last <= s_maxKeySpan;
+			for(std::size_t f = last + 1; (f < candidate) && fits; ++f)
+				fits = error(lerp(values[last], values[candidate], (float)(f - last) / (float)(candidate - last)), values[f]) <= tolerance;
+
+			if(!fits) {
+				last = candidate - 1;
+				result.push_back(last);
+			}
+		}
+
+		result.push_back(values.size() - 1);
+
+		return result;
+	}
+
+	float rotationError(const Imath::Quatf& q1, const Imath::Quatf& q2) {
+		// q and -q are the same rotation
+		const float sign = (q1 ^ q2) < 0.0f ? -1.0f : 1.0f;
+
+		return std::max(
+			std::max(std::abs(q1.r - q2.r * sign), std::abs(q1.v.x - q2.v.x * sign)),
+			std::max(std::abs(q1.v.y - q2.v.y * sign), std::abs(q1.v.z - q2.v.z * sign))
+		);
+	}
+}
+
+ClipBuilder::ClipBuilder(const std::shared_ptr<const Hierarchy>& h, float fps) : m_hierarchy(h), m_fps(fps), m_frameCount(0) {
+	assert(h != NULL);
+	assert(fps > 0.0f);
+}
+
+std::size_t ClipBuilder::frameCount() const {
+	return m_frameCount;
+}
+
+void ClipBuilder::addFrame(const Pose& pose) {
+	assert(pose.sharedHierarchy() == m_hierarchy);
+
+	addFrame(pose.translations(), pose.rotations());
+}
+
+void ClipBuilder::addFrame(const Imath::V3f* translations, const Imath::Quatf* rotations) {
+	const std::size_t size = m_hierarchy->size();
+
+	m_translations.insert(m_translations.end(), translations, translations + size);
+
+	m_rotations.resize(m_rotations.size() + size * 3);
+	std::uint16_t* target = &m_rotations[m_rotations.size() - size * 3];
+	for(std::size_t ji = 0; ji < size; ++ji)
+		quantization::encodeRotation(rotations[ji].normalized(), target + ji * 3);
+
+	++m_frameCount;
+}
+
+void ClipBuilder::buildRotationTrack(AnimationClip& clip, std::size_t joint, float tolerance) const {
+	const std::size_t size = m_hierarchy->size();
+
+	AnimationClip::Track track{AnimationClip::Identity, 0, 0, {1, 0, 0, 0}, {0, 0, 0}};
+
+	std::vector<Imath::Quatf> values(m_frameCount);
+	for(std::size_t f = 0; f < m_frameCount; ++f)
+		values[f] = quantization::decodeRotation(&m_rotations[(f * size + joint) * 3]);
+
+	// constant track - all values within the tolerance from the first one
+	bool constant = true;
+	for(std::size_t f = 1; (f < m_frameCount) && constant; ++f)
+		constant = rotationError(values[0], values[f]) <= tolerance;
+
+	if(constant) {
+		if(rotationError(values[0], Imath::Quatf()) > tolerance) {
+			track.encoding = AnimationClip::Constant;
+			track.offset[0] = values[0].r;
+			track.offset[1] = values[0].v.x;
+			track.offset[2] = values[0].v.y;
+			track.offset[3] = values[0].v.z;
+		}
+	}
+
+	// animated track - keep only the keys needed, already quantized
+	else {
+		const std::vector<std::uint32_t> keys = reduceKeys(values, tolerance, quantization::nlerp, rotationError);
+
+		track.encoding = AnimationClip::Quantized;
+		track.keys_begin = clip.m_times.size();
+		track.keys_end = track.keys_begin + keys.size();
+
+		for(auto& k : keys) {
+			clip.m_times.push_back(k);
+
+			const std::uint16_t* value = &m_rotations[(k * size + joint) * 3];
+			clip.m_values.append(value, value + 3);
+		}
+	}
+
+	clip.m_rotations[joint] = track;
+}
+
+void ClipBuilder::buildTranslationTrack(AnimationClip& clip, std::size_t joint, float tolerance) const {
+	const std::size_t size = m_hierarchy->size();
+
+	AnimationClip::Track track{AnimationClip::Identity, 0, 0, {0, 0, 0, 0}, {0, 0, 0}};
+
+	std::vector<Imath::V3f> values(m_frameCount);
+	Imath::V3f minimum = m_translations[joint], maximum = m_translations[joint];
+	for(std::size_t f = 0; f < m_frameCount; ++f) {
+		values[f] = m_translations[f * size + joint];
+
+		for(unsigned a = 0; a < 3; ++a) {
+			minimum[a] = std::min(minimum[a], values[f][a]);
+			maximum[a] = std::max(maximum[a], values[f][a]);
+		}
+	}
+
+	// constant track - the middle of the range is within the tolerance from all values
+	if((maximum - minimum).length() <= tolerance * 2.0f) {
+		const Imath::V3f value = (minimum + maximum) / 2.0f;
+
+		if(value.length() > tolerance) {
+			track.encoding = AnimationClip::Constant;
+			for(unsigned a = 0; a < 3; ++a)
+				track.offset[a] = value[a];
+		}
+	}
+
+	// animated track - reduce the keys, and quantize the rest within the range of the track
+	else {
+		const std::vector<std::uint32_t> keys = reduceKeys(values, tolerance,
+			[](const Imath::V3f& v1, const Imath::V3f& v2, float w) { return v1 + (v2 - v1) * w; },
+			[](const Imath::V3f& v1, const Imath::V3f& v2) { return (v1 - v2).length(); }
+		);
+
+		track.encoding = AnimationClip::Quantized;
+		track.keys_begin = clip.m_times.size();
+		track.keys_end = track.keys_begin + keys.size();
+		for(unsigned a = 0; a < 3; ++a) {
+			track.offset[a] = minimum[a];
+			track.scale[a] = maximum[a] - minimum[a];
+		}
+
+		for(auto& k : keys) {
+			clip.m_times.push_back(k);
+
+			for(unsigned a = 0; a < 3; ++a)
+				clip.m_values.push_back(track.scale[a] > 0.0f ?
+					quantization::encodeUnit((values[k][a] - minimum[a]) / track.scale[a]) : 0);
+		}
+	}
+
+	clip.m_translations[joint] = track;
+}
+
+AnimationClip ClipBuilder::build(float rotationTolerance, float translationTolerance) const {
+	AnimationClip result;
+	result.m_hierarchy = m_hierarchy;
+	result.m_fps = m_fps;
+	result.m_frameCount = m_frameCount;
+
+	if(m_frameCount == 0)
+		return result;
+
+	result.m_rotations.resize(m_hierarchy->size());
+	result.m_translations.resize(m_hierarchy->size());
+
+	for(std::size_t ji = 0; ji < m_hierarchy->size(); ++ji) {
+		buildRotationTrack(result, ji, rotationTolerance);
+		buildTranslationTrack(result, ji, translationTolerance);
+	}
+
+	return result;
+}
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include <boost/noncopyable.hpp>
+
+#include <ImathVec.h>
+#include <ImathQuat.h>
+
+#include "Hierarchy.h"
+#include "Pose.h"
+#include "AnimationClip.h"
+
+namespace openanim {
+
+/// Incrementally collects frames of an animation, and compresses them into an AnimationClip.
+/// Rotations are quantized as soon as a frame is added, so the builder holds 18 bytes per joint and frame.
+class ClipBuilder : public boost::noncopyable {
+	public:
+		ClipBuilder(const std::shared_ptr<const Hierarchy>& h, float fps);
+
+		std::size_t frameCount() const;
+
+		/// appends a single frame of local transformations of all joints
+		void addFrame(const Pose& pose);
+		/// appends a single frame of local transformations of all joints (arrays with hierarchy().size() elements)
+		void addFrame(const Imath::V3f* translations, const Imath::Quatf* rotations);
+
+		/// compresses the frames into a clip. Tracks with all values within the tolerance are stored as
+		/// constant (or identity), and keys of animated tracks that can be reconstructed by interpolating their
+		/// neighbours within the tolerance are removed. The rotation tolerance is the maximum difference of
+		/// quaternion components, the translation tolerance is a distance.
+		AnimationClip build(float rotationTolerance = 0.0f, float translationTolerance = 0.0f) const;
+
+	protected:
+	private:
+		void buildRotationTrack(AnimationClip& clip, std::size_t joint, float tolerance) const;
+		void buildTranslationTrack(AnimationClip& clip, std::size_t joint, float tolerance) const;
+
+		std::shared_ptr<const Hierarchy> m_hierarchy;
+		float m_fps;
+		std::size_t m_frameCount;
+
+		// quantized rotations of all frames (3 values per joint and frame)
+		std::vector<std::uint16_t> m_rotations;
+		// translations of all frames
+		std::vector<Imath::V3f> m_translations;
+};
+
+}
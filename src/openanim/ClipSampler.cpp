@@ -0,0 +1,57 @@
+#include "ClipSampler.h"
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#include "Instrumentation.h"
+
+namespace openanim {
+
+ClipSampler::ClipSampler(const AnimationClip& clip) : m_clip(&clip), m_looping(false) {
+	reset();
+}
+
+const AnimationClip& ClipSampler::clip() const {
+	return *m_clip;
+}
+
+void ClipSampler::setLooping(bool looping) {
+	m_looping = looping;
+}
+
+bool ClipSampler::looping() const {
+	return m_looping;
+}
+
+void ClipSampler::reset() {
+	m_cursors.resize(m_clip->m_rotations.size() + m_clip->m_translations.size());
+
+	for(std::size_t ji = 0; ji < m_clip->m_rotations.size(); ++ji)
+		m_cursors[ji] = m_clip->m_rotations[ji].keys_begin;
+	for(std::size_t ji = 0; ji < m_clip->m_translations.size(); ++ji)
+		m_cursors[m_clip->m_rotations.size() + ji] = m_clip->m_translations[ji].keys_begin;
+}
+
+void ClipSampler::sample(float time, Pose& pose) {
+	OPENANIM_TIMER("clip_sampler/sample");
+
+	assert(pose.sharedHierarchy() == m_clip->sharedHierarchy());
+
+	if(m_clip->frameCount() == 0)
+		return;
+
+	const float last = (float)(m_clip->frameCount() - 1);
+
+	float frame = time * m_clip->fps();
+	if(m_looping && last > 0.0f) {
+		frame = std::fmod(frame, last);
+		if(frame < 0.0f)
+			frame += last;
+	}
+	frame = std::min(std::max(frame, 0.0f), last);
+
+	m_clip->sampleFrame(frame, pose, m_cursors.data());
+}
+
+}
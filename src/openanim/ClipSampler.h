@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "AnimationClip.h"
+#include "Pose.h"
+
+namespace openanim {
+
+/// Samples an AnimationClip repeatedly, keeping a key cursor for each track. When the sampling time
+/// changes by small steps (forward or reverse playback), the keys are found by advancing the cursors
+/// instead of searching the whole track; large jumps (scrubbing) fall back to a binary search.
+/// The sampler only refers to the clip, which has to outlive it.
+class ClipSampler {
+	public:
+		explicit ClipSampler(const AnimationClip& clip);
+
+		const AnimationClip& clip() const;
+
+		/// if enabled, sampling time wraps around the clip's duration; otherwise it is clamped to it
+		void setLooping(bool looping);
+		bool looping() const;
+
+		/// samples the clip at given time (in seconds). The pose has to be compatible with the clip.
+		void sample(float time, Pose& pose);
+
+		/// resets all cursors to the beginning of the clip
+		void reset();
+
+	protected:
+	private:
+		const AnimationClip* m_clip;
+		bool m_looping;
+
+		// key cursor for each rotation track, followed by each translation track
+		std::vector<std::uint32_t> m_cursors;
+};
+
+}
@@ -0,0 +1,145 @@
+#include "Crowd.h"
+
+#include <cassert>
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+#include "Blending.h"
+#include "Instrumentation.h"
+
+namespace openanim {
+
+Crowd::Character::Character(const std::shared_ptr<const Hierarchy>& h, const std::shared_ptr<const Kinematics>& k) : m_kinematics(k), m_local(h), m_world(h) {
+}
+
+std::size_t Crowd::Character::addLayer(const AnimationClip& clip, float weight) {
+	assert(clip.sharedHierarchy() == m_local.sharedHierarchy());
+	assert(weight >= 0.0f);
+
+	m_samplers.push_back(ClipSampler(clip));
+	m_times.push_back(0.0f);
+	m_weights.push_back(weight);
+
+	// the sampled poses are only needed for blending
+	if(m_samplers.size() > 1) {
+		m_samples.resize(m_samplers.size(), m_local);
+		m_samplePointers.resize(m_samplers.size());
+	}
+
+	return m_samplers.size() - 1;
+}
+
+std::size_t Crowd::Character::layerCount() const {
+	return m_samplers.size();
+}
+
+void Crowd::Character::setTime(std::size_t layer, float time) {
+	assert(layer < m_times.size());
+	m_times[layer] = time;
+}
+
+float Crowd::Character::time(std::size_t layer) const {
+	assert(layer < m_times.size());
+	return m_times[layer];
+}
+
+void Crowd::Character::setWeight(std::size_t layer, float weight) {
+	assert(layer < m_weights.size());
+	assert(weight >= 0.0f);
+	m_weights[layer] = weight;
+}
+
+float Crowd::Character::weight(std::size_t layer) const {
+	assert(layer < m_weights.size());
+	return m_weights[layer];
+}
+
+void Crowd::Character::setLooping(std::size_t layer, bool looping) {
+	assert(layer < m_samplers.size());
+	m_samplers[layer].setLooping(looping);
+}
+
+const Pose& Crowd::Character::localPose() const {
+	return m_local;
+}
+
+Pose& Crowd::Character::localPose() {
+	return m_local;
+}
+
+const Pose& Crowd::Character::worldPose() const {
+	return m_world;
+}
+
+void Crowd::Character::evaluate() {
+	float sum = 0.0f;
+	for(auto& w : m_weights)
+		sum += w;
+
+	// a single layer, or no weight at all - just the first layer
+	if(m_samplers.size() == 1 || (!m_samplers.empty() && sum <= 0.0f))
+		m_samplers[0].sample(m_times[0], m_local);
+
+	else if(m_samplers.size() > 1) {
+		for(std::size_t l = 0; l < m_samplers.size(); ++l) {
+			m_samplers[l].sample(m_times[l], m_samples[l]);
+			m_samplePointers[l] = &m_samples[l];
+		}
+
+		blend(m_samplePointers.data(), m_weights.data(), m_samples.size(), m_local);
+	}
+
+	m_kinematics->localToWorld(m_local, m_world);
+}
+
+////////
+
+Crowd::Crowd() {
+}
+
+std::size_t Crowd::add(const std::shared_ptr<const Hierarchy>& h) {
+	std::shared_ptr<const Kinematics>& k = m_kinematics[h.get()];
+	if(k == NULL)
+		k = std::make_shared<const Kinematics>(*h);
+
+	m_characters.push_back(Character(h, k));
+
+	return m_characters.size() - 1;
+}
+
+bool Crowd::empty() const {
+	return m_characters.empty();
+}
+
+std::size_t Crowd::size() const {
+	return m_characters.size();
+}
+
+Crowd::Character& Crowd::operator[](std::size_t index) {
+	assert(index < m_characters.size());
+	return m_characters[index];
+}
+
+const Crowd::Character& Crowd::operator[](std::size_t index) const {
+	assert(index < m_characters.size());
+	return m_characters[index];
+}
+
+void Crowd::advance(float dt) {
+	for(auto& c : m_characters)
+		for(auto& t : c.m_times)
+			t += dt;
+}
+
+void Crowd::evaluate() {
+	OPENANIM_TIMER("crowd/evaluate");
+
+	// each character is evaluated by exactly one task, writing only its own data
+	tbb::parallel_for(tbb::blocked_range<std::size_t>(0, m_characters.size()), [&](const tbb::blocked_range<std::size_t>& range) {
+		for(std::size_t c = range.begin(); c != range.end(); ++c)
+			m_characters[c].evaluate();
+	});
+}
+
+}
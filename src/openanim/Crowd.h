@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <map>
+
+#include "Pose.h"
+#include "AnimationClip.h"
+#include "ClipSampler.h"
+#include "Kinematics.h"
+
+namespace openanim {
+
+/// Evaluates the animation of many characters in parallel. Each character has a local and a world-space
+/// pose, and a set of animation layers (clips sampled at given times, blended by their weights). The
+/// evaluation - sampling, blending and forward kinematics - is distributed over the characters by TBB's
+/// work-stealing scheduler. Characters are independent, and all per-character state (including the key
+/// cursors of the samplers) is owned by the character, which makes the results deterministic regardless
+/// of the number of threads. Characters of the same Hierarchy instance share its Kinematics tables.
+class Crowd {
+	public:
+		class Character {
+			public:
+				/// adds an animation layer, returning its index. The clip has to be compatible with the
+				/// character's pose, and has to outlive the crowd.
+				std::size_t addLayer(const AnimationClip& clip, float weight = 1.0f);
+				std::size_t layerCount() const;
+
+				/// sampling time of a layer (in seconds)
+				void setTime(std::size_t layer, float time);
+				float time(std::size_t layer) const;
+
+				/// blending weight of a layer; weights are normalized by their sum during evaluation. If the
+				/// weights of all layers are zero, the result is the pose of the first layer.
+				void setWeight(std::size_t layer, float weight);
+				float weight(std::size_t layer) const;
+
+				/// sampling time of a looping layer wraps around the clip's duration
+				void setLooping(std::size_t layer, bool looping);
+
+				/// local pose - the result of the evaluation (or the pose used if there are no layers)
+				const Pose& localPose() const;
+				Pose& localPose();
+				/// world-space pose, computed by the evaluation
+				const Pose& worldPose() const;
+
+			protected:
+			private:
+				Character(const std::shared_ptr<const Hierarchy>& h, const std::shared_ptr<const Kinematics>& k);
+
+				/// samples and blends all layers, and computes the world pose
+				void evaluate();
+
+				std::shared_ptr<const Kinematics> m_kinematics;
+
+				Pose m_local, m_world;
+
+				std::vector<ClipSampler> m_samplers;
+				std::vector<float> m_times, m_weights;
+
+				// sampled poses of all layers (only if there is more than one layer), and pointers to
+				// them for blending (filled during each evaluation - characters can be moved)
+				std::vector<Pose> m_samples;
+				std::vector<const Pose*> m_samplePointers;
+
+			friend class Crowd;
+		};
+
+		Crowd();
+
+		/// adds a character with an identity pose of the hierarchy h; returns its index
+		std::size_t add(const std::shared_ptr<const Hierarchy>& h);
+
+		bool empty() const;
+		std::size_t size() const;
+
+		Character& operator[](std::size_t index);
+		const Character& operator[](std::size_t index) const;
+
+		/// advances the time of all layers of all characters
+		void advance(float dt);
+
+		/// evaluates all characters in parallel
+		void evaluate();
+
+	protected:
+	private:
+		std::vector<Character> m_characters;
+
+		// kinematics tables, shared between characters of the same hierarchy instance
+		std::map<const Hierarchy*, std::shared_ptr<const Kinematics>> m_kinematics;
+};
+
+}
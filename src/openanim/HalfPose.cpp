@@ -0,0 +1,148 @@
+#include "HalfPose.h"
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+#include "Simd.h"
+#include "Instrumentation.h"
+
+namespace openanim {
+
+namespace {
+	static_assert(sizeof(half) == 2, "half is expected to be a plain 16 bit value");
+	static_assert(sizeof(Imath::V3f) == 3 * sizeof(float), "V3f is expected to be 3 packed floats");
+	static_assert(sizeof(Imath::Quatf) == 4 * sizeof(float), "Quatf is expected to be 4 packed floats");
+
+	/// converts count floats multiplied by scale to halfs
+	void toHalf(const float* source, half* target, std::size_t count, float scale) {
+		std::size_t i = 0;
+
+#if defined(__F16C__)
+		const __m256 s = _mm256_set1_ps(scale);
+		for(; i + 8 <= count; i += 8) {
+			const __m128i h = _mm256_cvtps_ph(_mm256_mul_ps(_mm256_loadu_ps(source + i), s), _MM_FROUND_TO_NEAREST_INT);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), h);
+		}
+#endif
+
+		for(; i < count; ++i)
+			target[i] = half(source[i] * scale);
+	}
+
+	/// converts count halfs to floats multiplied by scale
+	void toFloat(const half* source, float* target, std::size_t count, float scale) {
+		std::size_t i = 0;
+
+#if defined(__F16C__)
+		const __m256 s = _mm256_set1_ps(scale);
+		for(; i + 8 <= count; i += 8) {
+			const __m256 f = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)));
+			_mm256_storeu_ps(target + i, _mm256_mul_ps(f, s));
+		}
+#endif
+
+		for(; i < count; ++i)
+			target[i] = (float)source[i] * scale;
+	}
+
+	template<typename F>
+	void normalize(Pose& pose, std::size_t i) {
+		simd::Transforms<F> tr;
+		simd::load(tr, pose.translations() + i, pose.rotations() + i);
+		simd::normalize(tr);
+		simd::store(tr, pose.translations() + i, pose.rotations() + i);
+	}
+}
+
+HalfPose::HalfPose() : m_hierarchy(new Hierarchy()), m_translationScale(1.0f) {
+}
+
+HalfPose::HalfPose(const Pose& pose, bool scaleTranslations) : m_translationScale(1.0f) {
+	compress(pose, scaleTranslations);
+}
+
+const Hierarchy& HalfPose::hierarchy() const {
+	return *m_hierarchy;
+}
+
+const std::shared_ptr<const Hierarchy>& HalfPose::sharedHierarchy() const {
+	return m_hierarchy;
+}
+
+bool HalfPose::empty() const {
+	return m_data.empty();
+}
+
+std::size_t HalfPose::size() const {
+	assert(m_data.size() % 7 == 0);
+	return m_data.size() / 7;
+}
+
+const Transform HalfPose::operator[](std::size_t index) const {
+	assert(index < size());
+
+	const half* t = &m_data[index * 3];
+	const half* r = &m_data[size() * 3 + index * 4];
+
+	Imath::Quatf rotation(r[0], r[1], r[2], r[3]);
+	rotation.normalize();
+
+	return Transform(rotation, Imath::V3f(t[0], t[1], t[2]) * m_translationScale);
+}
+
+float HalfPose::translationScale() const {
+	return m_translationScale;
+}
+
+void HalfPose::compress(const Pose& pose, bool scaleTranslations) {
+	OPENANIM_TIMER("half_pose/compress");
+
+	m_hierarchy = pose.sharedHierarchy();
+	m_data.resize(pose.size() * 7);
+
+	const float* translations = reinterpret_cast<const float*>(pose.translations());
+	const float* rotations = reinterpret_cast<const float*>(pose.rotations());
+
+	m_translationScale = 1.0f;
+	if(scaleTranslations) {
+		float maximum = 0.0f;
+		for(std::size_t i = 0; i < pose.size() * 3; ++i)
+			maximum = std::max(maximum, std::abs(translations[i]));
+
+		if(maximum > 0.0f)
+			m_translationScale = maximum;
+	}
+
+	toHalf(translations, m_data.data(), pose.size() * 3, 1.0f / m_translationScale);
+	toHalf(rotations, m_data.data() + pose.size() * 3, pose.size() * 4, 1.0f);
+}
+
+void HalfPose::decompress(Pose& pose) const {
+	OPENANIM_TIMER("half_pose/decompress");
+
+	assert(isCompatibleWith(pose));
+
+	toFloat(m_data.data(), reinterpret_cast<float*>(pose.translations()), size() * 3, m_translationScale);
+	toFloat(m_data.data() + size() * 3, reinterpret_cast<float*>(pose.rotations()), size() * 4, 1.0f);
+
+	std::size_t i = 0;
+	for(; i + simd::native::width <= size(); i += simd::native::width)
+		normalize<simd::native>(pose, i);
+	for(; i < size(); ++i)
+		normalize<simd::float1>(pose, i);
+}
+
+std::size_t HalfPose::dataSize() const {
+	return m_data.size() * sizeof(half);
+}
+
+bool HalfPose::isCompatibleWith(const Pose& p) const {
+	return m_hierarchy == p.sharedHierarchy();
+}
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include <boost/serialization/access.hpp>
+
+#include <half.h>
+
+#include "Pose.h"
+
+namespace openanim {
+
+/// HalfPose is a compact copy of a Pose, storing its translations and rotations as half-precision
+/// floats (14 bytes per joint instead of 28), intended for large numbers of cached poses (pose caches,
+/// history buffers, motion databases). Translations can optionally be stored relative to a per-pose
+/// scale (the largest absolute translation component), which keeps large translations within the
+/// range of half. Rotations are renormalized when decompressed. The conversions are done in bulk,
+/// using F16C instructions if the library is built with them.
+class HalfPose {
+	public:
+		/// creates an empty compressed pose of an empty hierarchy
+		HalfPose();
+		/// compresses a pose
+		explicit HalfPose(const Pose& pose, bool scaleTranslations = false);
+
+		const Hierarchy& hierarchy() const;
+		const std::shared_ptr<const Hierarchy>& sharedHierarchy() const;
+
+		bool empty() const;
+		std::size_t size() const;
+
+		/// decompresses a single joint transformation
+		const Transform operator[](std::size_t index) const;
+
+		/// scale applied to the stored translations (1 if not scaled)
+		float translationScale() const;
+
+		/// compresses a pose into this instance, reusing its storage if the size matches
+		void compress(const Pose& pose, bool scaleTranslations = false);
+		/// decompresses into a compatible pose (a pose sharing the same hierarchy instance)
+		void decompress(Pose& pose) const;
+
+		/// size of the compressed data in bytes
+		std::size_t dataSize() const;
+
+		/// returns true if this pose can be decompressed into p (if they share the same hierarchy instance)
+		bool isCompatibleWith(const Pose& p) const;
+
+	protected:
+	private:
+		/// serializes the compressed data as raw 16-bit values (see Serialization.h)
+		template<typename ARCHIVE>
+		void serialize(ARCHIVE& ar, const unsigned int version);
+
+		std::shared_ptr<const Hierarchy> m_hierarchy;
+
+		// 3 translation components per joint, followed by 4 rotation components (r, x, y, z) per joint
+		std::vector<half> m_data;
+		float m_translationScale;
+
+	friend class boost::serialization::access;
+};
+
+}
@@ -1,7 +1,12 @@
 #include "Hierarchy.h"
 
 #include <cassert>
+#include <cstring>
+#include <algorithm>
 #include <iostream>
+#include <utility>
+
+#include "Instrumentation.h"
 
 using std::cout;
 using std::endl;
@@ -10,6 +15,151 @@ namespace openanim {
 
 ////////
 
+Hierarchy::Hierarchy() : m_layout(BreadthFirst) {
+}
+
+Hierarchy::Hierarchy(const std::vector<std::string>& names, const std::vector<int>& parents, std::vector<std::size_t>* mapping, Layout layout) : m_layout(layout) {
+	build(names, parents, mapping);
+}
+
+Hierarchy::Hierarchy(const Hierarchy& source, Layout layout, std::vector<std::size_t>* mapping) : m_layout(layout) {
+	std::vector<std::string> names(source.size());
+	std::vector<int> parents(source.size());
+	for(std::size_t i = 0; i < source.size(); ++i) {
+		names[i] = source.name(i);
+		parents[i] = source[i].parent;
+	}
+
+	build(names, parents, mapping);
+}
+
+Hierarchy::Hierarchy(const Hierarchy& h) : m_items(h.m_items), m_layout(h.m_layout), m_names(h.m_names), m_index(h.m_index) {
+	OPENANIM_COUNT("hierarchy/clone", 1);
+}
+
+Hierarchy& Hierarchy::operator = (const Hierarchy& h) {
+	OPENANIM_COUNT("hierarchy/clone", 1);
+
+	m_items = h.m_items;
+	m_layout = h.m_layout;
+	m_names = h.m_names;
+	m_index = h.m_index;
+
+	return *this;
+}
+
+Hierarchy::Hierarchy(Hierarchy&& h) : m_items(std::move(h.m_items)), m_layout(h.m_layout), m_names(std::move(h.m_names)), m_index(std::move(h.m_index)) {
+}
+
+Hierarchy& Hierarchy::operator = (Hierarchy&& h) {
+	m_items = std::move(h.m_items);
+	m_layout = h.m_layout;
+	m_names = std::move(h.m_names);
+	m_index = std::move(h.m_index);
+
+	return *this;
+}
+
+void Hierarchy::build(const std::vector<std::string>& names, const std::vector<int>& parents, std::vector<std::size_t>* mapping) {
+	OPENANIM_TIMER("hierarchy/build");
+
+	assert(names.size() == parents.size());
+
+	if(names.empty())
+		return;
+
+	// counting sort of table entries by their parents, keeping the table order of siblings
+	//   (children of entry i are children[childrenBegin[i] .. childrenBegin[i+1]) )
+	std::vector<std::size_t> childrenBegin(parents.size() + 1, 0);
+	int root = -1;
+	for(std::size_t i = 0; i < parents.size(); ++i)
+		if(parents[i] >= 0) {
+			assert((std::size_t)parents[i] < parents.size());
+			++childrenBegin[parents[i] + 1];
+		}
+		else {
+			assert(root < 0 && "only a single root is allowed");
+			root = i;
+		}
+	assert(root >= 0 && "the table has to contain a root");
+
+	for(std::size_t i = 1; i < childrenBegin.size(); ++i)
+		childrenBegin[i] += childrenBegin[i-1];
+
+	std::vector<std::size_t> children(parents.size());
+	{
+		std::vector<std::size_t> current(childrenBegin.begin(), childrenBegin.end()-1);
+		for(std::size_t i = 0; i < parents.size(); ++i)
+			if(parents[i] >= 0)
+				children[current[parents[i]]++] = i;
+	}
+
+	std::vector<std::size_t> order;
+	order.reserve(parents.size());
+
+	std::vector<std::size_t> index(parents.size());
+	m_items.reserve(parents.size());
+
+	if(m_layout == BreadthFirst) {
+		// breadth-first traversal from the root generates the flat layout directly - the
+		// children of each item are appended in one contiguous block
+		order.push_back(root);
+
+		for(std::size_t i = 0; i < order.size(); ++i) {
+			const std::size_t current = order[i];
+			index[current] = i;
+
+			const std::size_t begin = order.size();
+			for(std::size_t c = childrenBegin[current]; c < childrenBegin[current+1]; ++c)
+				order.push_back(children[c]);
+
+			m_items.push_back(Item{0, parents[current] >= 0 ? (int)index[parents[current]] : -1, begin, order.size()});
+		}
+	}
+
+	else {
+		// pre-order traversal with an explicit stack (chains can be very long); children are pushed
+		// in reverse, to keep their table order
+		std::vector<std::size_t> stack(1, root);
+		while(!stack.empty()) {
+			const std::size_t current = stack.back();
+			stack.pop_back();
+
+			index[current] = order.size();
+			order.push_back(current);
+
+			for(std::size_t c = childrenBegin[current+1]; c > childrenBegin[current]; --c)
+				stack.push_back(children[c-1]);
+
+			m_items.push_back(Item{0, parents[current] >= 0 ? (int)index[parents[current]] : -1, order.size(), order.size()});
+		}
+
+		// subtree ends, accumulated in reverse order (children are always after their parents)
+		for(std::size_t i = m_items.size(); i > 0; --i) {
+			const Item& item = m_items[i-1];
+			if(item.parent >= 0)
+				m_items[item.parent].children_end = std::max(m_items[item.parent].children_end, item.children_end);
+		}
+	}
+
+	assert(m_items.size() == parents.size() && "the table contains entries not connected to the root");
+
+	// the name pool and index, in the item order (lookups return the first item of a given name)
+	std::size_t indexSize = 1;
+	while(indexSize < parents.size() * 2)
+		indexSize *= 2;
+	m_index.resize(indexSize, Slot{0, -1});
+
+	for(std::size_t i = 0; i < order.size(); ++i) {
+		const std::uint32_t h = hash(names[order[i]].c_str());
+		m_items[i].name_offset = intern(names[order[i]].c_str(), h);
+		addToIndex(i, h);
+	}
+
+	if(mapping != NULL)
+		mapping->swap(index);
+}
+
 const Hierarchy::Item& Hierarchy::operator[](std::size_t index) const {
 	assert(index < m_items.size());
 	return m_items[index];
@@ -23,17 +173,107 @@ size_t Hierarchy::size() const {
 	return m_items.size();
 }
 
+Hierarchy::Layout Hierarchy::layout() const {
+	return m_layout;
+}
+
+std::size_t Hierarchy::subtreeEnd(std::size_t index) const {
+	assert(m_layout == DepthFirst);
+	assert(index < m_items.size());
+	return m_items[index].children_end;
+}
+
 std::size_t Hierarchy::indexOf(const Item& j) const {
 	return (&j - &(*m_items.begin()));
 }
 
+const char* Hierarchy::name(std::size_t index) const {
+	assert(index < m_items.size());
+	return &m_names[m_items[index].name_offset];
+}
+
+std::uint32_t Hierarchy::hash(const char* name) {
+	std::uint32_t result = 2166136261u;
+	for(; *name != '\0'; ++name) {
+		result ^= (unsigned char)*name;
+		result *= 16777619u;
+	}
+
+	return result;
+}
+
+int Hierarchy::find(const char* name) const {
+	return find(name, hash(name));
+}
+
+int Hierarchy::find(const std::string& name) const {
+	return find(name.c_str(), hash(name.c_str()));
+}
+
+int Hierarchy::find(const char* name, std::uint32_t hash) const {
+	if(m_index.empty())
+		return -1;
+
+	const std::size_t mask = m_index.size() - 1;
+	for(std::size_t i = hash & mask; m_index[i].item >= 0; i = (i + 1) & mask) {
+		const Slot& slot = m_index[i];
+		if((slot.hash == hash) && (std::strcmp(&m_names[m_items[slot.item].name_offset], name) == 0))
+			return slot.item;
+	}
+
+	return -1;
+}
+
+std::size_t Hierarchy::intern(const char* name, std::uint32_t hash) {
+	// an existing item with the same name already has the string in the pool
+	const int existing = find(name, hash);
+	if(existing >= 0)
+		return m_items[existing].name_offset;
+
+	const std::size_t result = m_names.size();
+	m_names.insert(m_names.end(), name, name + std::strlen(name) + 1);
+
+	return result;
+}
+
+void Hierarchy::addToIndex(std::size_t item, std::uint32_t hash) {
+	assert(m_index.size() >= m_items.size() * 2);
+
+	const std::size_t mask = m_index.size() - 1;
+
+	std::size_t i = hash & mask;
+	while(m_index[i].item >= 0)
+		i = (i + 1) & mask;
+
+	m_index[i] = Slot{hash, (int)item};
+}
+
+void Hierarchy::reindex() {
+	// keep the load factor at most 0.5
+	std::size_t indexSize = 1;
+	while(indexSize < m_items.size() * 2)
+		indexSize *= 2;
+
+	m_index.assign(indexSize, Slot{0, -1});
+
+	// items are inserted in order, so that lookups return the first item of a given name
+	for(std::size_t i = 0; i < m_items.size(); ++i)
+		addToIndex(i, hash(&m_names[m_items[i].name_offset]));
+}
+
 void Hierarchy::addRoot(const std::string& name) {
+	OPENANIM_TIMER("hierarchy/add_root");
+
+	assert(m_layout == BreadthFirst);
+
+	const std::size_t nameOffset = intern(name.c_str(), hash(name.c_str()));
+
 	if(empty())
 		// create a single root Item, with children "behind the end"
-		m_items.push_back(Item{name, -1, 1, 1});
+		m_items.push_back(Item{nameOffset, -1, 1, 1});
 	else {
 		// add a new Item at the beginning
-		m_items.insert(m_items.begin(), Item{name, -1, 1, 2});
+		m_items.insert(m_items.begin(), Item{nameOffset, -1, 1, 2});
 		// and update the children indices of all following Items
 		for(auto it = m_items.begin()+1; it != m_items.end(); ++it) {
 			++it->children_begin;
@@ -42,9 +282,17 @@ void Hierarchy::addRoot(const std::string& name) {
 			++it->parent;
 		}
 	}
+
+	reindex();
 }
 
 std::size_t Hierarchy::addChild(const Item& j, const std::string& name) {
+	OPENANIM_TIMER("hierarchy/add_child");
+
+	assert(m_layout == BreadthFirst);
+
+	const std::size_t nameOffset = intern(name.c_str(), hash(name.c_str()));
+
 	// find the Item's last child - the position we'll be inserting into
 	const std::size_t lastChild = j.children_end;
 	assert(lastChild > indexOf(j));
@@ -78,7 +326,10 @@ std::size_t Hierarchy::addChild(const Item& j, const std::string& name) {
 		++childPos;
 
 	// and insert the Item
-	m_items.insert(m_items.begin() + lastChild, Item{name, (int)currentIndex, childPos, childPos});
+	m_items.insert(m_items.begin() + lastChild, Item{nameOffset, (int)currentIndex, childPos, childPos});
+
+	// indices of items were shifted
+	reindex();
 
 	// and return the index of newly inserted Item
 	return lastChild;
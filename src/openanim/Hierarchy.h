@@ -2,10 +2,10 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
 
 #include <boost/noncopyable.hpp>
-
-#include "Children.h"
+#include <boost/serialization/access.hpp>
 
 namespace openanim {
 
@@ -13,19 +13,69 @@ namespace openanim {
 /// objects. It guarantees that the index of parent joint is always lower than index of children joints,
 /// allowing for replacing recursive operations (e.g, world-to-local conversion) to simple iterations.
 /// The internal representation of joint data might change in the future (the interface will probably not).
+/// Joint names are interned in a single contiguous string pool, with an open-addressing hash index
+/// allowing constant-time name lookups.
+///
+/// Two flat layouts are supported. The default BreadthFirst layout stores the children of each item
+/// contiguously ([children_begin, children_end) range). The DepthFirst (pre-order) layout stores each
+/// subtree contiguously instead - the descendants of an item form the range [index+1, subtreeEnd(index)),
+/// which is what children_begin and children_end hold in this layout. Direct children in the DepthFirst
+/// layout are found by skipping subtrees (the first child is index+1, each next sibling starts at the
+/// subtreeEnd() of the previous one), which is what Children does for both layouts. Incremental editing (addRoot(), addChild()) is supported only
+/// by the BreadthFirst layout.
 class Hierarchy {
 	public:
 		struct Item {
-			std::string name;
+			std::size_t name_offset;
 			int parent;
 			std::size_t children_begin, children_end;
 		};
 
+		enum Layout {
+			BreadthFirst,
+			DepthFirst
+		};
+
+		/// creates an empty hierarchy
+		Hierarchy();
+		/// creates a hierarchy from a table of joint names and parent indices (-1 for the root) in a single
+		/// linear pass. The table can be in any order, as long as it describes a single tree; siblings keep
+		/// their relative order from the table. If not NULL, mapping receives the index of each table
+		/// entry in the resulting hierarchy.
+		Hierarchy(const std::vector<std::string>& names, const std::vector<int>& parents, std::vector<std::size_t>* mapping = NULL, Layout layout = BreadthFirst);
+		/// creates a copy of a hierarchy in a different layout. If not NULL, mapping receives the index of
+		/// each item of the source hierarchy in the new one (see also Pose's remapping constructor).
+		Hierarchy(const Hierarchy& source, Layout layout, std::vector<std::size_t>* mapping = NULL);
+
+		/// copying a hierarchy is counted by the "hierarchy/clone" instrumentation probe
+		Hierarchy(const Hierarchy& h);
+		Hierarchy& operator = (const Hierarchy& h);
+
+		Hierarchy(Hierarchy&& h);
+		Hierarchy& operator = (Hierarchy&& h);
+
 		const Item& operator[](std::size_t index) const;
 
 		bool empty() const;
 		size_t size() const;
 
+		Layout layout() const;
+
+		/// end of the contiguous range of the subtree of an item (DepthFirst layout only)
+		std::size_t subtreeEnd(std::size_t index) const;
+
+		/// name of an item (a zero-terminated string from the name pool)
+		const char* name(std::size_t index) const;
+
+		/// returns the index of the first item with given name, or -1 if not found. Does not allocate.
+		int find(const char* name) const;
+		int find(const std::string& name) const;
+		/// lookup using a precomputed hash of the name (see hash())
+		int find(const char* name, std::uint32_t hash) const;
+
+		/// the hash function used for name lookups (32 bit FNV-1a)
+		static std::uint32_t hash(const char* name);
+
 		void addRoot(const std::string& name);
 		std::size_t addChild(const Item& i, const std::string& name);
 
@@ -39,9 +89,36 @@ class Hierarchy {
 
 	protected:
 	private:
+		/// serializes the items and the name pool; the name index is rebuilt on loading (see Serialization.h)
+		template<typename ARCHIVE>
+		void serialize(ARCHIVE& ar, const unsigned int version);
+
 		std::size_t indexOf(const Item& j) const;
 
+		/// builds the items and the name index from a table of names and parents
+		void build(const std::vector<std::string>& names, const std::vector<int>& parents, std::vector<std::size_t>* mapping);
+
+		/// returns the offset of a name in the pool, adding it if not present yet
+		std::size_t intern(const char* name, std::uint32_t hash);
+		/// inserts a single item into the index
+		void addToIndex(std::size_t item, std::uint32_t hash);
+		/// rebuilds the whole name index (needed after items are shifted)
+		void reindex();
+
+		struct Slot {
+			std::uint32_t hash;
+			int item;
+		};
+
 		std::vector<Item> m_items;
+		Layout m_layout;
+		// all names, stored as zero-terminated strings
+		std::vector<char> m_names;
+		// open-addressing hash table (linear probing), size is a power of two
+		std::vector<Slot> m_index;
+
+	friend class Asset;
+	friend class boost::serialization::access;
 };
 
 }
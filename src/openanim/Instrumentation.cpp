@@ -0,0 +1,169 @@
+#include "Instrumentation.h"
+
+#include <cassert>
+#include <atomic>
+#include <mutex>
+#include <set>
+
+namespace openanim {
+
+namespace instrumentation {
+
+namespace {
+	/// values of all probes recorded by a single thread. Only the owning thread writes the values,
+	/// the atomics (with relaxed ordering) just make the reads by the query functions well-defined.
+	struct Values {
+		Values();
+
+		std::atomic<std::uint64_t> counts[s_maxProbes];
+		std::atomic<std::uint64_t> nanoseconds[s_maxProbes];
+	};
+
+	Values::Values() {
+		for(std::size_t p = 0; p < s_maxProbes; ++p) {
+			counts[p].store(0, std::memory_order_relaxed);
+			nanoseconds[p].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	/// global state - the probe names, the values of all live threads, and the accumulated values of
+	/// finished threads
+	struct Registry {
+		std::mutex mutex;
+		std::vector<std::string> names;
+		std::set<Values*> threads;
+		Values finished;
+	};
+
+	Registry& registry() {
+		// never destroyed - thread-local storage can be destroyed after static objects
+		static Registry* s_registry = new Registry();
+		return *s_registry;
+	}
+
+	/// per-thread storage, registered for the lifetime of the thread
+	struct ThreadValues : public Values {
+		ThreadValues() {
+			Registry& r = registry();
+			std::lock_guard<std::mutex> lock(r.mutex);
+			r.threads.insert(this);
+		}
+
+		~ThreadValues() {
+			Registry& r = registry();
+			std::lock_guard<std::mutex> lock(r.mutex);
+
+			for(std::size_t p = 0; p < s_maxProbes; ++p) {
+				r.finished.counts[p].fetch_add(counts[p].load(std::memory_order_relaxed), std::memory_order_relaxed);
+				r.finished.nanoseconds[p].fetch_add(nanoseconds[p].load(std::memory_order_relaxed), std::memory_order_relaxed);
+			}
+			r.threads.erase(this);
+		}
+	};
+
+	Values& threadValues() {
+		static thread_local ThreadValues t_values;
+		return t_values;
+	}
+}
+
+bool enabled() {
+#ifdef OPENANIM_INSTRUMENTATION
+	return true;
+#else
+	return false;
+#endif
+}
+
+std::size_t probe(const char* name) {
+	Registry& r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+
+	for(std::size_t p = 0; p < r.names.size(); ++p)
+		if(r.names[p] == name)
+			return p;
+
+	// out of probes - share the last one, rather than writing beyond the per-thread arrays
+	if(r.names.size() >= s_maxProbes - 1) {
+		if(r.names.size() < s_maxProbes)
+			r.names.push_back("instrumentation/overflow");
+		return s_maxProbes - 1;
+	}
+
+	r.names.push_back(name);
+
+	return r.names.size() - 1;
+}
+
+void record(std::size_t probe, std::uint64_t count, std::uint64_t nanoseconds) {
+	assert(probe < s_maxProbes);
+
+	// only this thread writes these values - no need for an atomic read-modify-write
+	Values& v = threadValues();
+	v.counts[probe].store(v.counts[probe].load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+	v.nanoseconds[probe].store(v.nanoseconds[probe].load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+}
+
+std::vector<Entry> snapshot() {
+	Registry& r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+
+	std::vector<Entry> result;
+	for(std::size_t p = 0; p < r.names.size(); ++p) {
+		std::uint64_t count = r.finished.counts[p].load(std::memory_order_relaxed);
+		std::uint64_t nanoseconds = r.finished.nanoseconds[p].load(std::memory_order_relaxed);
+
+		for(auto& t : r.threads) {
+			count += t->counts[p].load(std::memory_order_relaxed);
+			nanoseconds += t->nanoseconds[p].load(std::memory_order_relaxed);
+		}
+
+		result.push_back(Entry{r.names[p], count, (double)nanoseconds * 1e-9});
+	}
+
+	return result;
+}
+
+Entry query(const std::string& name) {
+	for(auto& e : snapshot())
+		if(e.name == name)
+			return e;
+
+	return Entry{name, 0, 0.0};
+}
+
+void reset() {
+	Registry& r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+
+	// values of other threads are reset without synchronization with their writes - a concurrent
+	// update can be lost (or survive the reset), which is acceptable for statistics
+	std::vector<Values*> all(r.threads.begin(), r.threads.end());
+	all.push_back(&r.finished);
+
+	for(auto& v : all)
+		for(std::size_t p = 0; p < s_maxProbes; ++p) {
+			v->counts[p].store(0, std::memory_order_relaxed);
+			v->nanoseconds[p].store(0, std::memory_order_relaxed);
+		}
+}
+
+void dump(std::ostream& out) {
+	out << "# name\tcount\tseconds" << std::endl;
+	for(auto& e : snapshot())
+		out << e.name << '\t' << e.count << '\t' << e.seconds << std::endl;
+}
+
+////////
+
+ScopedTimer::ScopedTimer(std::size_t probe) : m_probe(probe), m_start(std::chrono::steady_clock::now()) {
+}
+
+ScopedTimer::~ScopedTimer() {
+	const auto duration = std::chrono::steady_clock::now() - m_start;
+	record(m_probe, 1, std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+}
+
+}
+
+}
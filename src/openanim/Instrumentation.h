@@ -0,0 +1,89 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <cstdint>
+
+namespace openanim {
+
+/// Opt-in instrumentation of the library's hot paths - named counters and scoped timers ("probes").
+/// Probes are placed using the OPENANIM_COUNT() and OPENANIM_TIMER() macros, which compile to nothing
+/// unless the library is built with OPENANIM_INSTRUMENTATION defined (the OPENANIM_INSTRUMENTATION cmake
+/// option). Each thread records into its own storage without any synchronization; the query functions
+/// aggregate the values of all threads (including threads that already finished).
+namespace instrumentation {
+
+/// aggregated values of a single probe
+struct Entry {
+	std::string name;
+	/// number of counted events (or timed scopes)
+	std::uint64_t count;
+	/// total time spent in timed scopes (0 for plain counters)
+	double seconds;
+};
+
+/// maximum number of distinct probes. The last one is reserved - all probes registered after the
+/// others are used up share it, under the name "instrumentation/overflow".
+static const std::size_t s_maxProbes = 256;
+
+/// returns true if the library was built with instrumentation enabled
+bool enabled();
+
+/// values of all probes, aggregated over all threads (in the order of their first use)
+std::vector<Entry> snapshot();
+/// values of a single probe (a zero entry if the probe wasn't used yet)
+Entry query(const std::string& name);
+/// resets all values to zero
+void reset();
+/// writes all values as tab-separated text (name, count, seconds)
+void dump(std::ostream& out);
+
+/// returns the index of a named probe, registering it on the first call (used by the macros)
+std::size_t probe(const char* name);
+/// adds to the values of a probe in the current thread (used by the macros)
+void record(std::size_t probe, std::uint64_t count, std::uint64_t nanoseconds = 0);
+
+/// measures the time of a scope (used by OPENANIM_TIMER)
+class ScopedTimer {
+	public:
+		explicit ScopedTimer(std::size_t probe);
+		~ScopedTimer();
+
+	protected:
+	private:
+		ScopedTimer(const ScopedTimer&);
+		ScopedTimer& operator = (const ScopedTimer&);
+
+		std::size_t m_probe;
+		std::chrono::steady_clock::time_point m_start;
+};
+
+}
+
+}
+
+#ifdef OPENANIM_INSTRUMENTATION
+
+#define OPENANIM_INSTRUMENTATION_CONCAT2(A, B) A##B
+#define OPENANIM_INSTRUMENTATION_CONCAT(A, B) OPENANIM_INSTRUMENTATION_CONCAT2(A, B)
+
+/// adds N to a named counter
+#define OPENANIM_COUNT(NAME, N) \
+	do { \
+		static const std::size_t openanim_probe = openanim::instrumentation::probe(NAME); \
+		openanim::instrumentation::record(openanim_probe, (N)); \
+	} while(0)
+
+/// measures the time until the end of the current scope, under a given name
+#define OPENANIM_TIMER(NAME) \
+	static const std::size_t OPENANIM_INSTRUMENTATION_CONCAT(openanim_probe_, __LINE__) = openanim::instrumentation::probe(NAME); \
+	const openanim::instrumentation::ScopedTimer OPENANIM_INSTRUMENTATION_CONCAT(openanim_timer_, __LINE__)(OPENANIM_INSTRUMENTATION_CONCAT(openanim_probe_, __LINE__))
+
+#else
+
+#define OPENANIM_COUNT(NAME, N) do {} while(0)
+#define OPENANIM_TIMER(NAME) do {} while(0)
+
+#endif
@@ -0,0 +1,156 @@
+#include "Kinematics.h"
+
+#include <cassert>
+#include <algorithm>
+
+#include "Simd.h"
+#include "Instrumentation.h"
+
+namespace openanim {
+
+namespace {
+	// evaluates forward kinematics of one depth level in batches of F::width joints
+	template<typename F>
+	std::size_t localToWorldLevel(std::size_t begin, std::size_t end, const int* order, const int* parents,
+		const Imath::V3f* localTr, const Imath::Quatf* localRot, Imath::V3f* worldTr, Imath::Quatf* worldRot) {
+
+		simd::Transforms<F> local, parent, world;
+
+		for(; begin + F::width <= end; begin += F::width) {
+			simd::gather(local, localTr, localRot, order + begin);
+			simd::gather(parent, worldTr, worldRot, parents + begin);
+
+			simd::multiply(local, parent, world);
+
+			simd::scatter(world, worldTr, worldRot, order + begin);
+		}
+
+		return begin;
+	}
+
+	// converts world transformations of joints with parents to local space, in batches of F::width joints.
+	// Unlike forward kinematics, each joint is independent of the results of its parent.
+	template<typename F>
+	std::size_t worldToLocalBatch(std::size_t begin, std::size_t end, const int* order, const int* parents,
+		const Imath::V3f* worldTr, const Imath::Quatf* worldRot, Imath::V3f* localTr, Imath::Quatf* localRot) {
+
+		simd::Transforms<F> world, parent, parentInv, local;
+
+		for(; begin + F::width <= end; begin += F::width) {
+			simd::gather(world, worldTr, worldRot, order + begin);
+			simd::gather(parent, worldTr, worldRot, parents + begin);
+
+			simd::inverse(parent, parentInv);
+			simd::multiply(world, parentInv, local);
+
+			simd::scatter(local, localTr, localRot, order + begin);
+		}
+
+		return begin;
+	}
+}
+
+Kinematics::Kinematics(const Hierarchy& h) {
+	// depth of each joint - parents are always before children in the hierarchy
+	std::vector<std::size_t> depth(h.size(), 0);
+	std::size_t maxDepth = 0;
+	for(std::size_t ji = 0; ji < h.size(); ++ji)
+		if(h[ji].parent >= 0) {
+			assert((std::size_t)h[ji].parent < ji);
+
+			depth[ji] = depth[h[ji].parent] + 1;
+			maxDepth = std::max(maxDepth, depth[ji]);
+		}
+
+	// counting sort of joints by depth
+	m_levels.assign(maxDepth + 2, 0);
+	if(h.empty())
+		m_levels.resize(1);
+
+	for(auto& d : depth)
+		++m_levels[d+1];
+	for(std::size_t l = 1; l < m_levels.size(); ++l)
+		m_levels[l] += m_levels[l-1];
+
+	m_order.resize(h.size());
+	m_parents.resize(h.size());
+
+	std::vector<std::size_t> current(m_levels.begin(), m_levels.end()-1);
+	for(std::size_t ji = 0; ji < h.size(); ++ji) {
+		const std::size_t pos = current[depth[ji]]++;
+
+		m_order[pos] = ji;
+		m_parents[pos] = h[ji].parent;
+	}
+}
+
+bool Kinematics::empty() const {
+	return m_order.empty();
+}
+
+std::size_t Kinematics::size() const {
+	return m_order.size();
+}
+
+void Kinematics::localToWorld(const Imath::V3f* localTr, const Imath::Quatf* localRot, Imath::V3f* worldTr, Imath::Quatf* worldRot) const {
+	OPENANIM_TIMER("kinematics/local_to_world");
+
+	if(empty())
+		return;
+
+	// roots (level 0) just copy their transformations
+	for(std::size_t i = m_levels[0]; i < m_levels[1]; ++i) {
+		assert(m_parents[i] < 0);
+
+		worldTr[m_order[i]] = localTr[m_order[i]];
+		worldRot[m_order[i]] = localRot[m_order[i]];
+	}
+
+	// all other levels are processed in SIMD batches, with a scalar tail
+	for(std::size_t l = 1; l+1 < m_levels.size(); ++l) {
+		std::size_t begin = localToWorldLevel<simd::native>(m_levels[l], m_levels[l+1], m_order.data(), m_parents.data(),
+			localTr, localRot, worldTr, worldRot);
+		localToWorldLevel<simd::float1>(begin, m_levels[l+1], m_order.data(), m_parents.data(),
+			localTr, localRot, worldTr, worldRot);
+	}
+}
+
+void Kinematics::localToWorld(const Pose& local, Pose& world) const {
+	assert(local.size() == size());
+	assert(world.isCompatibleWith(local));
+	assert(&local != &world);
+
+	localToWorld(local.translations(), local.rotations(), world.translations(), world.rotations());
+}
+
+void Kinematics::worldToLocal(const Imath::V3f* worldTr, const Imath::Quatf* worldRot, Imath::V3f* localTr, Imath::Quatf* localRot) const {
+	OPENANIM_TIMER("kinematics/world_to_local");
+
+	if(empty())
+		return;
+
+	// roots just copy their transformations
+	for(std::size_t i = m_levels[0]; i < m_levels[1]; ++i) {
+		assert(m_parents[i] < 0);
+
+		localTr[m_order[i]] = worldTr[m_order[i]];
+		localRot[m_order[i]] = worldRot[m_order[i]];
+	}
+
+	// all other joints only depend on the (input) world transformation of their parents,
+	// allowing to process them all as a single SIMD batch
+	std::size_t begin = worldToLocalBatch<simd::native>(m_levels[1], m_order.size(), m_order.data(), m_parents.data(),
+		worldTr, worldRot, localTr, localRot);
+	worldToLocalBatch<simd::float1>(begin, m_order.size(), m_order.data(), m_parents.data(),
+		worldTr, worldRot, localTr, localRot);
+}
+
+void Kinematics::worldToLocal(const Pose& world, Pose& local) const {
+	assert(world.size() == size());
+	assert(local.isCompatibleWith(world));
+	assert(&local != &world);
+
+	worldToLocal(world.translations(), world.rotations(), local.translations(), local.rotations());
+}
+
+}
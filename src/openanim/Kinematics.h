@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+#include <ImathVec.h>
+#include <ImathQuat.h>
+
+#include "Hierarchy.h"
+#include "Pose.h"
+
+namespace openanim {
+
+/// Batched conversion of poses between local (parent-relative) and world space.
+/// Precomputes a flat table of joint parents sorted into depth levels - all joints of one level have
+/// their parents in previous levels, which allows to evaluate each level in SIMD batches. The evaluation
+/// itself does not allocate any memory, and can be shared between all poses of the same Hierarchy.
+class Kinematics {
+	public:
+		explicit Kinematics(const Hierarchy& h);
+
+		bool empty() const;
+		std::size_t size() const;
+
+		/// computes world-space transformations from local transformations (forward kinematics).
+		/// All arrays have to contain size() elements; output arrays cannot overlap input arrays.
+		void localToWorld(const Imath::V3f* localTr, const Imath::Quatf* localRot, Imath::V3f* worldTr, Imath::Quatf* worldRot) const;
+		/// computes world-space transformations from local transformations (forward kinematics).
+		/// The world pose has to be allocated and compatible with the local pose.
+		void localToWorld(const Pose& local, Pose& world) const;
+
+		/// computes local (parent-relative) transformations from world-space transformations.
+		/// All arrays have to contain size() elements; output arrays cannot overlap input arrays.
+		void worldToLocal(const Imath::V3f* worldTr, const Imath::Quatf* worldRot, Imath::V3f* localTr, Imath::Quatf* localRot) const;
+		/// computes local (parent-relative) transformations from world-space transformations.
+		/// The local pose has to be allocated and compatible with the world pose (e.g., Skeleton::pose()).
+		void worldToLocal(const Pose& world, Pose& local) const;
+
+	protected:
+	private:
+		// joint indices, sorted by depth in the hierarchy
+		std::vector<int> m_order;
+		// parent index of each joint in m_order (-1 for roots)
+		std::vector<int> m_parents;
+		// boundaries of depth levels in m_order (level n is [m_levels[n], m_levels[n+1]) )
+		std::vector<std::size_t> m_levels;
+};
+
+}
@@ -0,0 +1,474 @@
+#include "Asf.h"
+
+#include <cmath>
+#include <cctype>
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+#include <stdexcept>
+
+#include <strings.h>
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+#include "Reader.h"
+#include "../MappedFile.h"
+#include "../ClipBuilder.h"
+#include "../Instrumentation.h"
+
+namespace openanim {
+
+namespace {
+	// approximate size of the chunks of AMC text parsed in parallel
+	static const std::size_t s_chunkSize = 1 << 18;
+
+	/// rotation around the x (0), y (1) or z (2) axis, in radians
+	Imath::Quatf axisRotation(unsigned axis, float angle) {
+		const float s = std::sin(angle * 0.5f);
+
+		return Imath::Quatf(std::cos(angle * 0.5f),
+			axis == 0 ? s : 0.0f,
+			axis == 1 ? s : 0.0f,
+			axis == 2 ? s : 0.0f);
+	}
+
+	Imath::V3f vector(detail::Reader& reader) {
+		const float x = reader.number();
+		const float y = reader.number();
+		const float z = reader.number();
+
+		return Imath::V3f(x, y, z);
+	}
+
+	/// rotation of an ASF axis or orientation - angles applied in the order of the axis letters
+	Imath::Quatf axisOrientation(detail::Reader& reader, const Imath::V3f& angles, const std::string& order, float toRadians) {
+		if(order.size() != 3)
+			reader.error("invalid axis order '" + order + "'");
+
+		Imath::Quatf result;
+		for(auto& c : order) {
+			const unsigned axis = std::toupper(c) - 'X';
+			if(axis > 2)
+				reader.error("invalid axis order '" + order + "'");
+
+			result = axisRotation(axis, angles[axis] * toRadians) * result;
+		}
+
+		return result;
+	}
+
+	/// returns true if a line (starting at begin) holds only a frame number
+	bool isFrameMarker(const char* begin, const char* end) {
+		while(begin != end && (*begin == ' ' || *begin == '\t'))
+			++begin;
+
+		if(begin == end || *begin < '0' || *begin > '9')
+			return false;
+		while(begin != end && *begin >= '0' && *begin <= '9')
+			++begin;
+
+		while(begin != end && (*begin == ' ' || *begin == '\t' || *begin == '\r'))
+			++begin;
+
+		return begin == end || *begin == '\n';
+	}
+
+	/// finds the beginning of the first frame marker line after position (or end, if none)
+	const char* nextFrame(const char* position, const char* end) {
+		while(position != end) {
+			position = std::find(position, end, '\n');
+			if(position != end)
+				++position;
+
+			if(isFrameMarker(position, end))
+				return position;
+		}
+
+		return end;
+	}
+
+	/// a part of the AMC text and its parsed frames
+	struct Chunk {
+		const char* begin;
+		const char* end;
+		std::size_t line;
+
+		std::size_t firstFrame;
+		std::vector<Imath::V3f> translations;
+		std::vector<Imath::Quatf> rotations;
+	};
+}
+
+Asf::Asf(const std::string& filename) {
+	detail::Reader reader(filename, "ASF");
+	parse(reader);
+}
+
+Asf::Asf(const char* text, std::size_t size) {
+	detail::Reader reader(text, size, "ASF");
+	parse(reader);
+}
+
+const Hierarchy& Asf::hierarchy() const {
+	return *m_hierarchy;
+}
+
+const std::shared_ptr<const Hierarchy>& Asf::sharedHierarchy() const {
+	return m_hierarchy;
+}
+
+const Pose& Asf::bindPose() const {
+	return m_bindPose;
+}
+
+void Asf::parse(detail::Reader& reader) {
+	OPENANIM_TIMER("asf/load");
+
+	/// the geometry of a bone, as in the file
+	struct Geometry {
+		Imath::V3f direction;
+		float length;
+		Imath::V3f axis;
+		std::string order;
+		std::size_t line;
+	};
+
+	auto dof = [&](detail::Reader& line, const std::string& name) {
+		static const char* const s_names[] = {"tx", "ty", "tz", "rx", "ry", "rz", "l"};
+		for(unsigned a = 0; a < 7; ++a)
+			if(strcasecmp(name.c_str(), s_names[a]) == 0)
+				return (Dof)a;
+
+		line.error("unknown dof '" + name + "'");
+	};
+
+	m_degrees = true;
+	m_bones.assign(1, Bone{"root", 0, std::vector<Dof>()});
+
+	std::vector<Geometry> geometry(1, Geometry{Imath::V3f(0, 0, 0), 0.0f, Imath::V3f(0, 0, 0), "XYZ", 0});
+	std::vector<int> parents(1, -1);
+	Imath::V3f position(0, 0, 0);
+
+	bool inBone = false;
+	std::string section;
+
+	// the file is line-based, each line is parsed by its own reader
+	while(!reader.atEnd()) {
+		const std::size_t lineNumber = reader.lineNumber();
+		const std::string text = reader.line();
+		detail::Reader line(text.c_str(), text.size(), "ASF", reader.name(), lineNumber);
+
+		if(text[0] == '#')
+			continue;
+
+		const std::string key = line.word();
+
+		if(key[0] == ':') {
+			if(inBone)
+				line.error("unterminated bone");
+			section = key;
+		}
+
+		else if(section == ":units") {
+			if(key == "angle") {
+				const std::string units = line.word();
+				if(units != "deg" && units != "rad")
+					line.error("unknown angle units '" + units + "'");
+				m_degrees = (units == "deg");
+			}
+		}
+
+		else if(section == ":root") {
+			if(key == "order")
+				while(!line.atEnd())
+					m_bones[0].dofs.push_back(dof(line, line.word()));
+			else if(key == "axis")
+				geometry[0].order = line.word();
+			else if(key == "position")
+				position = vector(line);
+			else if(key == "orientation") {
+				geometry[0].axis = vector(line);
+				geometry[0].line = lineNumber;
+			}
+		}
+
+		else if(section == ":bonedata") {
+			if(key == "begin") {
+				if(inBone)
+					line.error("unterminated bone");
+
+				inBone = true;
+				m_bones.push_back(Bone{"", 0, std::vector<Dof>()});
+				geometry.push_back(Geometry{Imath::V3f(0, 0, 0), 0.0f, Imath::V3f(0, 0, 0), "XYZ", lineNumber});
+				parents.push_back(-1);
+			}
+			else if(!inBone)
+				line.error("'" + key + "' outside of a bone");
+			else if(key == "end") {
+				if(m_bones.back().name.empty())
+					line.error("bone without a name");
+				for(std::size_t b = 0; b + 1 < m_bones.size(); ++b)
+					if(m_bones[b].name == m_bones.back().name)
+						line.error("duplicate bone '" + m_bones.back().name + "'");
+
+				inBone = false;
+			}
+			else if(key == "name")
+				m_bones.back().name = line.word();
+			else if(key == "direction")
+				geometry.back().direction = vector(line);
+			else if(key == "length")
+				geometry.back().length = line.number();
+			else if(key == "axis") {
+				geometry.back().axis = vector(line);
+				geometry.back().order = line.word();
+				geometry.back().line = lineNumber;
+			}
+			else if(key == "dof")
+				while(!line.atEnd())
+					m_bones.back().dofs.push_back(dof(line, line.word()));
+			// id, limits (and their continuation lines) and other fields are not needed
+		}
+
+		else if(section == ":hierarchy") {
+			if(key != "begin" && key != "end") {
+				auto find = [&](const std::string& name) {
+					for(std::size_t b = 0; b < m_bones.size(); ++b)
+						if(m_bones[b].name == name)
+							return (int)b;
+					line.error("unknown bone '" + name + "'");
+				};
+
+				const int parent = find(key);
+				while(!line.atEnd()) {
+					const int child = find(line.word());
+					if(child == 0)
+						line.error("the root can't have a parent");
+					if(parents[child] >= 0)
+						line.error("bone '" + m_bones[child].name + "' has more than one parent");
+					parents[child] = parent;
+				}
+			}
+		}
+
+		// other sections (:version, :name, :documentation) are ignored
+	}
+
+	if(inBone)
+		reader.error("unterminated bone");
+
+	// leaf bones get an extra joint at their tip
+	const std::size_t boneCount = m_bones.size();
+
+	std::vector<std::string> names;
+	std::vector<bool> leaf(boneCount, true);
+	for(std::size_t b = 0; b < boneCount; ++b) {
+		names.push_back(m_bones[b].name);
+		if(b > 0 && parents[b] < 0)
+			reader.error("bone '" + m_bones[b].name + "' is not in the hierarchy");
+		if(parents[b] >= 0)
+			leaf[parents[b]] = false;
+	}
+
+	// every bone has to be connected to the root (a cycle of bones never reaches it)
+	for(std::size_t b = 1; b < boneCount; ++b) {
+		int p = parents[b];
+		for(std::size_t steps = 0; p > 0 && steps < boneCount; ++steps)
+			p = parents[p];
+
+		if(p != 0)
+			reader.error("bone '" + m_bones[b].name + "' is not connected to the root");
+	}
+
+	for(std::size_t b = 1; b < boneCount; ++b)
+		if(leaf[b]) {
+			names.push_back(m_bones[b].name + "_end");
+			parents.push_back(b);
+		}
+
+	std::vector<std::size_t> mapping;
+	m_hierarchy = std::shared_ptr<const Hierarchy>(new Hierarchy(names, parents, &mapping));
+
+	assert(m_hierarchy->size() == names.size());
+	for(std::size_t b = 0; b < boneCount; ++b)
+		m_bones[b].joint = mapping[b];
+
+	// bone frames in world space
+	const float toRadians = m_degrees ? (float)(M_PI / 180.0) : 1.0f;
+
+	std::vector<Imath::Quatf> frames;
+	for(auto& g : geometry) {
+		detail::Reader line(g.order.c_str(), g.order.size(), "ASF", reader.name(), g.line);
+		frames.push_back(axisOrientation(line, g.axis, g.order, toRadians));
+	}
+
+	// the rest pose - each joint in the frame of its bone, starting at the tip of its parent
+	m_bindPose = Pose(m_hierarchy);
+	m_bindPose[m_bones[0].joint] = Transform(frames[0], position);
+	for(std::size_t b = 1; b < boneCount; ++b) {
+		const Geometry& p = geometry[parents[b]];
+		m_bindPose[m_bones[b].joint] = Transform(~frames[parents[b]] * frames[b], (p.direction * p.length) * ~frames[parents[b]]);
+	}
+
+	for(std::size_t j = boneCount; j < names.size(); ++j) {
+		const Geometry& p = geometry[parents[j]];
+		m_bindPose[mapping[j]] = Transform((p.direction * p.length) * ~frames[parents[j]]);
+	}
+}
+
+AnimationClip Asf::loadMotion(const std::string& filename, float fps, float rotationTolerance, float translationTolerance) const {
+	std::size_t size = 0;
+	const std::shared_ptr<const void> storage = detail::mapFile(filename, "AMC", size);
+
+	return parseMotion(static_cast<const char*>(storage.get()), size, filename, fps, rotationTolerance, translationTolerance);
+}
+
+AnimationClip Asf::loadMotion(const char* text, std::size_t size, float fps, float rotationTolerance, float translationTolerance) const {
+	return parseMotion(text, size, "<memory>", fps, rotationTolerance, translationTolerance);
+}
+
+AnimationClip Asf::parseMotion(const char* text, std::size_t size, const std::string& name, float fps, float rotationTolerance, float translationTolerance) const {
+	OPENANIM_TIMER("amc/load");
+
+	assert(fps > 0.0f);
+
+	const char* end = text + size;
+
+	// the header - comments and keywords before the first frame
+	bool degrees = m_degrees;
+
+	const char* position = text;
+	while(true) {
+		while(position != end && std::isspace((unsigned char)*position))
+			++position;
+		if(position == end || (*position != '#' && *position != ':'))
+			break;
+
+		const char* lineEnd = std::find(position, end, '\n');
+		if(lineEnd - position >= 8 && std::strncmp(position, ":RADIANS", 8) == 0)
+			degrees = false;
+		else if(lineEnd - position >= 8 && std::strncmp(position, ":DEGREES", 8) == 0)
+			degrees = true;
+
+		position = lineEnd;
+	}
+
+	// split the rest at frame markers
+	std::vector<Chunk> chunks;
+	while(position != end) {
+		const char* next = position + std::min<std::size_t>(end - position, s_chunkSize);
+		if(next != end)
+			next = nextFrame(next, end);
+
+		chunks.push_back(Chunk{position, next, 0, 0, std::vector<Imath::V3f>(), std::vector<Imath::Quatf>()});
+		position = next;
+	}
+
+	if(chunks.empty())
+		throw std::runtime_error("invalid AMC file '" + name + "' - no frames");
+
+	// line numbers of the chunks, for error messages
+	tbb::parallel_for(tbb::blocked_range<std::size_t>(0, chunks.size(), 1), [&](const tbb::blocked_range<std::size_t>& range) {
+		for(std::size_t c = range.begin(); c != range.end(); ++c)
+			chunks[c].line = std::count(chunks[c].begin, chunks[c].end, '\n');
+	});
+
+	std::size_t line = 1 + std::count(text, chunks[0].begin, '\n');
+	for(auto& c : chunks) {
+		const std::size_t count = c.line;
+		c.line = line;
+		line += count;
+	}
+
+	// parse all chunks in parallel
+	tbb::parallel_for(tbb::blocked_range<std::size_t>(0, chunks.size(), 1), [&](const tbb::blocked_range<std::size_t>& range) {
+		for(std::size_t c = range.begin(); c != range.end(); ++c) {
+			Chunk& chunk = chunks[c];
+
+			detail::Reader reader(chunk.begin, chunk.end - chunk.begin, "AMC", name, chunk.line);
+			parseFrames(reader, degrees, chunk.firstFrame, chunk.translations, chunk.rotations);
+		}
+	});
+
+	// the frames have to be numbered consecutively across the chunks
+	const std::size_t jointCount = m_hierarchy->size();
+
+	ClipBuilder builder(m_hierarchy, fps);
+	for(auto& c : chunks) {
+		if(c.firstFrame != chunks[0].firstFrame + builder.frameCount())
+			throw std::runtime_error("invalid AMC file '" + name + "', line " + std::to_string(c.line) + " - frame " +
+				std::to_string(chunks[0].firstFrame + builder.frameCount()) + " expected");
+
+		for(std::size_t f = 0; f < c.rotations.size() / jointCount; ++f)
+			builder.addFrame(&c.translations[f * jointCount], &c.rotations[f * jointCount]);
+	}
+
+	OPENANIM_COUNT("amc/frames", builder.frameCount());
+
+	return builder.build(rotationTolerance, translationTolerance);
+}
+
+void Asf::parseFrames(detail::Reader& reader, bool degrees, std::size_t& firstFrame, std::vector<Imath::V3f>& translations, std::vector<Imath::Quatf>& rotations) const {
+	const std::size_t jointCount = m_hierarchy->size();
+	const float toRadians = degrees ? (float)(M_PI / 180.0) : 1.0f;
+
+	std::size_t count = 0;
+	// index of the bone expected on the next line - bones usually follow the same order in all frames
+	std::size_t next = 0;
+
+	while(!reader.atEnd()) {
+		const std::size_t frame = reader.integer();
+		if(count == 0)
+			firstFrame = frame;
+		else if(frame != firstFrame + count)
+			reader.error("frame " + std::to_string(firstFrame + count) + " expected");
+		++count;
+
+		// bones missing in a frame keep their rest transformations
+		translations.insert(translations.end(), m_bindPose.translations(), m_bindPose.translations() + jointCount);
+		rotations.insert(rotations.end(), m_bindPose.rotations(), m_bindPose.rotations() + jointCount);
+
+		Imath::V3f* frameTranslations = &translations[translations.size() - jointCount];
+		Imath::Quatf* frameRotations = &rotations[rotations.size() - jointCount];
+
+		// bone lines, up to the next frame marker
+		while(!reader.atEnd() && (reader.peek() < '0' || reader.peek() > '9')) {
+			const std::string name = reader.word();
+
+			if(next >= m_bones.size() || m_bones[next].name != name) {
+				next = 0;
+				while(next < m_bones.size() && m_bones[next].name != name)
+					++next;
+
+				if(next == m_bones.size())
+					reader.error("unknown bone '" + name + "'");
+			}
+
+			const Bone& bone = m_bones[next];
+			++next;
+
+			const Imath::V3f restTranslation = m_bindPose.translations()[bone.joint];
+			const Imath::Quatf restRotation = m_bindPose.rotations()[bone.joint];
+
+			// translation of the root replaces its position
+			const bool root = (&bone == &m_bones[0]);
+			Imath::V3f translation = root ? restTranslation : Imath::V3f(0, 0, 0);
+			Imath::Quatf rotation;
+
+			for(auto& d : bone.dofs) {
+				const float value = reader.number();
+
+				if(d <= TZ)
+					translation[d - TX] = value;
+				else if(d <= RZ)
+					rotation = axisRotation(d - RX, value * toRadians) * rotation;
+			}
+
+			frameRotations[bone.joint] = restRotation * rotation;
+			frameTranslations[bone.joint] = root ? translation : restTranslation + translation * restRotation;
+		}
+	}
+}
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <boost/noncopyable.hpp>
+
+#include "../Transform.h"
+#include "../Hierarchy.h"
+#include "../Pose.h"
+#include "../AnimationClip.h"
+
+namespace openanim {
+
+namespace detail {
+	class Reader;
+}
+
+/// Loader of Acclaim skeleton (ASF) files and their motions (AMC files), as used by the CMU motion
+/// capture database. The root and each bone become joints of a Hierarchy (bones without children get
+/// an extra leaf joint named after the bone with an "_end" suffix, at the bone's tip). The local frame
+/// of each joint is the frame of its bone's axis, which makes the motion of a bone a plain rotation in its
+/// local frame; the bind pose holds the rest transformations (the bone offsets and axis rotations).
+///
+/// Motion values are applied in the order of the bone's dof (or the root's order) - the first rotation
+/// is the innermost one, as are the axis rotations. Translation dofs of the root replace its position,
+/// translation dofs of other bones offset their joint within the bone's frame, and length dofs are
+/// ignored. Lengths and translations stay in the units of the files.
+///
+/// AMC files are memory-mapped and split into chunks at frame markers, which are then parsed in
+/// parallel (using TBB) - the frames are independent of each other.
+class Asf : public boost::noncopyable {
+	public:
+		/// loads an ASF file. Throws std::runtime_error if the file can't be read, or if it isn't a valid
+		/// ASF file.
+		explicit Asf(const std::string& filename);
+		/// parses ASF text in memory
+		Asf(const char* text, std::size_t size);
+
+		const Hierarchy& hierarchy() const;
+		const std::shared_ptr<const Hierarchy>& sharedHierarchy() const;
+
+		/// the rest pose of the skeleton
+		const Pose& bindPose() const;
+
+		/// loads an AMC motion of this skeleton as a clip (AMC files don't store the frame rate - the CMU
+		/// database uses 120 frames per second). The motion is compressed with given tolerances (see
+		/// ClipBuilder::build()). Throws std::runtime_error for files that can't be read or are invalid.
+		AnimationClip loadMotion(const std::string& filename, float fps = 120.0f, float rotationTolerance = 0.0f, float translationTolerance = 0.0f) const;
+		/// loads AMC motion text in memory
+		AnimationClip loadMotion(const char* text, std::size_t size, float fps = 120.0f, float rotationTolerance = 0.0f, float translationTolerance = 0.0f) const;
+
+	protected:
+	private:
+		enum Dof {
+			TX, TY, TZ,
+			RX, RY, RZ,
+			L
+		};
+
+		/// a joint animated by the motion
+		struct Bone {
+			std::string name;
+			// index of the joint in the hierarchy
+			std::size_t joint;
+			std::vector<Dof> dofs;
+		};
+
+		/// parses the ASF file and creates the hierarchy and the bind pose
+		void parse(detail::Reader& reader);
+
+		/// parses an AMC motion from memory
+		AnimationClip parseMotion(const char* text, std::size_t size, const std::string& name, float fps, float rotationTolerance, float translationTolerance) const;
+		/// parses the frames of a chunk of AMC text, appending the local transformations of each frame
+		void parseFrames(detail::Reader& reader, bool degrees, std::size_t& firstFrame, std::vector<Imath::V3f>& translations, std::vector<Imath::Quatf>& rotations) const;
+
+		std::shared_ptr<const Hierarchy> m_hierarchy;
+		Pose m_bindPose;
+
+		// the root first, then all bones in the order of the ASF file
+		std::vector<Bone> m_bones;
+		bool m_degrees;
+};
+
+}
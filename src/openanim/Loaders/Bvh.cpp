@@ -0,0 +1,216 @@
+#include "Bvh.h"
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "Reader.h"
+#include "../ClipBuilder.h"
+#include "../Instrumentation.h"
+
+namespace openanim {
+
+namespace {
+	using detail::Reader;
+
+	enum ChannelType {
+		Xposition,
+		Yposition,
+		Zposition,
+		Xrotation,
+		Yrotation,
+		Zrotation
+	};
+
+	struct Channel {
+		std::size_t joint;
+		ChannelType type;
+	};
+
+	/// the joint table of the HIERARCHY block, in the order of the file
+	struct Joints {
+		std::vector<std::string> names;
+		std::vector<int> parents;
+		std::vector<Imath::V3f> offsets;
+		// set for joints with at least one position channel
+		std::vector<bool> positioned;
+
+		std::vector<Channel> channels;
+	};
+
+	ChannelType channelType(Reader& reader) {
+		static const char* const s_names[] = {"Xposition", "Yposition", "Zposition", "Xrotation", "Yrotation", "Zrotation"};
+
+		const std::string name = reader.word();
+		for(unsigned a = 0; a < 6; ++a)
+			if(name == s_names[a])
+				return (ChannelType)a;
+
+		reader.error("unknown channel '" + name + "'");
+	}
+
+	Imath::V3f offset(Reader& reader) {
+		reader.expect("OFFSET");
+
+		const float x = reader.number();
+		const float y = reader.number();
+		const float z = reader.number();
+
+		return Imath::V3f(x, y, z);
+	}
+
+	std::size_t addJoint(Joints& joints, const std::string& name, int parent, const Imath::V3f& offset) {
+		joints.names.push_back(name);
+		joints.parents.push_back(parent);
+		joints.offsets.push_back(offset);
+		joints.positioned.push_back(false);
+
+		return joints.names.size() - 1;
+	}
+
+	/// parses the block of a joint (after its name) including all its children
+	void parseJoint(Reader& reader, Joints& joints, const std::string& name, int parent) {
+		if(name.empty())
+			reader.error("missing joint name");
+
+		reader.expect("{");
+		const std::size_t index = addJoint(joints, name, parent, offset(reader));
+
+		while(true) {
+			const std::string w = reader.word();
+
+			if(w == "}")
+				break;
+
+			else if(w == "CHANNELS") {
+				const std::size_t count = reader.integer();
+				for(std::size_t c = 0; c < count; ++c) {
+					const ChannelType type = channelType(reader);
+					joints.channels.push_back(Channel{index, type});
+
+					if(type <= Zposition)
+						joints.positioned[index] = true;
+				}
+			}
+
+			else if(w == "JOINT")
+				parseJoint(reader, joints, reader.line(), index);
+
+			else if(w == "End") {
+				reader.expect("Site");
+				reader.expect("{");
+				addJoint(joints, name + "_end", index, offset(reader));
+				reader.expect("}");
+			}
+
+			else
+				reader.error(w.empty() ? "unexpected end of file" : "unexpected '" + w + "'");
+		}
+	}
+
+	Imath::Quatf axisRotation(ChannelType type, float degrees) {
+		const float half = degrees * (float)(M_PI / 360.0);
+		const float s = std::sin(half);
+
+		return Imath::Quatf(std::cos(half),
+			type == Xrotation ? s : 0.0f,
+			type == Yrotation ? s : 0.0f,
+			type == Zrotation ? s : 0.0f);
+	}
+
+	void parse(Reader& reader, float rotationTolerance, float translationTolerance, std::shared_ptr<const Hierarchy>& hierarchy, Pose& bindPose, AnimationClip& clip) {
+		OPENANIM_TIMER("bvh/load");
+
+		// the joint table
+		Joints joints;
+
+		reader.expect("HIERARCHY");
+		reader.expect("ROOT");
+		parseJoint(reader, joints, reader.line(), -1);
+
+		// the hierarchy, and the channels and offsets in its order
+		std::vector<std::size_t> mapping;
+		hierarchy = std::shared_ptr<const Hierarchy>(new Hierarchy(joints.names, joints.parents, &mapping));
+
+		for(auto& c : joints.channels)
+			c.joint = mapping[c.joint];
+
+		bindPose = Pose(hierarchy);
+		for(std::size_t j = 0; j < joints.offsets.size(); ++j)
+			bindPose.translations()[mapping[j]] = joints.offsets[j];
+
+		// frame header
+		reader.expect("MOTION");
+		reader.expect("Frames:");
+		const std::size_t frameCount = reader.integer();
+		reader.expect("Frame");
+		reader.expect("Time:");
+		const float frameTime = reader.number();
+
+		if(frameCount == 0)
+			reader.error("no frames");
+		if(frameTime <= 0.0f)
+			reader.error("invalid frame time");
+
+		// the starting values of each frame - offsets of joints without position channels
+		std::vector<Imath::V3f> initialTranslations(bindPose.translations(), bindPose.translations() + bindPose.size());
+		for(std::size_t j = 0; j < joints.positioned.size(); ++j)
+			if(joints.positioned[j])
+				initialTranslations[mapping[j]] = Imath::V3f(0, 0, 0);
+
+		// stream the frames into the builder
+		ClipBuilder builder(hierarchy, 1.0f / frameTime);
+
+		std::vector<Imath::V3f> translations(hierarchy->size());
+		std::vector<Imath::Quatf> rotations(hierarchy->size());
+
+		for(std::size_t f = 0; f < frameCount; ++f) {
+			std::copy(initialTranslations.begin(), initialTranslations.end(), translations.begin());
+			std::fill(rotations.begin(), rotations.end(), Imath::Quatf());
+
+			for(auto& c : joints.channels) {
+				const float value = reader.number();
+
+				if(c.type <= Zposition)
+					translations[c.joint][c.type - Xposition] = value;
+				else
+					// the first channel is the outermost rotation
+					rotations[c.joint] = rotations[c.joint] * axisRotation(c.type, value);
+			}
+
+			builder.addFrame(translations.data(), rotations.data());
+		}
+
+		OPENANIM_COUNT("bvh/frames", frameCount);
+
+		clip = builder.build(rotationTolerance, translationTolerance);
+	}
+}
+
+Bvh::Bvh(const std::string& filename, float rotationTolerance, float translationTolerance) {
+	Reader reader(filename, "BVH");
+	parse(reader, rotationTolerance, translationTolerance, m_hierarchy, m_bindPose, m_clip);
+}
+
+Bvh::Bvh(const char* text, std::size_t size, float rotationTolerance, float translationTolerance) {
+	Reader reader(text, size, "BVH");
+	parse(reader, rotationTolerance, translationTolerance, m_hierarchy, m_bindPose, m_clip);
+}
+
+const Hierarchy& Bvh::hierarchy() const {
+	return *m_hierarchy;
+}
+
+const std::shared_ptr<const Hierarchy>& Bvh::sharedHierarchy() const {
+	return m_hierarchy;
+}
+
+const Pose& Bvh::bindPose() const {
+	return m_bindPose;
+}
+
+const AnimationClip& Bvh::clip() const {
+	return m_clip;
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <memory>
+
+#include <boost/noncopyable.hpp>
+
+#include "../Hierarchy.h"
+#include "../Pose.h"
+#include "../AnimationClip.h"
+
+namespace openanim {
+
+/// Loader of Biovision Hierarchy (BVH) motion capture files. The HIERARCHY block is parsed into a
+/// Hierarchy (End Sites become leaf joints named after their parent with an "_end" suffix) and a bind
+/// pose holding the joint offsets. The MOTION block is streamed frame by frame straight into a
+/// ClipBuilder, so the file text is never held in memory - files are read in fixed-size chunks, and the
+/// only per-frame storage is the quantized clip data.
+///
+/// The parser is hand-written and does not depend on the current locale. Joints with position channels
+/// use them as their translation (instead of the offset); rotation channels are in degrees, applied in
+/// the order listed in the file (the first channel is the outermost rotation).
+class Bvh : public boost::noncopyable {
+	public:
+		/// loads a BVH file, compressing its motion with given tolerances (see ClipBuilder::build()).
+		/// Throws std::runtime_error if the file can't be read, or if it isn't a valid BVH file.
+		explicit Bvh(const std::string& filename, float rotationTolerance = 0.0f, float translationTolerance = 0.0f);
+		/// parses BVH text in memory
+		Bvh(const char* text, std::size_t size, float rotationTolerance = 0.0f, float translationTolerance = 0.0f);
+
+		const Hierarchy& hierarchy() const;
+		const std::shared_ptr<const Hierarchy>& sharedHierarchy() const;
+
+		/// the joint offsets, with identity rotations
+		const Pose& bindPose() const;
+
+		/// the motion, sampled at 1 / (Frame Time) frames per second
+		const AnimationClip& clip() const;
+
+	protected:
+	private:
+		std::shared_ptr<const Hierarchy> m_hierarchy;
+		Pose m_bindPose;
+		AnimationClip m_clip;
+};
+
+}
@@ -0,0 +1,215 @@
+#include "Reader.h"
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace openanim {
+
+namespace detail {
+
+namespace {
+	// size of a single read from the file
+	static const std::size_t s_chunkSize = 1 << 16;
+	// mantissa digits beyond this value only shift the exponent
+	static const std::uint64_t s_maxMantissa = 100000000000000000ull;
+
+	/// mantissa * 10^exponent, exact for the powers representable in a double
+	double scale(double mantissa, int exponent) {
+		static const double s_powers[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+
+		if(mantissa == 0.0)
+			return 0.0;
+
+		if(exponent >= 0)
+			return exponent <= 22 ? mantissa * s_powers[exponent] : mantissa * std::pow(10.0, exponent);
+		return exponent >= -22 ? mantissa / s_powers[-exponent] : mantissa * std::pow(10.0, exponent);
+	}
+}
+
+Reader::Reader(const std::string& filename, const std::string& format) : m_format(format), m_name(filename),
+	m_file(std::fopen(filename.c_str(), "rb")), m_buffer(s_chunkSize), m_pos(NULL), m_end(NULL), m_line(1) {
+
+	if(m_file == NULL)
+		throw std::runtime_error("cannot open " + format + " file '" + filename + "'");
+}
+
+Reader::Reader(const char* text, std::size_t size, const std::string& format, const std::string& name, std::size_t line) :
+	m_format(format), m_name(name), m_file(NULL), m_pos(text), m_end(text + size), m_line(line) {
+}
+
+Reader::~Reader() {
+	if(m_file != NULL)
+		std::fclose(m_file);
+}
+
+bool Reader::atEnd() {
+	skipWhitespace();
+	return peek() == EOF;
+}
+
+std::string Reader::word() {
+	skipWhitespace();
+
+	std::string result;
+	int c = peek();
+	while(c != EOF && c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+		result.push_back((char)c);
+		++m_pos;
+		c = peek();
+	}
+
+	return result;
+}
+
+void Reader::expect(const char* keyword) {
+	const std::string w = word();
+	if(w != keyword)
+		error(std::string("expected '") + keyword + "', found '" + w + "'");
+}
+
+std::string Reader::line() {
+	int c = peek();
+	while(c == ' ' || c == '\t') {
+		++m_pos;
+		c = peek();
+	}
+
+	std::string result;
+	while(c != EOF && c != '\n' && c != '\r') {
+		result.push_back((char)c);
+		++m_pos;
+		c = peek();
+	}
+
+	while(!result.empty() && (result.back() == ' ' || result.back() == '\t'))
+		result.pop_back();
+
+	return result;
+}
+
+float Reader::number() {
+	skipWhitespace();
+
+	int c = peek();
+	const bool negative = (c == '-');
+	if(c == '-' || c == '+') {
+		++m_pos;
+		c = peek();
+	}
+
+	std::uint64_t mantissa = 0;
+	int exponent = 0;
+	bool digits = false;
+
+	while(c >= '0' && c <= '9') {
+		if(mantissa < s_maxMantissa)
+			mantissa = mantissa * 10 + (c - '0');
+		else
+			++exponent;
+
+		digits = true;
+		++m_pos;
+		c = peek();
+	}
+
+	if(c == '.') {
+		++m_pos;
+		c = peek();
+
+		while(c >= '0' && c <= '9') {
+			if(mantissa < s_maxMantissa) {
+				mantissa = mantissa * 10 + (c - '0');
+				--exponent;
+			}
+
+			digits = true;
+			++m_pos;
+			c = peek();
+		}
+	}
+
+	if(!digits)
+		error("expected a number");
+
+	if(c == 'e' || c == 'E') {
+		++m_pos;
+		c = peek();
+
+		const bool negativeExponent = (c == '-');
+		if(c == '-' || c == '+') {
+			++m_pos;
+			c = peek();
+		}
+
+		if(c < '0' || c > '9')
+			error("invalid number exponent");
+
+		int value = 0;
+		while(c >= '0' && c <= '9') {
+			// way out of the float range already
+			if(value < 1000)
+				value = value * 10 + (c - '0');
+			++m_pos;
+			c = peek();
+		}
+
+		exponent += negativeExponent ? -value : value;
+	}
+
+	const double result = scale((double)mantissa, exponent);
+	return (float)(negative ? -result : result);
+}
+
+std::size_t Reader::integer() {
+	skipWhitespace();
+
+	int c = peek();
+	if(c < '0' || c > '9')
+		error("expected a non-negative integer");
+
+	std::size_t result = 0;
+	while(c >= '0' && c <= '9') {
+		result = result * 10 + (c - '0');
+		++m_pos;
+		c = peek();
+	}
+
+	return result;
+}
+
+std::size_t Reader::lineNumber() const {
+	return m_line;
+}
+
+const std::string& Reader::name() const {
+	return m_name;
+}
+
+void Reader::error(const std::string& message) const {
+	throw std::runtime_error("invalid " + m_format + " file '" + m_name + "', line " + std::to_string(m_line) + " - " + message);
+}
+
+bool Reader::refill() {
+	if(m_file == NULL)
+		return false;
+
+	const std::size_t count = std::fread(m_buffer.data(), 1, m_buffer.size(), m_file);
+	if(count == 0) {
+		if(std::ferror(m_file))
+			error("read error");
+		return false;
+	}
+
+	m_pos = m_buffer.data();
+	m_end = m_pos + count;
+
+	return true;
+}
+
+}
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#include <boost/noncopyable.hpp>
+
+namespace openanim {
+
+namespace detail {
+
+/// Sequential tokenizer of the text file loaders, reading either a file in fixed-size chunks (the
+/// whole file is never held in memory), or a block of memory. Numbers are parsed by hand, without
+/// iostream and independently of the current locale. Invalid input is reported by std::runtime_error
+/// exceptions holding the format, the name of the input and the line number.
+class Reader : public boost::noncopyable {
+	public:
+		/// opens a file; format is the name of the file format used in error messages (e.g., "BVH")
+		Reader(const std::string& filename, const std::string& format);
+		/// reads a block of memory, with the first line numbered line (for error messages)
+		Reader(const char* text, std::size_t size, const std::string& format, const std::string& name = "<memory>", std::size_t line = 1);
+
+		~Reader();
+
+		/// the next character, or EOF at the end of the input
+		int peek();
+		void skipWhitespace();
+		/// skips whitespace, and returns true if there is nothing else left
+		bool atEnd();
+
+		/// reads a whitespace-delimited token
+		std::string word();
+		/// reads a token, and throws if it isn't the keyword
+		void expect(const char* keyword);
+		/// reads the rest of the current line, without the leading and trailing whitespace
+		std::string line();
+
+		/// parses a decimal number (with an optional sign, fraction and exponent)
+		float number();
+		/// parses a non-negative integer
+		std::size_t integer();
+
+		/// the current line number
+		std::size_t lineNumber() const;
+		/// name of the input (the filename)
+		const std::string& name() const;
+
+		/// throws a std::runtime_error with the current position
+		[[noreturn]] void error(const std::string& message) const;
+
+	protected:
+	private:
+		/// reads the next chunk of the file, returning false at the end of the input
+		bool refill();
+
+		std::string m_format, m_name;
+		std::FILE* m_file;
+
+		std::vector<char> m_buffer;
+		const char* m_pos;
+		const char* m_end;
+
+		std::size_t m_line;
+};
+
+////
+
+inline int Reader::peek() {
+	if(m_pos == m_end && !refill())
+		return EOF;
+	return (unsigned char)*m_pos;
+}
+
+inline void Reader::skipWhitespace() {
+	int c = peek();
+	while(c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+		if(c == '\n')
+			++m_line;
+		++m_pos;
+		c = peek();
+	}
+}
+
+}
+
+}
@@ -0,0 +1,38 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace openanim {
+
+namespace detail {
+
+std::shared_ptr<const void> mapFile(const std::string& filename, const std::string& kind, std::size_t& size) {
+	const int file = ::open(filename.c_str(), O_RDONLY);
+	if(file < 0)
+		throw std::runtime_error("cannot open " + kind + " file '" + filename + "'");
+
+	struct stat info;
+	if(::fstat(file, &info) != 0 || info.st_size == 0) {
+		::close(file);
+		throw std::runtime_error("cannot read " + kind + " file '" + filename + "'");
+	}
+
+	const std::size_t length = info.st_size;
+	void* data = ::mmap(NULL, length, PROT_READ, MAP_PRIVATE, file, 0);
+	::close(file);
+
+	if(data == MAP_FAILED)
+		throw std::runtime_error("cannot map " + kind + " file '" + filename + "'");
+
+	size = length;
+	return std::shared_ptr<const void>(data, [length](void* ptr) { ::munmap(ptr, length); });
+}
+
+}
+
+}
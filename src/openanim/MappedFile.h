@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+#include <memory>
+
+namespace openanim {
+
+namespace detail {
+
+/// maps a whole file into memory (read-only), unmapping it when the last copy of the returned pointer
+/// is released. Throws std::runtime_error if the file is empty, or can't be opened or mapped; kind
+/// describes the file in the error messages (e.g., "asset").
+std::shared_ptr<const void> mapFile(const std::string& filename, const std::string& kind, std::size_t& size);
+
+}
+
+}
@@ -0,0 +1,122 @@
+#include "Palette.h"
+
+#include <cassert>
+
+#include "Simd.h"
+#include "Instrumentation.h"
+
+namespace openanim {
+
+namespace {
+	/// skinning transformations of F::width joints starting at index i
+	template<typename F>
+	void skinning(const Pose& inverseBind, const Pose& world, std::size_t i, simd::Transforms<F>& result) {
+		simd::Transforms<F> bind, current;
+		simd::load(bind, inverseBind.translations() + i, inverseBind.rotations() + i);
+		simd::load(current, world.translations() + i, world.rotations() + i);
+
+		simd::multiply(bind, current, result);
+	}
+
+	template<typename F>
+	void matrices(const Pose& inverseBind, const Pose& world, std::size_t i, float* target) {
+		simd::Transforms<F> s;
+		skinning(inverseBind, world, i, s);
+
+		const F one = F::set1(1.0f);
+		const F two = F::set1(2.0f);
+
+		const F xx = s.qx * s.qx, yy = s.qy * s.qy, zz = s.qz * s.qz;
+		const F xy = s.qx * s.qy, yz = s.qy * s.qz, zx = s.qz * s.qx;
+		const F xr = s.qx * s.qr, yr = s.qy * s.qr, zr = s.qz * s.qr;
+
+		// rows of the transposed rotation matrix (see Imath::Quat::toMatrix44()), with the translation
+		alignas(32) float data[Palette::s_matrixSize][F::width];
+		(one - two * (yy + zz)).store(data[0]);
+		(two * (xy - zr)).store(data[1]);
+		(two * (zx + yr)).store(data[2]);
+		s.tx.store(data[3]);
+
+		(two * (xy + zr)).store(data[4]);
+		(one - two * (zz + xx)).store(data[5]);
+		(two * (yz - xr)).store(data[6]);
+		s.ty.store(data[7]);
+
+		(two * (zx - yr)).store(data[8]);
+		(two * (yz + xr)).store(data[9]);
+		(one - two * (yy + xx)).store(data[10]);
+		s.tz.store(data[11]);
+
+		for(unsigned l = 0; l < F::width; ++l)
+			for(unsigned e = 0; e < Palette::s_matrixSize; ++e)
+				target[l * Palette::s_matrixSize + e] = data[e][l];
+	}
+
+	template<typename F>
+	void dualQuaternions(const Pose& inverseBind, const Pose& world, std::size_t i, float* target) {
+		simd::Transforms<F> s;
+		skinning(inverseBind, world, i, s);
+
+		// dual part = 0.5 * translation * rotation
+		const F half = F::set1(0.5f);
+		const F tx = s.tx * half, ty = s.ty * half, tz = s.tz * half;
+
+		alignas(32) float data[Palette::s_dualQuaternionSize][F::width];
+		s.qx.store(data[0]);
+		s.qy.store(data[1]);
+		s.qz.store(data[2]);
+		s.qr.store(data[3]);
+
+		(tx * s.qr + ty * s.qz - tz * s.qy).store(data[4]);
+		(ty * s.qr + tz * s.qx - tx * s.qz).store(data[5]);
+		(tz * s.qr + tx * s.qy - ty * s.qx).store(data[6]);
+		(-(tx * s.qx + ty * s.qy + tz * s.qz)).store(data[7]);
+
+		for(unsigned l = 0; l < F::width; ++l)
+			for(unsigned e = 0; e < Palette::s_dualQuaternionSize; ++e)
+				target[l * Palette::s_dualQuaternionSize + e] = data[e][l];
+	}
+}
+
+Palette::Palette(const Pose& bindPose) : m_inverseBind(bindPose.sharedHierarchy()) {
+	for(std::size_t i = 0; i < bindPose.size(); ++i)
+		m_inverseBind[i] = bindPose[i].inverse();
+}
+
+const Hierarchy& Palette::hierarchy() const {
+	return m_inverseBind.hierarchy();
+}
+
+std::size_t Palette::size() const {
+	return m_inverseBind.size();
+}
+
+const Pose& Palette::inverseBindPose() const {
+	return m_inverseBind;
+}
+
+void Palette::writeMatrices(const Pose& worldPose, float* target) const {
+	OPENANIM_TIMER("palette/matrices");
+
+	assert(worldPose.isCompatibleWith(m_inverseBind));
+
+	std::size_t i = 0;
+	for(; i + simd::native::width <= size(); i += simd::native::width)
+		matrices<simd::native>(m_inverseBind, worldPose, i, target + i * s_matrixSize);
+	for(; i < size(); ++i)
+		matrices<simd::float1>(m_inverseBind, worldPose, i, target + i * s_matrixSize);
+}
+
+void Palette::writeDualQuaternions(const Pose& worldPose, float* target) const {
+	OPENANIM_TIMER("palette/dual_quaternions");
+
+	assert(worldPose.isCompatibleWith(m_inverseBind));
+
+	std::size_t i = 0;
+	for(; i + simd::native::width <= size(); i += simd::native::width)
+		dualQuaternions<simd::native>(m_inverseBind, worldPose, i, target + i * s_dualQuaternionSize);
+	for(; i < size(); ++i)
+		dualQuaternions<simd::float1>(m_inverseBind, worldPose, i, target + i * s_dualQuaternionSize);
+}
+
+}
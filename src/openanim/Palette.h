@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+
+#include "Pose.h"
+
+namespace openanim {
+
+/// Palette generates skinning transformations - world-space joint transformations composed with the
+/// inverse of the world-space bind pose - directly into caller-provided buffers, in SIMD batches and
+/// without any intermediate matrix objects or allocations. The inverse bind pose is computed once, and
+/// the palette can be used with any world-space pose compatible with the bind pose.
+class Palette {
+	public:
+		/// number of floats written per joint by writeMatrices()
+		static const std::size_t s_matrixSize = 12;
+		/// number of floats written per joint by writeDualQuaternions()
+		static const std::size_t s_dualQuaternionSize = 8;
+
+		/// creates a palette from a world-space bind pose
+		explicit Palette(const Pose& bindPose);
+
+		const Hierarchy& hierarchy() const;
+		std::size_t size() const;
+
+		/// the stored inverse bind pose
+		const Pose& inverseBindPose() const;
+
+		/// writes size() 3x4 row-major skinning matrices (s_matrixSize floats per joint) in the column
+		/// vector convention, i.e., the transpose of the upper 4x3 part of the equivalent Imath::M44f.
+		void writeMatrices(const Pose& worldPose, float* target) const;
+
+		/// writes size() skinning dual quaternions (s_dualQuaternionSize floats per joint) - the real
+		/// part followed by the dual part, both in x, y, z, w order (w being the scalar component)
+		void writeDualQuaternions(const Pose& worldPose, float* target) const;
+
+	protected:
+	private:
+		Pose m_inverseBind;
+};
+
+}
@@ -0,0 +1,115 @@
+#include "Pose.h"
+
+#include <cassert>
+
+namespace openanim {
+
+Pose::Pose() : m_hierarchy(new Hierarchy()) {
+}
+
+Pose::Pose(const std::shared_ptr<const Hierarchy>& h) : m_hierarchy(h), m_translations(h->size(), Imath::V3f(0,0,0)), m_rotations(h->size()) {
+	assert(m_hierarchy != NULL);
+}
+
+// copy construction allocates on the heap (see ArenaAllocator), and assignment keeps the allocator of the target
+
+Pose::Pose(const Pose& p) : m_hierarchy(p.m_hierarchy), m_translations(p.m_translations), m_rotations(p.m_rotations) {
+}
+
+Pose& Pose::operator = (const Pose& p) {
+	m_hierarchy = p.m_hierarchy;
+	m_translations = p.m_translations;
+	m_rotations = p.m_rotations;
+
+	return *this;
+}
+
+Pose::Pose(Pose&& p) : m_hierarchy(std::move(p.m_hierarchy)),
+	m_translations(p.m_translations.get_allocator().arena() == NULL ? std::move(p.m_translations) : Translations(p.m_translations)),
+	m_rotations(p.m_rotations.get_allocator().arena() == NULL ? std::move(p.m_rotations) : Rotations(p.m_rotations)) {
+}
+
+Pose& Pose::operator = (Pose&& p) {
+	m_hierarchy = std::move(p.m_hierarchy);
+	m_translations = std::move(p.m_translations);
+	m_rotations = std::move(p.m_rotations);
+
+	return *this;
+}
+
+Pose::Pose(const Pose& source, const std::shared_ptr<const Hierarchy>& h, const std::vector<std::size_t>& mapping) : m_hierarchy(h), m_translations(h->size()), m_rotations(h->size()) {
+	assert(m_hierarchy != NULL);
+	assert(source.size() == h->size());
+	assert(mapping.size() == source.size());
+
+	for(std::size_t i = 0; i < source.size(); ++i) {
+		assert(mapping[i] < h->size());
+
+		m_translations[mapping[i]] = source.m_translations[i];
+		m_rotations[mapping[i]] = source.m_rotations[i];
+	}
+}
+
+Pose::Pose(const std::shared_ptr<const Hierarchy>& h, PoseArena& arena) : m_hierarchy(h),
+	m_translations(h->size(), Imath::V3f(0,0,0), ArenaAllocator<Imath::V3f>(arena)), m_rotations(h->size(), Imath::Quatf(), ArenaAllocator<Imath::Quatf>(arena)) {
+
+	assert(m_hierarchy != NULL);
+}
+
+Pose::Pose(const Pose& source, PoseArena& arena) : m_hierarchy(source.m_hierarchy),
+	m_translations(source.m_translations.begin(), source.m_translations.end(), ArenaAllocator<Imath::V3f>(arena)),
+	m_rotations(source.m_rotations.begin(), source.m_rotations.end(), ArenaAllocator<Imath::Quatf>(arena)) {
+}
+
+const Hierarchy& Pose::hierarchy() const {
+	return *m_hierarchy;
+}
+
+const std::shared_ptr<const Hierarchy>& Pose::sharedHierarchy() const {
+	return m_hierarchy;
+}
+
+bool Pose::empty() const {
+	return m_translations.empty();
+}
+
+std::size_t Pose::size() const {
+	assert(m_translations.size() == m_rotations.size());
+	return m_translations.size();
+}
+
+TransformRef Pose::operator[](std::size_t index) {
+	assert(index < size());
+	return TransformRef(m_translations[index], m_rotations[index]);
+}
+
+const Transform Pose::operator[](std::size_t index) const {
+	assert(index < size());
+	return Transform(m_rotations[index], m_translations[index]);
+}
+
+Imath::V3f* Pose::translations() {
+	return m_translations.data();
+}
+
+const Imath::V3f* Pose::translations() const {
+	return m_translations.data();
+}
+
+Imath::Quatf* Pose::rotations() {
+	return m_rotations.data();
+}
+
+const Imath::Quatf* Pose::rotations() const {
+	return m_rotations.data();
+}
+
+bool Pose::isCompatibleWith(const Pose& p) const {
+	return m_hierarchy == p.m_hierarchy;
+}
+
+PoseArena* Pose::arena() const {
+	return m_translations.get_allocator().arena();
+}
+
+}
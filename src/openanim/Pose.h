@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include <boost/serialization/access.hpp>
+
+#include <ImathVec.h>
+#include <ImathQuat.h>
+
+#include "Hierarchy.h"
+#include "Transform.h"
+#include "PoseArena.h"
+
+namespace openanim {
+
+/// Pose holds the transformations of all joints of a Hierarchy, stored as a structure of arrays -
+/// translations and rotations live in two separate contiguous aligned arrays, indexed by the flat
+/// joint index of the Hierarchy. The hierarchy instance is shared between all compatible poses.
+/// Transient poses can allocate their arrays from a PoseArena. Copies of such poses (copy
+/// construction) are always allocated on the heap, and so is the result of move construction from
+/// an arena pose - the data is copied instead of moved, so that no arena storage can be carried into a
+/// long-lived pose. Assignment (both copy and move) keeps the target's storage.
+class Pose {
+	public:
+		typedef std::vector<Imath::V3f, ArenaAllocator<Imath::V3f>> Translations;
+		typedef std::vector<Imath::Quatf, ArenaAllocator<Imath::Quatf>> Rotations;
+
+		/// creates an empty pose of an empty hierarchy
+		Pose();
+		/// creates an identity pose of the hierarchy h
+		explicit Pose(const std::shared_ptr<const Hierarchy>& h);
+		Pose(const Pose& p);
+		Pose& operator = (const Pose& p);
+		/// moves the data of a heap-allocated pose, or copies an arena pose to the heap
+		Pose(Pose&& p);
+		Pose& operator = (Pose&& p);
+
+		/// creates a pose of the hierarchy h from a pose of the same joints in a different layout, with
+		/// mapping containing the index in h of each joint of the source (see Hierarchy's layout conversion)
+		Pose(const Pose& source, const std::shared_ptr<const Hierarchy>& h, const std::vector<std::size_t>& mapping);
+
+		/// creates an identity pose of the hierarchy h, allocated from an arena
+		Pose(const std::shared_ptr<const Hierarchy>& h, PoseArena& arena);
+		/// creates a copy of a pose, allocated from an arena
+		Pose(const Pose& source, PoseArena& arena);
+
+		const Hierarchy& hierarchy() const;
+		const std::shared_ptr<const Hierarchy>& sharedHierarchy() const;
+
+		bool empty() const;
+		std::size_t size() const;
+
+		TransformRef operator[](std::size_t index);
+		const Transform operator[](std::size_t index) const;
+
+		/// contiguous arrays of joint translations and rotations (size() elements each)
+		Imath::V3f* translations();
+		const Imath::V3f* translations() const;
+		Imath::Quatf* rotations();
+		const Imath::Quatf* rotations() const;
+
+		/// returns true if these two poses can be directly assigned (if they share the same hierarchy instance)
+		bool isCompatibleWith(const Pose& p) const;
+
+		/// the arena holding the data of this pose (NULL if allocated on the heap)
+		PoseArena* arena() const;
+
+	protected:
+	private:
+		/// serializes the hierarchy by pointer (keeping it shared) and both arrays in bulk (see Serialization.h)
+		template<typename ARCHIVE>
+		void serialize(ARCHIVE& ar, const unsigned int version);
+
+		std::shared_ptr<const Hierarchy> m_hierarchy;
+
+		Translations m_translations;
+		Rotations m_rotations;
+
+	friend class Skeleton;
+	friend class boost::serialization::access;
+};
+
+}
@@ -0,0 +1,87 @@
+#include "PoseArena.h"
+
+#include <cassert>
+#include <algorithm>
+
+#include "Instrumentation.h"
+
+namespace openanim {
+
+PoseArena::PoseArena(std::size_t blockSize) : m_blockSize(blockSize), m_current(0), m_offset(0), m_used(0), m_live(0) {
+	assert(blockSize > 0);
+}
+
+PoseArena::~PoseArena() {
+	assert(m_live == 0 && "all poses allocated from an arena have to be destroyed before the arena");
+
+	for(auto& b : m_blocks)
+		AlignedAllocator<char, s_alignment>().deallocate(b.data, b.size);
+}
+
+void* PoseArena::allocate(std::size_t size) {
+	// keeps all allocations aligned
+	size = (size + s_alignment - 1) & ~(s_alignment - 1);
+
+	// the first block with enough space, starting with the current one; skipped space is reclaimed on reset
+	while(m_current < m_blocks.size() && m_offset + size > m_blocks[m_current].size) {
+		++m_current;
+		m_offset = 0;
+	}
+
+	if(m_current == m_blocks.size()) {
+		OPENANIM_COUNT("pose_arena/block", 1);
+
+		Block b;
+		b.size = std::max(size, m_blockSize);
+		b.data = AlignedAllocator<char, s_alignment>().allocate(b.size);
+		m_blocks.push_back(b);
+	}
+
+	char* result = m_blocks[m_current].data + m_offset;
+	m_offset += size;
+
+	m_used += size;
+	++m_live;
+
+	return result;
+}
+
+void PoseArena::deallocate(void* ptr, std::size_t size) {
+	if(ptr == NULL)
+		return;
+
+	assert(m_live > 0);
+	--m_live;
+
+	// the last allocation can be returned to the arena right away
+	size = (size + s_alignment - 1) & ~(s_alignment - 1);
+	if(m_current < m_blocks.size() && static_cast<char*>(ptr) + size == m_blocks[m_current].data + m_offset) {
+		m_offset -= size;
+		m_used -= size;
+	}
+}
+
+void PoseArena::reset() {
+	assert(m_live == 0 && "all poses allocated from an arena have to be destroyed before a reset");
+
+	m_current = 0;
+	m_offset = 0;
+	m_used = 0;
+}
+
+std::size_t PoseArena::live() const {
+	return m_live;
+}
+
+std::size_t PoseArena::used() const {
+	return m_used;
+}
+
+std::size_t PoseArena::capacity() const {
+	std::size_t result = 0;
+	for(auto& b : m_blocks)
+		result += b.size;
+	return result;
+}
+
+}
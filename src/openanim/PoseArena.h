@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <type_traits>
+
+#include <boost/noncopyable.hpp>
+
+#include "AlignedAllocator.h"
+
+namespace openanim {
+
+/// PoseArena is a linear (bump) allocator of scratch pose buffers, intended for transient poses of
+/// an evaluation (sampling, blending and kinematics intermediates). Memory is taken from large aligned
+/// blocks, which are kept and reused after reset() - once the arena has grown to the size of a frame's
+/// temporaries, their allocation costs just a pointer increment and no heap access.
+/// Poses are created in an arena using Pose's arena constructors, and all poses allocated from an arena
+/// have to be destroyed before it is reset. An arena is not thread-safe - use one arena per thread.
+class PoseArena : public boost::noncopyable {
+	public:
+		/// alignment of all allocations (matching AlignedAllocator's default)
+		static const std::size_t s_alignment = 32;
+
+		explicit PoseArena(std::size_t blockSize = 64 * 1024);
+		~PoseArena();
+
+		/// allocates an aligned buffer of at least size bytes
+		void* allocate(std::size_t size);
+		/// releases a buffer. The memory is reused only if it was the last allocation, otherwise
+		/// it stays allocated until reset().
+		void deallocate(void* ptr, std::size_t size);
+
+		/// makes the whole arena available for new allocations, in constant time (all allocations
+		/// have to be released before a reset)
+		void reset();
+
+		/// number of allocations not yet released
+		std::size_t live() const;
+		/// bytes allocated since the last reset
+		std::size_t used() const;
+		/// total size of all blocks held by the arena
+		std::size_t capacity() const;
+
+	protected:
+	private:
+		struct Block {
+			char* data;
+			std::size_t size;
+		};
+
+		std::vector<Block> m_blocks;
+		std::size_t m_blockSize;
+
+		// current block, and the offset of the first free byte in it
+		std::size_t m_current;
+		std::size_t m_offset;
+
+		std::size_t m_used, m_live;
+};
+
+/// an aligned allocator optionally allocating from a PoseArena. A default-constructed allocator
+/// falls back to AlignedAllocator; copies of containers (copy construction) always use the heap,
+/// so that a copy of a transient pose can safely outlive its arena. The allocator never propagates
+/// on assignment or swap - an assigned container keeps its storage (containers of different arenas
+/// cannot be swapped).
+template<typename T>
+class ArenaAllocator {
+	public:
+		typedef T value_type;
+		typedef T* pointer;
+		typedef const T* const_pointer;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef std::size_t size_type;
+		typedef std::ptrdiff_t difference_type;
+
+		template<typename U>
+		struct rebind {
+			typedef ArenaAllocator<U> other;
+		};
+
+		typedef std::false_type propagate_on_container_copy_assignment;
+		typedef std::false_type propagate_on_container_move_assignment;
+		typedef std::false_type propagate_on_container_swap;
+
+		ArenaAllocator();
+		explicit ArenaAllocator(PoseArena& arena);
+		template<typename U>
+		ArenaAllocator(const ArenaAllocator<U>& a);
+
+		T* allocate(std::size_t n);
+		void deallocate(T* ptr, std::size_t n);
+
+		/// the arena used (NULL for heap allocations)
+		PoseArena* arena() const;
+
+		ArenaAllocator select_on_container_copy_construction() const;
+
+		bool operator == (const ArenaAllocator& a) const;
+		bool operator != (const ArenaAllocator& a) const;
+
+	protected:
+	private:
+		PoseArena* m_arena;
+};
+
+////
+
+template<typename T>
+ArenaAllocator<T>::ArenaAllocator() : m_arena(NULL) {
+}
+
+template<typename T>
+ArenaAllocator<T>::ArenaAllocator(PoseArena& arena) : m_arena(&arena) {
+}
+
+template<typename T>
+template<typename U>
+ArenaAllocator<T>::ArenaAllocator(const ArenaAllocator<U>& a) : m_arena(a.arena()) {
+}
+
+template<typename T>
+T* ArenaAllocator<T>::allocate(std::size_t n) {
+	if(m_arena == NULL)
+		return AlignedAllocator<T, PoseArena::s_alignment>().allocate(n);
+	return static_cast<T*>(m_arena->allocate(n * sizeof(T)));
+}
+
+template<typename T>
+void ArenaAllocator<T>::deallocate(T* ptr, std::size_t n) {
+	if(m_arena == NULL)
+		AlignedAllocator<T, PoseArena::s_alignment>().deallocate(ptr, n);
+	else
+		m_arena->deallocate(ptr, n * sizeof(T));
+}
+
+template<typename T>
+PoseArena* ArenaAllocator<T>::arena() const {
+	return m_arena;
+}
+
+template<typename T>
+ArenaAllocator<T> ArenaAllocator<T>::select_on_container_copy_construction() const {
+	return ArenaAllocator();
+}
+
+template<typename T>
+bool ArenaAllocator<T>::operator == (const ArenaAllocator& a) const {
+	return m_arena == a.m_arena;
+}
+
+template<typename T>
+bool ArenaAllocator<T>::operator != (const ArenaAllocator& a) const {
+	return m_arena != a.m_arena;
+}
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include <ImathVec.h>
+#include <ImathQuat.h>
+
+namespace openanim {
+
+/// Helper functions for lossy encoding of animation data.
+namespace quantization {
+
+/// encodes a value in the [0..1] range as a 16-bit integer
+std::uint16_t encodeUnit(float value);
+/// decodes a value encoded using encodeUnit()
+float decodeUnit(std::uint16_t value);
+
+/// encodes a normalized quaternion in 48 bits using the "smallest three" method - the largest
+/// component is dropped (and reconstructed from the unit length constraint during decoding), and
+/// the other three are stored with 15 bits of precision, together with the 2-bit index of the dropped one.
+void encodeRotation(const Imath::Quatf& q, std::uint16_t* result);
+/// decodes a quaternion encoded using encodeRotation()
+Imath::Quatf decodeRotation(const std::uint16_t* data);
+
+/// normalized linear interpolation of two quaternions, taking the shorter path
+Imath::Quatf nlerp(const Imath::Quatf& q1, Imath::Quatf q2, float weight);
+
+////
+
+// the three smallest components of a unit quaternion are in the [-1/sqrt(2) .. 1/sqrt(2)] range
+static const float s_smallestRange = 0.70710678f;
+
+inline std::uint16_t encodeUnit(float value) {
+	return (std::uint16_t)(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f + 0.5f);
+}
+
+inline float decodeUnit(std::uint16_t value) {
+	return (float)value / 65535.0f;
+}
+
+inline void encodeRotation(const Imath::Quatf& q, std::uint16_t* result) {
+	const float components[4] = {q.r, q.v.x, q.v.y, q.v.z};
+
+	unsigned largest = 0;
+	for(unsigned a = 1; a < 4; ++a)
+		if(std::abs(components[a]) > std::abs(components[largest]))
+			largest = a;
+
+	// q and -q represent the same rotation - flip the sign to make the dropped component positive
+	const float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+	std::uint16_t values[3];
+	unsigned i = 0;
+	for(unsigned a = 0; a < 4; ++a)
+		if(a != largest) {
+			const float value = (components[a] * sign / s_smallestRange) * 0.5f + 0.5f;
+			values[i++] = (std::uint16_t)(std::min(std::max(value, 0.0f), 1.0f) * 32766.0f + 0.5f);
+		}
+
+	// the index of the largest component is stored in the top bits of the first two values
+	result[0] = values[0] | ((largest >> 1) << 15);
+	result[1] = values[1] | ((largest & 1) << 15);
+	result[2] = values[2];
+}
+
+inline Imath::Quatf decodeRotation(const std::uint16_t* data) {
+	const unsigned largest = ((data[0] >> 15) << 1) | (data[1] >> 15);
+
+	float values[3];
+	float sum = 0.0f;
+	for(unsigned a = 0; a < 3; ++a) {
+		values[a] = ((float)(data[a] & 0x7fff) / 32766.0f * 2.0f - 1.0f) * s_smallestRange;
+		sum += values[a] * values[a];
+	}
+
+	float components[4];
+	unsigned i = 0;
+	for(unsigned a = 0; a < 4; ++a)
+		components[a] = (a == largest) ? std::sqrt(std::max(1.0f - sum, 0.0f)) : values[i++];
+
+	return Imath::Quatf(components[0], components[1], components[2], components[3]);
+}
+
+inline Imath::Quatf nlerp(const Imath::Quatf& q1, Imath::Quatf q2, float weight) {
+	if((q1 ^ q2) < 0.0f)
+		q2 = -q2;
+
+	Imath::Quatf result(
+		q1.r + (q2.r - q1.r) * weight,
+		q1.v + (q2.v - q1.v) * weight
+	);
+
+	return result.normalize();
+}
+
+}
+
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <memory>
+#include <cstdint>
+
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/array.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/is_bitwise_serializable.hpp>
+
+#include "Transform.h"
+#include "Hierarchy.h"
+#include "Pose.h"
+#include "Skeleton.h"
+#include "AnimationClip.h"
+#include "HalfPose.h"
+#include "Array.h"
+
+/// Boost.Serialization support of the library types. Include this header in the translation units
+/// using the archives.
+///
+/// All contiguous data (joint transformations, hierarchy items, clip tracks and keys) are serialized as
+/// arrays, which binary archives read and write as single blocks. Hierarchies are always serialized
+/// through their shared pointers, so that all poses, skeletons and clips sharing one Hierarchy instance
+/// share one instance again after loading (within a single archive).
+
+BOOST_IS_BITWISE_SERIALIZABLE(openanim::Transform)
+BOOST_IS_BITWISE_SERIALIZABLE(openanim::Hierarchy::Item)
+BOOST_IS_BITWISE_SERIALIZABLE(openanim::AnimationClip::Track)
+
+namespace boost {
+
+namespace serialization {
+
+template<typename ARCHIVE>
+void serialize(ARCHIVE& ar, openanim::Transform& tr, const unsigned int version) {
+	ar & make_array(&tr.translation.x, 3);
+	ar & make_array(&tr.rotation.r, 1);
+	ar & make_array(&tr.rotation.v.x, 3);
+}
+
+template<typename ARCHIVE>
+void serialize(ARCHIVE& ar, openanim::Hierarchy::Item& item, const unsigned int version) {
+	ar & item.name_offset;
+	ar & item.parent;
+	ar & item.children_begin;
+	ar & item.children_end;
+}
+
+template<typename ARCHIVE>
+void serialize(ARCHIVE& ar, openanim::AnimationClip::Track& track, const unsigned int version) {
+	ar & track.encoding;
+	ar & track.keys_begin;
+	ar & track.keys_end;
+	ar & track.offset;
+	ar & track.scale;
+}
+
+template<typename ARCHIVE, typename T>
+void serialize(ARCHIVE& ar, openanim::Array<T>& a, const unsigned int version) {
+	std::size_t size = a.size();
+	ar & size;
+
+	// loading always creates an owning array
+	if(ARCHIVE::is_loading::value) {
+		a = openanim::Array<T>();
+		a.resize(size);
+	}
+
+	if(size > 0)
+		ar & make_array(ARCHIVE::is_loading::value ? &a[0] : const_cast<T*>(a.data()), size);
+}
+
+}
+
+}
+
+namespace openanim {
+
+namespace detail {
+	/// serializes a shared hierarchy pointer (archives can only track pointers to non-const types)
+	template<typename ARCHIVE>
+	void serializeHierarchy(ARCHIVE& ar, std::shared_ptr<const Hierarchy>& hierarchy) {
+		std::shared_ptr<Hierarchy> h = std::const_pointer_cast<Hierarchy>(hierarchy);
+		ar & h;
+		hierarchy = h;
+	}
+}
+
+template<typename ARCHIVE>
+void Hierarchy::serialize(ARCHIVE& ar, const unsigned int version) {
+	int layout = m_layout;
+	ar & layout;
+	m_layout = (Layout)layout;
+
+	ar & m_items;
+	ar & m_names;
+
+	if(ARCHIVE::is_loading::value)
+		reindex();
+}
+
+template<typename ARCHIVE>
+void Pose::serialize(ARCHIVE& ar, const unsigned int version) {
+	detail::serializeHierarchy(ar, m_hierarchy);
+
+	std::size_t count = size();
+	ar & count;
+
+	if(ARCHIVE::is_loading::value) {
+		m_translations.resize(count);
+		m_rotations.resize(count);
+	}
+
+	// both arrays as plain floats, in bulk
+	ar & boost::serialization::make_array(reinterpret_cast<float*>(m_translations.data()), count * 3);
+	ar & boost::serialization::make_array(reinterpret_cast<float*>(m_rotations.data()), count * 4);
+}
+
+template<typename ARCHIVE>
+void Skeleton::serialize(ARCHIVE& ar, const unsigned int version) {
+	ar & m_pose;
+
+	if(ARCHIVE::is_loading::value)
+		invalidate();
+}
+
+template<typename ARCHIVE>
+void AnimationClip::serialize(ARCHIVE& ar, const unsigned int version) {
+	detail::serializeHierarchy(ar, m_hierarchy);
+
+	ar & m_fps;
+	ar & m_frameCount;
+
+	ar & m_rotations;
+	ar & m_translations;
+	ar & m_times;
+	ar & m_values;
+}
+
+template<typename ARCHIVE>
+void HalfPose::serialize(ARCHIVE& ar, const unsigned int version) {
+	detail::serializeHierarchy(ar, m_hierarchy);
+
+	ar & m_translationScale;
+
+	std::size_t count = m_data.size();
+	ar & count;
+
+	if(ARCHIVE::is_loading::value)
+		m_data.resize(count);
+
+	ar & boost::serialization::make_array(reinterpret_cast<unsigned short*>(m_data.data()), count);
+}
+
+}
@@ -0,0 +1,294 @@
+#pragma once
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+
+#include <ImathVec.h>
+#include <ImathQuat.h>
+
+namespace openanim {
+
+/// Minimal wrappers of SIMD float vectors, allowing to write each batch kernel only once as
+/// a template, and instantiate it for AVX (8 lanes), SSE (4 lanes) and plain scalar code (used both
+/// as a fallback and for processing the tails of arrays). Only the operations needed by the
+/// kernels in this library are provided.
+namespace simd {
+
+/// scalar "vector" of width 1
+struct float1 {
+	static const unsigned width = 1;
+
+	float v;
+
+	static float1 set1(float f) { return float1{f}; }
+	static float1 load(const float* ptr) { return float1{*ptr}; }
+	static float1 loadu(const float* ptr) { return float1{*ptr}; }
+	void store(float* ptr) const { *ptr = v; }
+};
+
+inline float1 operator + (float1 a, float1 b) { return float1{a.v + b.v}; }
+inline float1 operator - (float1 a, float1 b) { return float1{a.v - b.v}; }
+inline float1 operator * (float1 a, float1 b) { return float1{a.v * b.v}; }
+inline float1 operator - (float1 a) { return float1{-a.v}; }
+inline float1 operator / (float1 a, float1 b) { return float1{a.v / b.v}; }
+inline float1 sqrt(float1 a) { return float1{std::sqrt(a.v)}; }
+/// value with its sign flipped if sign is negative (bit operation, without branching)
+inline float1 flipSign(float1 value, float1 sign) {
+	std::uint32_t v, s;
+	std::memcpy(&v, &value.v, sizeof(float));
+	std::memcpy(&s, &sign.v, sizeof(float));
+	v ^= s & 0x80000000u;
+
+	float1 result;
+	std::memcpy(&result.v, &v, sizeof(float));
+	return result;
+}
+
+#if defined(__SSE2__)
+
+/// 4 lanes, SSE
+struct float4 {
+	static const unsigned width = 4;
+
+	__m128 v;
+
+	static float4 set1(float f) { return float4{_mm_set1_ps(f)}; }
+	static float4 load(const float* ptr) { return float4{_mm_load_ps(ptr)}; }
+	static float4 loadu(const float* ptr) { return float4{_mm_loadu_ps(ptr)}; }
+	void store(float* ptr) const { _mm_store_ps(ptr, v); }
+};
+
+inline float4 operator + (float4 a, float4 b) { return float4{_mm_add_ps(a.v, b.v)}; }
+inline float4 operator - (float4 a, float4 b) { return float4{_mm_sub_ps(a.v, b.v)}; }
+inline float4 operator * (float4 a, float4 b) { return float4{_mm_mul_ps(a.v, b.v)}; }
+inline float4 operator - (float4 a) { return float4{_mm_xor_ps(a.v, _mm_set1_ps(-0.0f))}; }
+inline float4 operator / (float4 a, float4 b) { return float4{_mm_div_ps(a.v, b.v)}; }
+inline float4 sqrt(float4 a) { return float4{_mm_sqrt_ps(a.v)}; }
+inline float4 flipSign(float4 value, float4 sign) { return float4{_mm_xor_ps(value.v, _mm_and_ps(sign.v, _mm_set1_ps(-0.0f)))}; }
+
+#endif
+
+#if defined(__AVX__)
+
+/// 8 lanes, AVX
+struct float8 {
+	static const unsigned width = 8;
+
+	__m256 v;
+
+	static float8 set1(float f) { return float8{_mm256_set1_ps(f)}; }
+	static float8 load(const float* ptr) { return float8{_mm256_load_ps(ptr)}; }
+	static float8 loadu(const float* ptr) { return float8{_mm256_loadu_ps(ptr)}; }
+	void store(float* ptr) const { _mm256_store_ps(ptr, v); }
+};
+
+inline float8 operator + (float8 a, float8 b) { return float8{_mm256_add_ps(a.v, b.v)}; }
+inline float8 operator - (float8 a, float8 b) { return float8{_mm256_sub_ps(a.v, b.v)}; }
+inline float8 operator * (float8 a, float8 b) { return float8{_mm256_mul_ps(a.v, b.v)}; }
+inline float8 operator - (float8 a) { return float8{_mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f))}; }
+inline float8 operator / (float8 a, float8 b) { return float8{_mm256_div_ps(a.v, b.v)}; }
+inline float8 sqrt(float8 a) { return float8{_mm256_sqrt_ps(a.v)}; }
+inline float8 flipSign(float8 value, float8 sign) { return float8{_mm256_xor_ps(value.v, _mm256_and_ps(sign.v, _mm256_set1_ps(-0.0f)))}; }
+
+#endif
+
+/// the widest vector type available in the current build
+#if defined(__AVX__)
+typedef float8 native;
+#elif defined(__SSE2__)
+typedef float4 native;
+#else
+typedef float1 native;
+#endif
+
+/////////
+
+/// F::width rigid transformations in a structure-of-arrays (register) layout
+template<typename F>
+struct Transforms {
+	F tx, ty, tz;
+	F qr, qx, qy, qz;
+};
+
+/// loads F::width transformations from separate translation and rotation arrays, at given indices
+template<typename F>
+inline void gather(Transforms<F>& result, const Imath::V3f* tr, const Imath::Quatf* rot, const int* indices) {
+	alignas(32) float data[7][F::width];
+	for(unsigned l = 0; l < F::width; ++l) {
+		const Imath::V3f& t = tr[indices[l]];
+		const Imath::Quatf& q = rot[indices[l]];
+
+		data[0][l] = t.x;
+		data[1][l] = t.y;
+		data[2][l] = t.z;
+		data[3][l] = q.r;
+		data[4][l] = q.v.x;
+		data[5][l] = q.v.y;
+		data[6][l] = q.v.z;
+	}
+
+	result.tx = F::load(data[0]);
+	result.ty = F::load(data[1]);
+	result.tz = F::load(data[2]);
+	result.qr = F::load(data[3]);
+	result.qx = F::load(data[4]);
+	result.qy = F::load(data[5]);
+	result.qz = F::load(data[6]);
+}
+
+/// loads F::width consecutive transformations from separate translation and rotation arrays
+template<typename F>
+inline void load(Transforms<F>& result, const Imath::V3f* tr, const Imath::Quatf* rot) {
+	alignas(32) float data[7][F::width];
+	for(unsigned l = 0; l < F::width; ++l) {
+		data[0][l] = tr[l].x;
+		data[1][l] = tr[l].y;
+		data[2][l] = tr[l].z;
+		data[3][l] = rot[l].r;
+		data[4][l] = rot[l].v.x;
+		data[5][l] = rot[l].v.y;
+		data[6][l] = rot[l].v.z;
+	}
+
+	result.tx = F::load(data[0]);
+	result.ty = F::load(data[1]);
+	result.tz = F::load(data[2]);
+	result.qr = F::load(data[3]);
+	result.qx = F::load(data[4]);
+	result.qy = F::load(data[5]);
+	result.qz = F::load(data[6]);
+}
+
+/// stores F::width consecutive transformations to separate translation and rotation arrays
+template<typename F>
+inline void store(const Transforms<F>& value, Imath::V3f* tr, Imath::Quatf* rot) {
+	alignas(32) float data[7][F::width];
+	value.tx.store(data[0]);
+	value.ty.store(data[1]);
+	value.tz.store(data[2]);
+	value.qr.store(data[3]);
+	value.qx.store(data[4]);
+	value.qy.store(data[5]);
+	value.qz.store(data[6]);
+
+	for(unsigned l = 0; l < F::width; ++l) {
+		tr[l].x = data[0][l];
+		tr[l].y = data[1][l];
+		tr[l].z = data[2][l];
+		rot[l].r = data[3][l];
+		rot[l].v.x = data[4][l];
+		rot[l].v.y = data[5][l];
+		rot[l].v.z = data[6][l];
+	}
+}
+
+/// stores F::width transformations to separate translation and rotation arrays, at given indices
+template<typename F>
+inline void scatter(const Transforms<F>& value, Imath::V3f* tr, Imath::Quatf* rot, const int* indices) {
+	alignas(32) float data[7][F::width];
+	value.tx.store(data[0]);
+	value.ty.store(data[1]);
+	value.tz.store(data[2]);
+	value.qr.store(data[3]);
+	value.qx.store(data[4]);
+	value.qy.store(data[5]);
+	value.qz.store(data[6]);
+
+	for(unsigned l = 0; l < F::width; ++l) {
+		Imath::V3f& t = tr[indices[l]];
+		Imath::Quatf& q = rot[indices[l]];
+
+		t.x = data[0][l];
+		t.y = data[1][l];
+		t.z = data[2][l];
+		q.r = data[3][l];
+		q.v.x = data[4][l];
+		q.v.y = data[5][l];
+		q.v.z = data[6][l];
+	}
+}
+
+/// rotates vector (x, y, z) by quaternion q, with the same convention as Imath's V3f * Quatf
+template<typename F>
+inline void rotate(const Transforms<F>& q, F& x, F& y, F& z) {
+	// a = q.v % v
+	const F ax = q.qy*z - q.qz*y;
+	const F ay = q.qz*x - q.qx*z;
+	const F az = q.qx*y - q.qy*x;
+
+	// b = q.v % a
+	const F bx = q.qy*az - q.qz*ay;
+	const F by = q.qz*ax - q.qx*az;
+	const F bz = q.qx*ay - q.qy*ax;
+
+	// v + 2 * (q.r * a + b)
+	const F two = F::set1(2.0f);
+	x = x + two * (q.qr*ax + bx);
+	y = y + two * (q.qr*ay + by);
+	z = z + two * (q.qr*az + bz);
+}
+
+/// dot product of the rotation quaternions
+template<typename F>
+inline F dot(const Transforms<F>& a, const Transforms<F>& b) {
+	return a.qr*b.qr + a.qx*b.qx + a.qy*b.qy + a.qz*b.qz;
+}
+
+/// normalizes the rotation quaternions
+template<typename F>
+inline void normalize(Transforms<F>& a) {
+	const F invLength = F::set1(1.0f) / sqrt(dot(a, a));
+
+	a.qr = a.qr * invLength;
+	a.qx = a.qx * invLength;
+	a.qy = a.qy * invLength;
+	a.qz = a.qz * invLength;
+}
+
+/// inverse of a transformation, equivalent to Transform::inverse() (assumes normalized rotations).
+/// The result cannot alias the input.
+template<typename F>
+inline void inverse(const Transforms<F>& a, Transforms<F>& result) {
+	// conjugate of the rotation
+	result.qr = a.qr;
+	result.qx = -a.qx;
+	result.qy = -a.qy;
+	result.qz = -a.qz;
+
+	// negated translation, rotated by the inverse rotation
+	result.tx = -a.tx;
+	result.ty = -a.ty;
+	result.tz = -a.tz;
+	rotate(result, result.tx, result.ty, result.tz);
+}
+
+/// composition of transformations, equivalent to result = a * b for Transform instances.
+/// The result can alias neither a nor b.
+template<typename F>
+inline void multiply(const Transforms<F>& a, const Transforms<F>& b, Transforms<F>& result) {
+	// rotation = b.rotation * a.rotation
+	result.qr = b.qr*a.qr - b.qx*a.qx - b.qy*a.qy - b.qz*a.qz;
+	result.qx = b.qr*a.qx + a.qr*b.qx + b.qy*a.qz - b.qz*a.qy;
+	result.qy = b.qr*a.qy + a.qr*b.qy + b.qz*a.qx - b.qx*a.qz;
+	result.qz = b.qr*a.qz + a.qr*b.qz + b.qx*a.qy - b.qy*a.qx;
+
+	// translation = a.translation * b.rotation + b.translation
+	result.tx = a.tx;
+	result.ty = a.ty;
+	result.tz = a.tz;
+	rotate(b, result.tx, result.ty, result.tz);
+	result.tx = result.tx + b.tx;
+	result.ty = result.ty + b.ty;
+	result.tz = result.tz + b.tz;
+}
+
+}
+
+}
@@ -1,141 +1,367 @@
 #include "Skeleton.h"
 
 #include <cassert>
+#include <algorithm>
 #include <iostream>
 
+#include "Instrumentation.h"
+
 using std::cout;
 using std::endl;
 
 namespace openanim {
 
-Skeleton::Joint::Joint(std::size_t id, const Transform& transform, Skeleton* skel) : 
-m_id(id), m_transformation(transform), m_skeleton(skel) 
-{
+Skeleton::ConstJoint::ConstJoint(std::size_t id, const Skeleton* skel) : m_id(id), m_skeleton(skel) {
 }
 
-const std::string& Skeleton::Joint::name() const {
+const char* Skeleton::ConstJoint::name() const {
 	assert(m_skeleton != NULL);
 	assert(m_id < m_skeleton->size());
-	return (*m_skeleton->m_hierarchy)[m_id].name;
+	return m_skeleton->m_pose.hierarchy().name(m_id);
 }
 
-std::size_t Skeleton::Joint::index() const {
+std::size_t Skeleton::ConstJoint::index() const {
 	return m_id;
 }
 
-Children<Skeleton::Joint, Skeleton> Skeleton::Joint::children() {
+Children<Skeleton::ConstJoint, const Skeleton> Skeleton::ConstJoint::children() const {
 	assert(m_skeleton != NULL);
-	auto& j = (*m_skeleton->m_hierarchy)[m_id];
-	return Children<Skeleton::Joint, Skeleton>(j.children_begin, j.children_end, *m_skeleton);
+	return Children<Skeleton::ConstJoint, const Skeleton>(m_skeleton->m_pose.hierarchy(), m_id, *m_skeleton);
 }
 
-const Children<Skeleton::Joint, Skeleton> Skeleton::Joint::children() const {
+bool Skeleton::ConstJoint::hasParent() const {
 	assert(m_skeleton != NULL);
-	auto& j = (*m_skeleton->m_hierarchy)[m_id];
-	return Children<Skeleton::Joint, Skeleton>(j.children_begin, j.children_end, *m_skeleton);
+	assert(m_id < m_skeleton->size());
+	return m_skeleton->m_pose.hierarchy()[m_id].parent >= 0;
 }
 
-bool Skeleton::Joint::hasParent() const {
+Skeleton::ConstJoint Skeleton::ConstJoint::parent() const {
 	assert(m_skeleton != NULL);
 	assert(m_id < m_skeleton->size());
-	return (*m_skeleton->m_hierarchy)[m_id].parent >= 0;
+	assert(hasParent());
+	return (*m_skeleton)[m_skeleton->m_pose.hierarchy()[m_id].parent];
+}
+
+const Transform Skeleton::ConstJoint::tr() const {
+	assert(m_skeleton != NULL);
+	return m_skeleton->m_pose[m_id];
 }
 
-Skeleton::Joint& Skeleton::Joint::parent() {
+const Transform Skeleton::ConstJoint::world() const {
 	assert(m_skeleton != NULL);
 	assert(m_id < m_skeleton->size());
-	assert(hasParent());
-	return (*m_skeleton)[(*m_skeleton->m_hierarchy)[m_id].parent];
+	return m_skeleton->worldPose()[m_id];
+}
+
+////////
+
+Skeleton::Joint::Joint(std::size_t id, Skeleton* skel) : ConstJoint(id, skel) {
 }
 
-const Skeleton::Joint& Skeleton::Joint::parent() const {
+Skeleton* Skeleton::Joint::skeleton() const {
+	return const_cast<Skeleton*>(m_skeleton);
+}
+
+Children<Skeleton::Joint, Skeleton> Skeleton::Joint::children() {
+	assert(m_skeleton != NULL);
+	return Children<Skeleton::Joint, Skeleton>(m_skeleton->m_pose.hierarchy(), m_id, *skeleton());
+}
+
+Skeleton::Joint Skeleton::Joint::parent() {
 	assert(m_skeleton != NULL);
 	assert(m_id < m_skeleton->size());
 	assert(hasParent());
-	return (*m_skeleton)[(*m_skeleton->m_hierarchy)[m_id].parent];
+	return (*skeleton())[m_skeleton->m_pose.hierarchy()[m_id].parent];
+}
+
+TransformRef Skeleton::Joint::tr() {
+	assert(m_skeleton != NULL);
+	skeleton()->invalidate(m_id);
+	return skeleton()->m_pose[m_id];
+}
+
+////////
+
+Skeleton::Edit::Edit(Skeleton& s) : m_skeleton(&s), m_root(-1), m_structureChanged(false), m_transformsChanged(false), m_committed(false) {
+	// detach the hierarchy into the editable table
+	const Hierarchy& h = s.m_pose.hierarchy();
+
+	m_entries.reserve(h.size());
+	for(std::size_t ji = 0; ji < h.size(); ++ji) {
+		m_entries.push_back(Entry{h.name(ji), h[ji].parent, s.m_pose[ji]});
+
+		if(h[ji].parent < 0)
+			m_root = ji;
+	}
+
+	m_removed.resize(m_entries.size(), false);
+}
+
+Skeleton::Edit::~Edit() {
+	if(!m_committed)
+		commit();
+}
+
+std::size_t Skeleton::Edit::addRoot(const std::string& name, const Transform& tr) {
+	assert(!m_committed);
+
+	m_structureChanged = true;
+
+	const int index = m_entries.size();
+	m_entries.push_back(Entry{name, -1, tr});
+	m_removed.push_back(false);
+
+	if(m_root >= 0)
+		m_entries[m_root].parent = index;
+	m_root = index;
+
+	return index;
+}
+
+std::size_t Skeleton::Edit::addChild(std::size_t parent, const Transform& tr, const std::string& name) {
+	assert(!m_committed);
+	assert(parent < m_entries.size());
+
+	m_structureChanged = true;
+
+	m_entries.push_back(Entry{name, (int)parent, tr});
+	m_removed.push_back(false);
+
+	return m_entries.size() - 1;
+}
+
+void Skeleton::Edit::remove(std::size_t entry) {
+	assert(!m_committed);
+	assert(entry < m_entries.size());
+	assert((int)entry != m_root && "the root joint cannot be removed");
+
+	m_structureChanged = true;
+
+	// the subtree is removed implicitly during the commit
+	m_removed[entry] = true;
+}
+
+void Skeleton::Edit::reparent(std::size_t entry, std::size_t parent) {
+	assert(!m_committed);
+	assert(entry < m_entries.size());
+	assert(parent < m_entries.size());
+	assert((int)entry != m_root && "the root joint cannot be reparented");
+
+#ifndef NDEBUG
+	// the new parent cannot be in the subtree of the entry
+	for(int p = parent; p >= 0; p = m_entries[p].parent)
+		assert(p != (int)entry && "reparenting would create a cycle");
+#endif
+
+	m_structureChanged = true;
+	m_entries[entry].parent = parent;
 }
 
-Transform& Skeleton::Joint::tr() {
-	return m_transformation;
+std::size_t Skeleton::Edit::graft(std::size_t parent, const Skeleton& s) {
+	assert(!m_committed);
+	assert(parent < m_entries.size());
+	assert(!s.empty());
+
+	m_structureChanged = true;
+
+	const std::size_t offset = m_entries.size();
+	const Hierarchy& h = s.m_pose.hierarchy();
+
+	for(std::size_t ji = 0; ji < h.size(); ++ji) {
+		m_entries.push_back(Entry{h.name(ji), h[ji].parent >= 0 ? (int)(h[ji].parent + offset) : (int)parent, s.m_pose[ji]});
+		m_removed.push_back(false);
+	}
+
+	return offset;
 }
 
-const Transform& Skeleton::Joint::tr() const {
-	return m_transformation;
+Transform& Skeleton::Edit::tr(std::size_t entry) {
+	assert(!m_committed);
+	assert(entry < m_entries.size());
+
+	m_transformsChanged = true;
+
+	return m_entries[entry].tr;
+}
+
+bool Skeleton::Edit::isRemoved(std::size_t entry, std::vector<char>& state) const {
+	// state: 0 - not known yet, 1 - kept, 2 - removed.
+	// Walks up the hierarchy until an entry with a known state is found, and then
+	// propagates the result down the path (iteratively, chains can be very long).
+	std::size_t top = entry;
+	while(state[top] == 0) {
+		if(m_removed[top])
+			state[top] = 2;
+		else if(m_entries[top].parent < 0)
+			state[top] = 1;
+		else
+			top = m_entries[top].parent;
+	}
+
+	for(std::size_t e = entry; e != top; e = m_entries[e].parent)
+		state[e] = state[top];
+
+	return state[entry] == 2;
+}
+
+void Skeleton::Edit::commit() {
+	OPENANIM_TIMER("skeleton/edit_commit");
+
+	assert(!m_committed);
+	m_committed = true;
+
+	// no structural change - the hierarchy instance is kept, and only the transformations are updated
+	if(!m_structureChanged) {
+		if(m_transformsChanged) {
+			for(std::size_t e = 0; e < m_entries.size(); ++e)
+				m_skeleton->m_pose[e] = m_entries[e].tr;
+			m_skeleton->invalidate();
+		}
+
+		m_mapping.resize(m_entries.size());
+		for(std::size_t e = 0; e < m_entries.size(); ++e)
+			m_mapping[e] = e;
+
+		m_entries.clear();
+		m_removed.clear();
+
+		return;
+	}
+
+	// compact the table, skipping removed subtrees
+	std::vector<char> state(m_entries.size(), 0);
+	std::vector<int> compacted(m_entries.size(), -1);
+
+	std::vector<Entry> table;
+	table.reserve(m_entries.size());
+	for(std::size_t e = 0; e < m_entries.size(); ++e)
+		if(!isRemoved(e, state)) {
+			compacted[e] = table.size();
+			table.push_back(std::move(m_entries[e]));
+		}
+
+	for(auto& e : table)
+		if(e.parent >= 0)
+			e.parent = compacted[e.parent];
+
+	// build the new hierarchy in one pass, and publish it
+	std::vector<std::size_t> index;
+	*m_skeleton = Skeleton(table, &index);
+
+	m_mapping.resize(m_entries.size());
+	for(std::size_t e = 0; e < m_entries.size(); ++e)
+		m_mapping[e] = compacted[e] >= 0 ? (int)index[compacted[e]] : -1;
+
+	m_entries.clear();
+	m_removed.clear();
+}
+
+int Skeleton::Edit::index(std::size_t entry) const {
+	assert(m_committed);
+	assert(entry < m_mapping.size());
+
+	return m_mapping[entry];
 }
 
 ////////
 
-Skeleton::Skeleton() : m_hierarchy(new Hierarchy()) {
+Skeleton::Skeleton() : m_firstDirty(0) {
+}
+
+Skeleton::Skeleton(const std::vector<Entry>& joints, std::vector<std::size_t>* mapping) : m_firstDirty(0) {
+	std::vector<std::string> names(joints.size());
+	std::vector<int> parents(joints.size());
+	for(std::size_t ji = 0; ji < joints.size(); ++ji) {
+		names[ji] = joints[ji].name;
+		parents[ji] = joints[ji].parent;
+	}
+
+	std::vector<std::size_t> index;
+	m_pose = Pose(std::make_shared<const Hierarchy>(names, parents, &index));
+
+	for(std::size_t ji = 0; ji < joints.size(); ++ji)
+		m_pose[index[ji]] = joints[ji].tr;
+
+	if(mapping != NULL)
+		mapping->swap(index);
 }
 
-Skeleton::Skeleton(const Skeleton& h) : m_joints(h.m_joints), m_hierarchy(h.m_hierarchy) {
-	for(auto& j : m_joints)
-		j.m_skeleton = this;
+// no joint data refer back to the skeleton instance, so copying and moving is just
+// a copy or a move of the pose arrays. A move keeps the world cache, which stays valid;
+// a copy doesn't copy it, and it is rebuilt lazily on the first query.
+
+Skeleton::Skeleton(const Skeleton& h) : m_pose(h.m_pose), m_firstDirty(0) {
+	OPENANIM_COUNT("skeleton/copy", 1);
 }
 
 Skeleton& Skeleton::operator = (const Skeleton& h) {
-	m_hierarchy = h.m_hierarchy;
-	m_joints = h.m_joints;
+	OPENANIM_COUNT("skeleton/copy", 1);
 
-	for(auto& j : m_joints)
-		j.m_skeleton = this;
+	m_pose = h.m_pose;
+	invalidate();
 
 	return *this;
 }
 
-Skeleton::Skeleton(Skeleton&& h) : m_joints(std::move(h.m_joints)), m_hierarchy(std::move(h.m_hierarchy)) {
-	for(auto& j : m_joints)
-		j.m_skeleton = this;
+Skeleton::Skeleton(Skeleton&& h) : m_pose(std::move(h.m_pose)), m_world(std::move(h.m_world)), m_dirty(std::move(h.m_dirty)), m_firstDirty(h.m_firstDirty) {
 }
 
 Skeleton& Skeleton::operator = (Skeleton&& h) {
-	m_joints = std::move(h.m_joints);
-	m_hierarchy = std::move(h.m_hierarchy);
+	m_pose = std::move(h.m_pose);
 
-	for(auto& j : m_joints)
-		j.m_skeleton = this;
+	m_world = std::move(h.m_world);
+	m_dirty = std::move(h.m_dirty);
+	m_firstDirty = h.m_firstDirty;
 
 	return *this;
 }
 
-Skeleton::Joint& Skeleton::operator[](std::size_t index) {
-	assert(index < m_joints.size());
-	return m_joints[index];
+Skeleton::Skeleton(const Pose& p) : m_pose(p), m_firstDirty(0) {
+}
+
+Skeleton::Skeleton(Pose&& p) : m_pose(std::move(p)), m_firstDirty(0) {
 }
 
-const Skeleton::Joint& Skeleton::operator[](std::size_t index) const {
-	assert(index < m_joints.size());
-	return m_joints[index];
+Skeleton::Joint Skeleton::operator[](std::size_t index) {
+	assert(index < size());
+	return Joint(index, this);
+}
+
+Skeleton::ConstJoint Skeleton::operator[](std::size_t index) const {
+	assert(index < size());
+	return ConstJoint(index, this);
 }
 
 bool Skeleton::empty() const {
-	return m_joints.empty();
+	return m_pose.empty();
 }
 
 size_t Skeleton::size() const {
-	return m_joints.size();
+	return m_pose.size();
 }
 
-std::size_t Skeleton::indexOf(const Joint& j) const {
-	assert(j.children().m_joints == this);
+std::size_t Skeleton::indexOf(const ConstJoint& j) const {
+	assert(j.m_skeleton == this);
 
-	return (&j - &(*m_joints.begin()));
+	return j.m_id;
 }
 
 void Skeleton::addRoot(const std::string& name, const Transform& tr) {
 	// changing the hierarchy means the result is no longer compatible with other instances sharing the same
 	// hierarchy instance
-	m_hierarchy = std::shared_ptr<Hierarchy>(new Hierarchy(*m_hierarchy));
+	std::shared_ptr<Hierarchy> hierarchy(new Hierarchy(m_pose.hierarchy()));
 
 	// create a single root joint, with children "behind the end"
-	m_hierarchy->addRoot(name);
+	hierarchy->addRoot(name);
+	m_pose.m_hierarchy = hierarchy;
 
 	// and just add a joint to the hierarchy, updating all related joints
-	m_joints.insert(m_joints.begin(), Joint(0, tr, this));
-	for(auto it = m_joints.begin()+1; it != m_joints.end(); ++it)
-		++it->m_id;
+	m_pose.m_translations.insert(m_pose.m_translations.begin(), tr.translation);
+	m_pose.m_rotations.insert(m_pose.m_rotations.begin(), tr.rotation);
+
+	assert(m_pose.size() == hierarchy->size());
 
-	assert(m_joints.size() == m_hierarchy->size());
+	invalidate();
 }
 
 std::size_t Skeleton::addChild(const Joint& j, const Transform& tr, const std::string& name) {
@@ -143,39 +369,105 @@ std::size_t Skeleton::addChild(const Joint& j, const Transform& tr, const std::s
 
 	// changing the hierarchy means the result is no longer compatible with other instances sharing the same
 	// hierarchy instance
-	m_hierarchy = std::shared_ptr<Hierarchy>(new Hierarchy(*m_hierarchy));
+	std::shared_ptr<Hierarchy> hierarchy(new Hierarchy(m_pose.hierarchy()));
 
 	// add a child
-	std::size_t index = m_hierarchy->addChild((*m_hierarchy)[j.m_id], name);
+	std::size_t index = hierarchy->addChild((*hierarchy)[j.m_id], name);
+	m_pose.m_hierarchy = hierarchy;
 
 	// and just add a joint to the hierarchy, updating all related joints
-	m_joints.insert(m_joints.begin()+index, Joint(index, tr, this));
-	for(auto it = m_joints.begin()+index+1; it != m_joints.end(); ++it)
-		++it->m_id;
+	m_pose.m_translations.insert(m_pose.m_translations.begin()+index, tr.translation);
+	m_pose.m_rotations.insert(m_pose.m_rotations.begin()+index, tr.rotation);
 
-	assert(m_joints.size() == m_hierarchy->size());
+	assert(m_pose.size() == hierarchy->size());
+
+	invalidate();
 
 	return index;
 }
 
 Skeleton::const_iterator Skeleton::begin() const {
-	return m_joints.begin();
+	return const_iterator(ConstJoint(0, this));
 }
 
 Skeleton::const_iterator Skeleton::end() const {
-	return m_joints.end();
+	return const_iterator(ConstJoint(size(), this));
 }
 
 Skeleton::iterator Skeleton::begin() {
-	return m_joints.begin();
+	return iterator(Joint(0, this));
 }
 
 Skeleton::iterator Skeleton::end() {
-	return m_joints.end();
+	return iterator(Joint(size(), this));
 }
 
 bool Skeleton::isCompatibleWith(const Skeleton& s) const {
-	return m_hierarchy == s.m_hierarchy;
+	return m_pose.isCompatibleWith(s.m_pose);
+}
+
+const Pose& Skeleton::pose() const {
+	return m_pose;
+}
+
+Pose& Skeleton::mutablePose() {
+	invalidate();
+	return m_pose;
+}
+
+const Pose& Skeleton::worldPose() const {
+	updateWorld();
+	return m_world;
+}
+
+void Skeleton::invalidate(std::size_t index) {
+	assert(index < size());
+
+	// the flags are (re)allocated during the next update
+	if(m_dirty.size() == size())
+		m_dirty[index] = 1;
+
+	m_firstDirty = std::min(m_firstDirty, index);
+}
+
+void Skeleton::invalidate() {
+	m_dirty.clear();
+	m_firstDirty = 0;
+}
+
+void Skeleton::updateWorld() const {
+	OPENANIM_TIMER("skeleton/update_world");
+
+	// the pose might have been replaced or resized - everything is dirty
+	if(m_dirty.size() != size() || !m_world.isCompatibleWith(m_pose)) {
+		m_dirty.assign(size(), 1);
+		if(!m_world.isCompatibleWith(m_pose))
+			m_world = Pose(m_pose.sharedHierarchy());
+		m_firstDirty = 0;
+	}
+
+	if(m_firstDirty >= size())
+		return;
+
+	// parents are always before their children, so a single pass propagates the flags down the
+	// hierarchy and recomputes the changed joints
+	const Hierarchy& h = m_pose.hierarchy();
+	for(std::size_t ji = m_firstDirty; ji < size(); ++ji) {
+		const int parent = h[ji].parent;
+
+		if(parent >= 0 && m_dirty[parent])
+			m_dirty[ji] = 1;
+
+		if(m_dirty[ji]) {
+			if(parent >= 0)
+				m_world[ji] = m_pose[ji] * static_cast<const Pose&>(m_world)[parent];
+			else
+				m_world[ji] = m_pose[ji];
+		}
+	}
+
+	std::fill(m_dirty.begin() + m_firstDirty, m_dirty.end(), 0);
+	m_firstDirty = size();
 }
 
 }
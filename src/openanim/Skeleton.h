@@ -3,58 +3,205 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <iterator>
+#include <cassert>
 
 #include <boost/noncopyable.hpp>
+#include <boost/serialization/access.hpp>
 
 #include "Hierarchy.h"
+#include "Children.h"
 #include "Transform.h"
+#include "Pose.h"
 
 namespace openanim {
 
 class Skeleton {
 	public:
-		class Joint;
-
-		typedef std::vector<Joint>::const_iterator const_iterator;
-		typedef std::vector<Joint>::iterator iterator;
-
-		/// a single joint and its children.
+		/// a read-only reference to a single joint and its children.
 		/// The joint instance behaves like an iterator - it is just a weak
 		/// reference to the Hierarchy structure and cannot exist on its own.
-		class Joint {
+		/// Joints are not stored in the skeleton, but created on demand by its accessors
+		/// (a const Skeleton returns ConstJoint instances, which cannot be converted to Joint).
+		class ConstJoint {
 			public:
-				const std::string& name() const;
+				const char* name() const;
 				std::size_t index() const;
 
-				Children<Joint, Skeleton> children();
-				const Children<Joint, Skeleton> children() const;
+				Children<ConstJoint, const Skeleton> children() const;
 
 				bool hasParent() const;
-				Joint& parent();
-				const Joint& parent() const;
+				ConstJoint parent() const;
 
-				Transform& tr();
-				const Transform& tr() const;
+				/// local transformation of the joint
+				const Transform tr() const;
 
-			private:
-				Joint(std::size_t id, const Transform& transform, Skeleton* skel);
+				/// world-space transformation of the joint (see Skeleton::worldPose())
+				const Transform world() const;
+
+			protected:
+				ConstJoint(std::size_t id, const Skeleton* skel);
 
 				std::size_t m_id;
-				Transform m_transformation;
-				Skeleton* m_skeleton;
+				const Skeleton* m_skeleton;
 
 			friend class Skeleton;
+			template<typename J>
+			friend class JointIterator;
+		};
+
+		/// a single joint of a non-const skeleton, allowing to modify its transformation
+		/// (see ConstJoint).
+		class Joint : public ConstJoint {
+			public:
+				Children<Joint, Skeleton> children();
+				using ConstJoint::children;
+
+				Joint parent();
+				using ConstJoint::parent;
+
+				/// local transformation of the joint. The non-const accessor marks the joint as changed
+				/// for the world transformation cache (at the time of the call).
+				TransformRef tr();
+				using ConstJoint::tr;
+
+			protected:
+			private:
+				Joint(std::size_t id, Skeleton* skel);
+
+				/// the skeleton of the joint (a Joint is only ever created from a non-const Skeleton)
+				Skeleton* skeleton() const;
+
+			friend class Skeleton;
+			template<typename J>
+			friend class JointIterator;
+		};
+
+		/// iterator over the joints of a skeleton. Dereferencing returns a joint proxy by value
+		/// (there are no Joint instances to refer to), which makes it an input iterator - even
+		/// though it supports constant-time offsets and differences.
+		template<typename JOINT>
+		class JointIterator {
+			public:
+				typedef std::input_iterator_tag iterator_category;
+				typedef JOINT value_type;
+				typedef std::ptrdiff_t difference_type;
+				typedef JOINT* pointer;
+				typedef JOINT reference;
+
+				JointIterator();
+				template<typename J>
+				JointIterator(const JointIterator<J>& it);
+
+				JOINT operator*() const;
+				/// points to a joint held by the iterator, valid until the iterator is changed
+				JOINT* operator->() const;
+
+				JointIterator& operator++();
+				JointIterator operator++(int);
+				JointIterator& operator--();
+				JointIterator operator--(int);
+
+				JointIterator& operator += (std::ptrdiff_t n);
+				JointIterator& operator -= (std::ptrdiff_t n);
+				JointIterator operator + (std::ptrdiff_t n) const;
+				JointIterator operator - (std::ptrdiff_t n) const;
+				std::ptrdiff_t operator - (const JointIterator& it) const;
+
+				bool operator == (const JointIterator& it) const;
+				bool operator != (const JointIterator& it) const;
+				bool operator < (const JointIterator& it) const;
+
+			private:
+				explicit JointIterator(const JOINT& joint);
+
+				mutable JOINT m_joint;
+
+			friend class Skeleton;
+			template<typename J>
+			friend class JointIterator;
+		};
+
+		typedef JointIterator<ConstJoint> const_iterator;
+		typedef JointIterator<Joint> iterator;
+
+		/// a single row of a joint table, used for bulk construction
+		struct Entry {
+			std::string name;
+			int parent;
+			Transform tr;
+		};
+
+		/// A scoped structural edit of a Skeleton. The hierarchy is detached into an editable joint table
+		/// once, any number of edits are applied to the table in constant time each, and a single new shared
+		/// Hierarchy is built and published when the edit is committed (explicitly, or on destruction).
+		/// An edit without structural changes keeps the hierarchy instance (and the compatibility with
+		/// other skeletons), only writing back the transformations accessed by tr().
+		/// Joints are referred to by their "entry" index - existing joints keep their index from the edited
+		/// skeleton, and newly added joints get new indices returned by the add methods.
+		class Edit : public boost::noncopyable {
+			public:
+				explicit Edit(Skeleton& s);
+				/// commits the edit, if it hasn't been committed yet
+				~Edit();
+
+				/// adds a new root joint; the current root becomes its child
+				std::size_t addRoot(const std::string& name, const Transform& tr);
+				/// adds a new child to the entry parent
+				std::size_t addChild(std::size_t parent, const Transform& tr, const std::string& name);
+				/// removes an entry with its whole subtree
+				void remove(std::size_t entry);
+				/// moves an entry (with its whole subtree) under a new parent
+				void reparent(std::size_t entry, std::size_t parent);
+				/// adds a copy of all joints of another skeleton as a subtree of entry parent. Returns the
+				/// entry index of the grafted root; the other joints follow in their original order.
+				std::size_t graft(std::size_t parent, const Skeleton& s);
+
+				/// transformation of an entry
+				Transform& tr(std::size_t entry);
+
+				/// builds the new hierarchy and publishes it to the edited skeleton
+				void commit();
+
+				/// joint index of an entry in the committed skeleton (-1 if removed)
+				int index(std::size_t entry) const;
+
+			protected:
+			private:
+				bool isRemoved(std::size_t entry, std::vector<char>& state) const;
+
+				Skeleton* m_skeleton;
+				int m_root;
+
+				std::vector<Entry> m_entries;
+				std::vector<char> m_removed;
+
+				// any structural change (requiring a new hierarchy), and any access to the transformations
+				bool m_structureChanged, m_transformsChanged;
+
+				bool m_committed;
+				std::vector<int> m_mapping;
 		};
 
 		Skeleton();
+		/// creates a skeleton from a table of joints with parent indices (-1 for the root) in linear time.
+		/// The table can be in any order, as long as it describes a single tree. If not NULL, mapping
+		/// receives the resulting joint index of each table entry.
+		explicit Skeleton(const std::vector<Entry>& joints, std::vector<std::size_t>* mapping = NULL);
 		Skeleton(const Skeleton& h);
 		Skeleton& operator = (const Skeleton& h);
 		Skeleton(Skeleton&& h);
 		Skeleton& operator = (Skeleton&& h);
 
-		Joint& operator[](std::size_t index);
-		const Joint& operator[](std::size_t index) const;
-		std::size_t indexOf(const Joint& j) const;
+		/// creates a skeleton from a pose, sharing its hierarchy instance
+		explicit Skeleton(const Pose& p);
+		/// creates a skeleton adopting the pose data (and its hierarchy) without copying
+		/// (a pose allocated from a PoseArena is copied)
+		explicit Skeleton(Pose&& p);
+
+		Joint operator[](std::size_t index);
+		ConstJoint operator[](std::size_t index) const;
+		std::size_t indexOf(const ConstJoint& j) const;
 
 		bool empty() const;
 		size_t size() const;
@@ -71,13 +218,144 @@ class Skeleton {
 		/// returns true if the poses between these two skeletons can be directly assigned (if they share the same hierarchy instance)
 		bool isCompatibleWith(const Skeleton& s) const;
 
+		/// the transformations of all joints, as a structure of arrays
+		const Pose& pose() const;
+		/// writable access to the transformations of all joints - can be used to modify them in bulk,
+		/// to assign a compatible pose, or to adopt it by moving. Invalidates the whole world
+		/// transformation cache (use pose() for reading).
+		Pose& mutablePose();
+
+		/// world-space transformations of all joints. These are cached, and lazily recomputed only for
+		/// joints changed since the last query (using non-const Joint::tr(), mutablePose() or invalidate()) and their
+		/// descendants. Not thread-safe - the cache is updated even by const access.
+		const Pose& worldPose() const;
+
+		/// marks a joint as changed (needed only if the pose is modified without using Joint::tr())
+		void invalidate(std::size_t index);
+		/// marks all joints as changed
+		void invalidate();
+
 	protected:
 	private:
-		// exists only so I can return references to joints, not instances
-		std::vector<Joint> m_joints;
-		// stores the hierachy of joints, shared between all "compatible" skeleton instances
-		// (instances whose poses can be directly assigned).
-		std::shared_ptr<Hierarchy> m_hierarchy;
+		/// serializes the pose; the world cache is rebuilt after loading (see Serialization.h)
+		template<typename ARCHIVE>
+		void serialize(ARCHIVE& ar, const unsigned int version);
+
+		/// recomputes the world transformations of all changed joints and their descendants
+		void updateWorld() const;
+
+		// stores the joint transformations and the hierachy of joints, shared between all "compatible"
+		// skeleton instances (instances whose poses can be directly assigned).
+		Pose m_pose;
+
+		// world transformation cache, with a "changed" flag per joint; joints before m_firstDirty are
+		// all up to date
+		mutable Pose m_world;
+		mutable std::vector<char> m_dirty;
+		mutable std::size_t m_firstDirty;
+
+	friend class boost::serialization::access;
 };
 
+////
+
+template<typename JOINT>
+Skeleton::JointIterator<JOINT>::JointIterator() : m_joint(0, NULL) {
+}
+
+template<typename JOINT>
+Skeleton::JointIterator<JOINT>::JointIterator(const JOINT& joint) : m_joint(joint) {
+}
+
+template<typename JOINT>
+template<typename J>
+Skeleton::JointIterator<JOINT>::JointIterator(const JointIterator<J>& it) : m_joint(it.m_joint) {
+}
+
+template<typename JOINT>
+JOINT Skeleton::JointIterator<JOINT>::operator*() const {
+	return m_joint;
+}
+
+template<typename JOINT>
+JOINT* Skeleton::JointIterator<JOINT>::operator->() const {
+	return &m_joint;
+}
+
+template<typename JOINT>
+Skeleton::JointIterator<JOINT>& Skeleton::JointIterator<JOINT>::operator++() {
+	++m_joint.m_id;
+	return *this;
+}
+
+template<typename JOINT>
+Skeleton::JointIterator<JOINT> Skeleton::JointIterator<JOINT>::operator++(int) {
+	JointIterator result(*this);
+	++m_joint.m_id;
+	return result;
+}
+
+template<typename JOINT>
+Skeleton::JointIterator<JOINT>& Skeleton::JointIterator<JOINT>::operator--() {
+	--m_joint.m_id;
+	return *this;
+}
+
+template<typename JOINT>
+Skeleton::JointIterator<JOINT> Skeleton::JointIterator<JOINT>::operator--(int) {
+	JointIterator result(*this);
+	--m_joint.m_id;
+	return result;
+}
+
+template<typename JOINT>
+Skeleton::JointIterator<JOINT>& Skeleton::JointIterator<JOINT>::operator += (std::ptrdiff_t n) {
+	m_joint.m_id += n;
+	return *this;
+}
+
+template<typename JOINT>
+Skeleton::JointIterator<JOINT>& Skeleton::JointIterator<JOINT>::operator -= (std::ptrdiff_t n) {
+	m_joint.m_id -= n;
+	return *this;
+}
+
+template<typename JOINT>
+Skeleton::JointIterator<JOINT> Skeleton::JointIterator<JOINT>::operator + (std::ptrdiff_t n) const {
+	JointIterator result(*this);
+	result.m_joint.m_id += n;
+	return result;
+}
+
+template<typename JOINT>
+Skeleton::JointIterator<JOINT> Skeleton::JointIterator<JOINT>::operator - (std::ptrdiff_t n) const {
+	JointIterator result(*this);
+	result.m_joint.m_id -= n;
+	return result;
+}
+
+template<typename JOINT>
+std::ptrdiff_t Skeleton::JointIterator<JOINT>::operator - (const JointIterator& it) const {
+	assert(m_joint.m_skeleton == it.m_joint.m_skeleton);
+	return (std::ptrdiff_t)m_joint.m_id - (std::ptrdiff_t)it.m_joint.m_id;
+}
+
+template<typename JOINT>
+bool Skeleton::JointIterator<JOINT>::operator == (const JointIterator& it) const {
+	assert(m_joint.m_skeleton == it.m_joint.m_skeleton);
+	return m_joint.m_id == it.m_joint.m_id;
+}
+
+template<typename JOINT>
+bool Skeleton::JointIterator<JOINT>::operator != (const JointIterator& it) const {
+	assert(m_joint.m_skeleton == it.m_joint.m_skeleton);
+	return m_joint.m_id != it.m_joint.m_id;
+}
+
+template<typename JOINT>
+bool Skeleton::JointIterator<JOINT>::operator < (const JointIterator& it) const {
+	assert(m_joint.m_skeleton == it.m_joint.m_skeleton);
+	return m_joint.m_id < it.m_joint.m_id;
+}
+
 }
@@ -0,0 +1,259 @@
+#include "Skinning.h"
+
+#include <cassert>
+#include <algorithm>
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+#include "Simd.h"
+#include "Instrumentation.h"
+
+namespace openanim {
+
+namespace {
+	/// number of vertices deformed by a single task (a multiple of all SIMD widths)
+	static const std::size_t s_chunkSize = 1024;
+
+	/// gathers palette entries (SIZE floats each) of F::width joints
+	template<typename F, std::size_t SIZE>
+	void gather(const float* palette, const int* joints, float (&data)[SIZE][F::width]) {
+		for(unsigned l = 0; l < F::width; ++l) {
+			const float* entry = palette + joints[l] * SIZE;
+			for(std::size_t e = 0; e < SIZE; ++e)
+				data[e][l] = entry[e];
+		}
+	}
+
+	/// stores F::width vectors to an array
+	template<typename F>
+	void storeVectors(const F& x, const F& y, const F& z, Imath::V3f* target) {
+		alignas(32) float data[3][F::width];
+		x.store(data[0]);
+		y.store(data[1]);
+		z.store(data[2]);
+
+		for(unsigned l = 0; l < F::width; ++l)
+			target[l] = Imath::V3f(data[0][l], data[1][l], data[2][l]);
+	}
+
+	template<typename F>
+	void normalizeVectors(F& x, F& y, F& z) {
+		const F invLength = F::set1(1.0f) / sqrt(x*x + y*y + z*z);
+		x = x * invLength;
+		y = y * invLength;
+		z = z * invLength;
+	}
+}
+
+Skinning::Skinning(const Pose& bindPose, const Imath::V3f* positions, const Imath::V3f* normals, std::size_t vertexCount,
+	const int* joints, const float* weights, unsigned influenceCount) : m_palette(bindPose), m_vertexCount(vertexCount), m_influenceCount(influenceCount) {
+
+	assert(influenceCount > 0 && influenceCount <= s_maxInfluences);
+
+	// each array is padded to a multiple of the SIMD width, to keep all influence slots aligned
+	m_stride = (vertexCount + simd::native::width - 1) / simd::native::width * simd::native::width;
+
+	for(unsigned c = 0; c < 3; ++c) {
+		m_positions[c].resize(m_stride, 0.0f);
+		if(normals != NULL)
+			m_normals[c].resize(m_stride, 0.0f);
+	}
+
+	m_joints.resize(m_stride * influenceCount, 0);
+	m_weights.resize(m_stride * influenceCount, 0.0f);
+
+	for(std::size_t v = 0; v < vertexCount; ++v) {
+		for(unsigned c = 0; c < 3; ++c) {
+			m_positions[c][v] = positions[v][c];
+			if(normals != NULL)
+				m_normals[c][v] = normals[v][c];
+		}
+
+		float sum = 0.0f;
+		for(unsigned i = 0; i < influenceCount; ++i)
+			sum += weights[v * influenceCount + i];
+		assert(sum > 0.0f && "each vertex has to be influenced by at least one joint");
+
+		for(unsigned i = 0; i < influenceCount; ++i) {
+			assert(joints[v * influenceCount + i] >= 0 && (std::size_t)joints[v * influenceCount + i] < bindPose.size());
+
+			m_joints[i * m_stride + v] = joints[v * influenceCount + i];
+			m_weights[i * m_stride + v] = weights[v * influenceCount + i] / sum;
+		}
+	}
+}
+
+std::size_t Skinning::vertexCount() const {
+	return m_vertexCount;
+}
+
+unsigned Skinning::influenceCount() const {
+	return m_influenceCount;
+}
+
+bool Skinning::hasNormals() const {
+	return !m_normals[0].empty();
+}
+
+const Palette& Skinning::palette() const {
+	return m_palette;
+}
+
+template<typename F>
+void Skinning::deformLinear(const float* palette, std::size_t vertex, Imath::V3f* positions, Imath::V3f* normals) const {
+	// weighted sum of the skinning matrices
+	F m[Palette::s_matrixSize];
+	for(std::size_t e = 0; e < Palette::s_matrixSize; ++e)
+		m[e] = F::set1(0.0f);
+
+	for(unsigned i = 0; i < m_influenceCount; ++i) {
+		alignas(32) float data[Palette::s_matrixSize][F::width];
+		gather<F>(palette, &m_joints[i * m_stride + vertex], data);
+
+		const F w = F::load(&m_weights[i * m_stride + vertex]);
+		for(std::size_t e = 0; e < Palette::s_matrixSize; ++e)
+			m[e] = m[e] + F::load(data[e]) * w;
+	}
+
+	const F px = F::load(&m_positions[0][vertex]);
+	const F py = F::load(&m_positions[1][vertex]);
+	const F pz = F::load(&m_positions[2][vertex]);
+	storeVectors(
+		m[0] * px + m[1] * py + m[2] * pz + m[3],
+		m[4] * px + m[5] * py + m[6] * pz + m[7],
+		m[8] * px + m[9] * py + m[10] * pz + m[11],
+		positions + vertex);
+
+	if(normals != NULL) {
+		const F nx = F::load(&m_normals[0][vertex]);
+		const F ny = F::load(&m_normals[1][vertex]);
+		const F nz = F::load(&m_normals[2][vertex]);
+
+		F x = m[0] * nx + m[1] * ny + m[2] * nz;
+		F y = m[4] * nx + m[5] * ny + m[6] * nz;
+		F z = m[8] * nx + m[9] * ny + m[10] * nz;
+		normalizeVectors(x, y, z);
+
+		storeVectors(x, y, z, normals + vertex);
+	}
+}
+
+template<typename F>
+void Skinning::deformDualQuaternion(const float* palette, std::size_t vertex, Imath::V3f* positions, Imath::V3f* normals) const {
+	// weighted sum of the skinning dual quaternions (x, y, z, w), all in the hemisphere of the first one
+	F real[4], dual[4], first[4];
+
+	for(unsigned i = 0; i < m_influenceCount; ++i) {
+		alignas(32) float data[Palette::s_dualQuaternionSize][F::width];
+		gather<F>(palette, &m_joints[i * m_stride + vertex], data);
+
+		F w = F::load(&m_weights[i * m_stride + vertex]);
+
+		if(i == 0) {
+			for(unsigned c = 0; c < 4; ++c) {
+				first[c] = F::load(data[c]);
+				real[c] = first[c] * w;
+				dual[c] = F::load(data[c + 4]) * w;
+			}
+		}
+		else {
+			const F d = first[0] * F::load(data[0]) + first[1] * F::load(data[1]) + first[2] * F::load(data[2]) + first[3] * F::load(data[3]);
+			w = simd::flipSign(w, d);
+
+			for(unsigned c = 0; c < 4; ++c) {
+				real[c] = real[c] + F::load(data[c]) * w;
+				dual[c] = dual[c] + F::load(data[c + 4]) * w;
+			}
+		}
+	}
+
+	const F invLength = F::set1(1.0f) / sqrt(real[0]*real[0] + real[1]*real[1] + real[2]*real[2] + real[3]*real[3]);
+	for(unsigned c = 0; c < 4; ++c) {
+		real[c] = real[c] * invLength;
+		dual[c] = dual[c] * invLength;
+	}
+
+	const F two = F::set1(2.0f);
+
+	// p' = p + 2 r.xyz x (r.xyz x p + r.w p) + 2 (r.w d.xyz - d.w r.xyz + r.xyz x d.xyz)
+	const F px = F::load(&m_positions[0][vertex]);
+	const F py = F::load(&m_positions[1][vertex]);
+	const F pz = F::load(&m_positions[2][vertex]);
+
+	const F tx = two * (real[3] * dual[0] - dual[3] * real[0] + real[1] * dual[2] - real[2] * dual[1]);
+	const F ty = two * (real[3] * dual[1] - dual[3] * real[1] + real[2] * dual[0] - real[0] * dual[2]);
+	const F tz = two * (real[3] * dual[2] - dual[3] * real[2] + real[0] * dual[1] - real[1] * dual[0]);
+
+	F cx = real[1] * pz - real[2] * py + real[3] * px;
+	F cy = real[2] * px - real[0] * pz + real[3] * py;
+	F cz = real[0] * py - real[1] * px + real[3] * pz;
+
+	storeVectors(
+		px + two * (real[1] * cz - real[2] * cy) + tx,
+		py + two * (real[2] * cx - real[0] * cz) + ty,
+		pz + two * (real[0] * cy - real[1] * cx) + tz,
+		positions + vertex);
+
+	if(normals != NULL) {
+		const F nx = F::load(&m_normals[0][vertex]);
+		const F ny = F::load(&m_normals[1][vertex]);
+		const F nz = F::load(&m_normals[2][vertex]);
+
+		cx = real[1] * nz - real[2] * ny + real[3] * nx;
+		cy = real[2] * nx - real[0] * nz + real[3] * ny;
+		cz = real[0] * ny - real[1] * nx + real[3] * nz;
+
+		storeVectors(
+			nx + two * (real[1] * cz - real[2] * cy),
+			ny + two * (real[2] * cx - real[0] * cz),
+			nz + two * (real[0] * cy - real[1] * cx),
+			normals + vertex);
+	}
+}
+
+void Skinning::deform(const Pose& worldPose, Imath::V3f* positions, Imath::V3f* normals, Method method) const {
+	OPENANIM_TIMER("skinning/deform");
+
+	assert(worldPose.isCompatibleWith(m_palette.inverseBindPose()));
+
+	if(!hasNormals())
+		normals = NULL;
+
+	// the palette of the current pose
+	Floats palette;
+	if(method == Linear) {
+		palette.resize(m_palette.size() * Palette::s_matrixSize);
+		m_palette.writeMatrices(worldPose, palette.data());
+	}
+	else {
+		palette.resize(m_palette.size() * Palette::s_dualQuaternionSize);
+		m_palette.writeDualQuaternions(worldPose, palette.data());
+	}
+
+	// chunks of vertices in parallel, SIMD blocks within each chunk (chunks start at multiples of
+	// the SIMD width, keeping the loads aligned)
+	const std::size_t chunkCount = (m_vertexCount + s_chunkSize - 1) / s_chunkSize;
+	tbb::parallel_for(tbb::blocked_range<std::size_t>(0, chunkCount), [&](const tbb::blocked_range<std::size_t>& range) {
+		for(std::size_t chunk = range.begin(); chunk != range.end(); ++chunk) {
+			const std::size_t begin = chunk * s_chunkSize;
+			const std::size_t end = std::min(begin + s_chunkSize, m_vertexCount);
+
+			std::size_t v = begin;
+			if(method == Linear) {
+				for(; v + simd::native::width <= end; v += simd::native::width)
+					deformLinear<simd::native>(palette.data(), v, positions, normals);
+				for(; v < end; ++v)
+					deformLinear<simd::float1>(palette.data(), v, positions, normals);
+			}
+			else {
+				for(; v + simd::native::width <= end; v += simd::native::width)
+					deformDualQuaternion<simd::native>(palette.data(), v, positions, normals);
+				for(; v < end; ++v)
+					deformDualQuaternion<simd::float1>(palette.data(), v, positions, normals);
+			}
+		}
+	});
+}
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include <ImathVec.h>
+
+#include "Pose.h"
+#include "Palette.h"
+#include "AlignedAllocator.h"
+
+namespace openanim {
+
+/// CPU mesh skinning. Skinning holds the bind-space vertex data of a mesh (positions, optionally
+/// normals, and a fixed number of joint influences per vertex), stored as aligned structure of arrays,
+/// and deforms it by a world-space pose of the bind pose's hierarchy. Vertices are processed in SIMD
+/// blocks, with chunks of vertices deformed in parallel.
+class Skinning {
+	public:
+		enum Method {
+			/// linear blend skinning (blended skinning matrices)
+			Linear,
+			/// dual quaternion skinning (blended skinning dual quaternions)
+			DualQuaternion
+		};
+
+		/// maximum number of influences per vertex
+		static const unsigned s_maxInfluences = 8;
+
+		/// creates skinning data from a world-space bind pose and a mesh. The normals can be NULL. The
+		/// influences are stored per vertex (vertexCount * influenceCount joint indices and weights);
+		/// weights of each vertex are normalized.
+		Skinning(const Pose& bindPose, const Imath::V3f* positions, const Imath::V3f* normals, std::size_t vertexCount,
+			const int* joints, const float* weights, unsigned influenceCount);
+
+		std::size_t vertexCount() const;
+		unsigned influenceCount() const;
+		bool hasNormals() const;
+
+		const Palette& palette() const;
+
+		/// deforms the mesh by a world-space pose. Results are written to positions and normals (both
+		/// vertexCount() elements; normals can be NULL, and are ignored if the mesh has no normals).
+		void deform(const Pose& worldPose, Imath::V3f* positions, Imath::V3f* normals, Method method = Linear) const;
+
+	protected:
+	private:
+		typedef std::vector<float, AlignedAllocator<float>> Floats;
+
+		template<typename F>
+		void deformLinear(const float* palette, std::size_t vertex, Imath::V3f* positions, Imath::V3f* normals) const;
+		template<typename F>
+		void deformDualQuaternion(const float* palette, std::size_t vertex, Imath::V3f* positions, Imath::V3f* normals) const;
+
+		Palette m_palette;
+
+		std::size_t m_vertexCount, m_stride;
+		unsigned m_influenceCount;
+
+		// vertex data, each component in a separate array
+		Floats m_positions[3], m_normals[3];
+
+		// influences, m_stride elements per influence slot (all first influences, then all second...)
+		std::vector<int> m_joints;
+		Floats m_weights;
+};
+
+}
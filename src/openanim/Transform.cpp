@@ -24,6 +24,12 @@ const Imath::M44f Transform::toMatrix44() const {
 	return result;
 }
 
+const Transform Transform::inverse() const {
+	// for a unit quaternion, the conjugate is its inverse
+	const Imath::Quatf inv = ~rotation;
+	return Transform(inv, (-translation) * inv);
+}
+
 const Transform Transform::operator * (const Transform& t) const {
 	return Transform(
 		// what a pretty inconsistency in OpenEXR
@@ -40,6 +46,47 @@ Transform& Transform::operator *= (const Transform& t) {
 	return *this;
 }
 
+////////
+
+TransformRef::TransformRef(Imath::V3f& tr, Imath::Quatf& rot) : translation(tr), rotation(rot) {
+}
+
+TransformRef& TransformRef::operator = (const Transform& t) {
+	translation = t.translation;
+	rotation = t.rotation;
+
+	return *this;
+}
+
+TransformRef& TransformRef::operator = (const TransformRef& t) {
+	translation = t.translation;
+	rotation = t.rotation;
+
+	return *this;
+}
+
+TransformRef::operator Transform() const {
+	return Transform(rotation, translation);
+}
+
+const Imath::M44f TransformRef::toMatrix44() const {
+	return Transform(*this).toMatrix44();
+}
+
+const Transform TransformRef::operator * (const Transform& t) const {
+	return Transform(*this) * t;
+}
+
+TransformRef& TransformRef::operator *= (const Transform& t) {
+	// what a pretty inconsistency in OpenEXR
+	rotation = t.rotation * rotation;
+	translation = translation*t.rotation + t.translation;
+
+	return *this;
+}
+
+////////
+
 std::ostream& operator << (std::ostream& out, const Transform& tr) {
 	out << "(" << tr.rotation << "), (" << tr.translation << ")";
 
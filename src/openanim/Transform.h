@@ -21,10 +21,33 @@ struct Transform {
 
 	const Imath::M44f toMatrix44() const;
 
+	/// inverse transformation (assumes the rotation quaternion is normalized)
+	const Transform inverse() const;
+
 	const Transform operator * (const Transform& t) const;
 	Transform& operator *= (const Transform& t);
 };
 
+/// a reference to a single transformation stored in a structure-of-arrays container (see Pose),
+/// with translation and rotation held in separate arrays. Behaves like a Transform reference -
+/// assignment writes through to the referenced storage.
+struct TransformRef {
+	Imath::V3f& translation;
+	Imath::Quatf& rotation;
+
+	TransformRef(Imath::V3f& tr, Imath::Quatf& rot);
+
+	TransformRef& operator = (const Transform& t);
+	TransformRef& operator = (const TransformRef& t);
+
+	operator Transform() const;
+
+	const Imath::M44f toMatrix44() const;
+
+	const Transform operator * (const Transform& t) const;
+	TransformRef& operator *= (const Transform& t);
+};
+
 std::ostream& operator << (std::ostream& out, const Transform& tr);
 
 };
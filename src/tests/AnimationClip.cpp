@@ -0,0 +1,203 @@
+#include "openanim/Skeleton.h"
+#include "openanim/AnimationClip.h"
+#include "openanim/ClipBuilder.h"
+#include "openanim/ClipSampler.h"
+#include "openanim/Quantization.h"
+
+#include "Common.h"
+
+#include <ImathEuler.h>
+
+#include <boost/test/unit_test.hpp>
+
+using std::cout;
+using std::endl;
+
+using openanim::Transform;
+using tests::difference;
+
+namespace {
+	static const float EPS = 1e-3f;
+
+	/// a skeleton with an animated root, a rotating child, a static child and an identity child
+	openanim::Skeleton makeSkeleton() {
+		openanim::Skeleton s;
+		s.addRoot("root", Transform());
+		s.addChild(s[0], Transform(Imath::V3f(0,1,0)), "animated");
+		s.addChild(s[0], Transform(Imath::Eulerf(0.3,0.2,0.1).toQuat(), Imath::V3f(1,0,0)), "static");
+		s.addChild(s[1], Transform(), "identity");
+
+		return s;
+	}
+
+	Transform animatedRoot(unsigned frame) {
+		return Transform(Imath::Eulerf(0, (float)frame * 0.1f, 0).toQuat(), Imath::V3f(std::sin((float)frame * 0.2f), 0, (float)frame * 0.5f));
+	}
+
+	Transform animatedChild(unsigned frame) {
+		return Transform(Imath::Eulerf(std::cos((float)frame * 0.3f), 0, 0).toQuat(), Imath::V3f(0,1,0));
+	}
+
+	std::vector<openanim::Pose> makeFrames(const openanim::Skeleton& s, unsigned count) {
+		std::vector<openanim::Pose> frames;
+		for(unsigned f = 0; f < count; ++f) {
+			openanim::Pose pose = s.pose();
+			pose[0] = animatedRoot(f);
+			pose[1] = animatedChild(f);
+			frames.push_back(pose);
+		}
+
+		return frames;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(quantization_rotation) {
+	for(unsigned a = 0; a < 1000; ++a) {
+		Imath::Quatf q(
+			(float)(rand() % 2000 - 1000),
+			(float)(rand() % 2000 - 1000),
+			(float)(rand() % 2000 - 1000),
+			(float)(rand() % 2000 - 1000));
+		if(q.length() == 0.0f)
+			continue;
+		q.normalize();
+
+		std::uint16_t data[3];
+		openanim::quantization::encodeRotation(q, data);
+		const Imath::Quatf result = openanim::quantization::decodeRotation(data);
+
+		BOOST_REQUIRE_SMALL(difference(Transform(q), Transform(result)), EPS);
+	}
+
+	// identity is represented exactly
+	std::uint16_t data[3];
+	openanim::quantization::encodeRotation(Imath::Quatf(), data);
+	BOOST_CHECK_EQUAL(openanim::quantization::decodeRotation(data), Imath::Quatf());
+}
+
+BOOST_AUTO_TEST_CASE(clip_encoding) {
+	const openanim::Skeleton s = makeSkeleton();
+	const std::vector<openanim::Pose> frames = makeFrames(s, 100);
+
+	openanim::ClipBuilder builder(s.pose().sharedHierarchy(), 30.0f);
+	for(auto& f : frames)
+		builder.addFrame(f);
+
+	const openanim::AnimationClip clip = builder.build();
+	BOOST_CHECK_EQUAL(clip.frameCount(), 100u);
+	BOOST_CHECK_CLOSE(clip.duration(), 99.0f / 30.0f, 1e-4f);
+
+	BOOST_CHECK_EQUAL(clip.rotationTrack(0).encoding, openanim::AnimationClip::Quantized);
+	BOOST_CHECK_EQUAL(clip.translationTrack(0).encoding, openanim::AnimationClip::Quantized);
+	BOOST_CHECK_EQUAL(clip.rotationTrack(1).encoding, openanim::AnimationClip::Quantized);
+	BOOST_CHECK_EQUAL(clip.translationTrack(1).encoding, openanim::AnimationClip::Constant);
+	BOOST_CHECK_EQUAL(clip.rotationTrack(2).encoding, openanim::AnimationClip::Constant);
+	BOOST_CHECK_EQUAL(clip.translationTrack(2).encoding, openanim::AnimationClip::Constant);
+	BOOST_CHECK_EQUAL(clip.rotationTrack(3).encoding, openanim::AnimationClip::Identity);
+	BOOST_CHECK_EQUAL(clip.translationTrack(3).encoding, openanim::AnimationClip::Identity);
+
+	// much smaller than the raw data
+	BOOST_CHECK(clip.dataSize() < frames.size() * s.size() * sizeof(Transform) / 3);
+
+	// sampling on frames
+	openanim::Pose pose(s.pose().sharedHierarchy());
+	for(unsigned f = 0; f < frames.size(); ++f) {
+		clip.sample((float)f / 30.0f, pose);
+
+		for(std::size_t ji = 0; ji < s.size(); ++ji)
+			BOOST_REQUIRE_SMALL(difference(pose[ji], frames[f][ji]), EPS);
+	}
+
+	// sampling between frames interpolates
+	clip.sample(10.5f / 30.0f, pose);
+	BOOST_CHECK_SMALL(difference(pose[0], Transform(
+		openanim::quantization::nlerp(frames[10][0].rotation, frames[11][0].rotation, 0.5f),
+		(frames[10][0].translation + frames[11][0].translation) / 2.0f)), EPS);
+
+	// and out of range sampling clamps
+	clip.sample(-1.0f, pose);
+	BOOST_CHECK_SMALL(difference(pose[0], frames[0][0]), EPS);
+	clip.sample(100.0f, pose);
+	BOOST_CHECK_SMALL(difference(pose[0], frames[99][0]), EPS);
+}
+
+BOOST_AUTO_TEST_CASE(clip_key_reduction) {
+	const openanim::Skeleton s = makeSkeleton();
+	const std::vector<openanim::Pose> frames = makeFrames(s, 200);
+
+	openanim::ClipBuilder builder(s.pose().sharedHierarchy(), 30.0f);
+	for(auto& f : frames)
+		builder.addFrame(f);
+
+	const openanim::AnimationClip full = builder.build();
+	const openanim::AnimationClip reduced = builder.build(0.01f, 0.01f);
+
+	BOOST_CHECK(reduced.keyCount() < full.keyCount());
+	BOOST_CHECK(reduced.dataSize() < full.dataSize());
+
+	// root rotation is a rotation around a single axis with constant speed, which needs only a few keys
+	const openanim::AnimationClip::Track& track = reduced.rotationTrack(0);
+	BOOST_CHECK(track.keys_end - track.keys_begin < 20);
+
+	// all frames reconstructed within the tolerance (+ quantization error)
+	openanim::Pose pose(s.pose().sharedHierarchy());
+	for(unsigned f = 0; f < frames.size(); ++f) {
+		reduced.sample((float)f / 30.0f, pose);
+
+		for(std::size_t ji = 0; ji < s.size(); ++ji) {
+			BOOST_REQUIRE_SMALL((pose[ji].translation - frames[f][ji].translation).length(), 0.01f + EPS);
+			BOOST_REQUIRE_SMALL(difference(Transform(pose[ji].rotation), Transform(frames[f][ji].rotation)), 0.04f + EPS);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(clip_sampler) {
+	const openanim::Skeleton s = makeSkeleton();
+	const std::vector<openanim::Pose> frames = makeFrames(s, 300);
+
+	openanim::ClipBuilder builder(s.pose().sharedHierarchy(), 30.0f);
+	for(auto& f : frames)
+		builder.addFrame(f);
+
+	// sparse keys need the cursor search, dense keys are indexed directly
+	for(float tolerance : {0.0f, 0.01f}) {
+		const openanim::AnimationClip clip = builder.build(tolerance, tolerance);
+
+		openanim::ClipSampler sampler(clip);
+		openanim::Pose expected(s.pose().sharedHierarchy()), pose(s.pose().sharedHierarchy());
+
+		std::vector<float> times;
+		// forward playback
+		for(float t = 0.0f; t < clip.duration(); t += 1.0f / 60.0f)
+			times.push_back(t);
+		// reverse playback
+		for(float t = clip.duration(); t > 0.0f; t -= 1.0f / 45.0f)
+			times.push_back(t);
+		// scrubbing
+		for(unsigned a = 0; a < 100; ++a)
+			times.push_back((float)(rand() % 1000) / 1000.0f * clip.duration());
+
+		for(auto& t : times) {
+			sampler.sample(t, pose);
+			clip.sample(t, expected);
+
+			for(std::size_t ji = 0; ji < s.size(); ++ji)
+				BOOST_REQUIRE_SMALL(difference(pose[ji], expected[ji]), 1e-5f);
+		}
+
+		// looping wraps the time around
+		sampler.setLooping(true);
+		for(float t = 0.0f; t < clip.duration() * 3.0f; t += 1.0f / 24.0f) {
+			sampler.sample(t, pose);
+			clip.sample(std::fmod(t * 30.0f, 299.0f) / 30.0f, expected);
+
+			// the wrapped time is computed slightly differently
+			for(std::size_t ji = 0; ji < s.size(); ++ji)
+				BOOST_REQUIRE_SMALL(difference(pose[ji], expected[ji]), 1e-4f);
+		}
+
+		sampler.sample(-1.0f / 30.0f, pose);
+		clip.sample(298.0f / 30.0f, expected);
+		BOOST_CHECK_SMALL(difference(pose[0], expected[0]), 1e-4f);
+	}
+}
@@ -0,0 +1,255 @@
+#include "openanim/Loaders/Asf.h"
+
+#include <cmath>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+using std::cout;
+using std::endl;
+
+using openanim::Transform;
+
+namespace {
+	const std::string s_skeleton =
+		"# a test skeleton\n"
+		":version 1.10\n"
+		":name VICON\n"
+		":units\n"
+		"  mass 1.0\n"
+		"  length 0.45\n"
+		"  angle deg\n"
+		":documentation\n"
+		"   three bones\n"
+		":root\n"
+		"   order TX TY TZ RX RY RZ\n"
+		"   axis XYZ\n"
+		"   position 0 0 0\n"
+		"   orientation 0 0 0\n"
+		":bonedata\n"
+		"  begin\n"
+		"     id 1\n"
+		"     name upper\n"
+		"     direction 0 1 0\n"
+		"     length 2\n"
+		"     axis 0 0 90  XYZ\n"
+		"     dof rx ry rz\n"
+		"     limits (-160.0 20.0)\n"
+		"            (-70.0 70.0)\n"
+		"            (-60.0 70.0)\n"
+		"  end\n"
+		"  begin\n"
+		"     id 2\n"
+		"     name lower\n"
+		"     direction 1 0 0\n"
+		"     length 3\n"
+		"     axis 0 0 0 XYZ\n"
+		"     dof rx\n"
+		"     limits (-10.0 10.0)\n"
+		"  end\n"
+		"  begin\n"
+		"     id 3\n"
+		"     name side\n"
+		"     direction 0 0 1\n"
+		"     length 1\n"
+		"     axis 0 0 0 XYZ\n"
+		"  end\n"
+		":hierarchy\n"
+		"  begin\n"
+		"    root upper side\n"
+		"    upper lower\n"
+		"  end\n";
+
+	const std::string s_header =
+		"#!OML:ASF test.asf\n"
+		":FULLY-SPECIFIED\n"
+		":DEGREES\n";
+
+	/// world transformation of a joint of a local pose
+	Transform world(const openanim::Pose& pose, int joint) {
+		Transform result = pose[joint];
+		for(int p = pose.hierarchy()[joint].parent; p >= 0; p = pose.hierarchy()[p].parent)
+			result = result * pose[p];
+
+		return result;
+	}
+
+	float distance(const Imath::V3f& v1, const Imath::V3f& v2) {
+		return (v1 - v2).length();
+	}
+
+	void parseSkeleton(const std::string& text) {
+		const openanim::Asf asf(text.c_str(), text.size());
+	}
+
+	void parseMotion(const openanim::Asf& asf, const std::string& text) {
+		asf.loadMotion(text.c_str(), text.size());
+	}
+}
+
+BOOST_AUTO_TEST_CASE(asf_skeleton) {
+	const openanim::Asf asf(s_skeleton.c_str(), s_skeleton.size());
+	const openanim::Hierarchy& h = asf.hierarchy();
+
+	// bones and the tips of leaf bones
+	BOOST_REQUIRE_EQUAL(h.size(), 6u);
+	const int root = h.find("root");
+	const int upper = h.find("upper");
+	const int lower = h.find("lower");
+	const int side = h.find("side");
+	const int lowerEnd = h.find("lower_end");
+	const int sideEnd = h.find("side_end");
+
+	BOOST_REQUIRE(root >= 0 && upper >= 0 && lower >= 0 && side >= 0 && lowerEnd >= 0 && sideEnd >= 0);
+	BOOST_CHECK_EQUAL(h[root].parent, -1);
+	BOOST_CHECK_EQUAL(h[upper].parent, root);
+	BOOST_CHECK_EQUAL(h[side].parent, root);
+	BOOST_CHECK_EQUAL(h[lower].parent, upper);
+	BOOST_CHECK_EQUAL(h[lowerEnd].parent, lower);
+	BOOST_CHECK_EQUAL(h[sideEnd].parent, side);
+	BOOST_CHECK_EQUAL(h.find("upper_end"), -1);
+
+	// each joint starts at the tip of its parent bone
+	const openanim::Pose& pose = asf.bindPose();
+	BOOST_CHECK_SMALL(distance(world(pose, upper).translation, Imath::V3f(0, 0, 0)), 1e-5f);
+	BOOST_CHECK_SMALL(distance(world(pose, lower).translation, Imath::V3f(0, 2, 0)), 1e-5f);
+	BOOST_CHECK_SMALL(distance(world(pose, lowerEnd).translation, Imath::V3f(3, 2, 0)), 1e-5f);
+	BOOST_CHECK_SMALL(distance(world(pose, sideEnd).translation, Imath::V3f(0, 0, 1)), 1e-5f);
+
+	// the frame of each joint is the axis of its bone
+	BOOST_CHECK_SMALL(distance(Imath::V3f(1, 0, 0) * world(pose, upper).rotation, Imath::V3f(0, 1, 0)), 1e-5f);
+	BOOST_CHECK_SMALL(distance(Imath::V3f(1, 0, 0) * world(pose, lower).rotation, Imath::V3f(1, 0, 0)), 1e-5f);
+}
+
+BOOST_AUTO_TEST_CASE(asf_motion) {
+	const openanim::Asf asf(s_skeleton.c_str(), s_skeleton.size());
+	const openanim::Hierarchy& h = asf.hierarchy();
+
+	const std::string motion = s_header +
+		"1\n"
+		"root 1 2 3 0 0 0\n"
+		"upper 0 0 0\n"
+		"lower 0\n"
+		"2\n"
+		"lower 0\n"
+		"upper 90 0 0\n"
+		"root 1 2 3 0 0 90\n";
+
+	const openanim::AnimationClip clip = asf.loadMotion(motion.c_str(), motion.size());
+	BOOST_CHECK(clip.sharedHierarchy() == asf.sharedHierarchy());
+	BOOST_CHECK_EQUAL(clip.frameCount(), 2u);
+	BOOST_CHECK_CLOSE(clip.fps(), 120.0f, 1e-4f);
+
+	openanim::Pose pose(asf.sharedHierarchy());
+
+	// the rest pose, moved by the root
+	clip.sample(0.0f, pose);
+	BOOST_CHECK_SMALL(distance(world(pose, h.find("lower_end")).translation, Imath::V3f(4, 4, 3)), 1e-3f);
+	BOOST_CHECK_SMALL(distance(world(pose, h.find("side_end")).translation, Imath::V3f(1, 2, 4)), 1e-3f);
+
+	// the root rotates around the world z axis, upper around its own x axis (its direction)
+	clip.sample(clip.duration(), pose);
+	BOOST_CHECK_SMALL(distance(world(pose, h.find("lower")).translation, Imath::V3f(-1, 2, 3)), 1e-3f);
+	BOOST_CHECK_SMALL(distance(world(pose, h.find("lower_end")).translation, Imath::V3f(-1, 2, 0)), 1e-3f);
+	BOOST_CHECK_SMALL(distance(world(pose, h.find("side_end")).translation, Imath::V3f(1, 2, 4)), 1e-3f);
+
+	// radians override the units of the skeleton, the frame rate is explicit
+	const std::string radians =
+		":RADIANS\n"
+		"1\n"
+		"root 0 0 0 0 0 1.5707963\n";
+	const openanim::AnimationClip clip2 = asf.loadMotion(radians.c_str(), radians.size(), 30.0f);
+	BOOST_CHECK_EQUAL(clip2.frameCount(), 1u);
+	BOOST_CHECK_CLOSE(clip2.fps(), 30.0f, 1e-4f);
+
+	clip2.sample(0.0f, pose);
+	BOOST_CHECK_SMALL(distance(world(pose, h.find("lower")).translation, Imath::V3f(-2, 0, 0)), 1e-3f);
+}
+
+BOOST_AUTO_TEST_CASE(asf_large_motion) {
+	const openanim::Asf asf(s_skeleton.c_str(), s_skeleton.size());
+	const openanim::Hierarchy& h = asf.hierarchy();
+
+	// large enough to be split into many chunks
+	const unsigned frameCount = 30000;
+
+	std::stringstream text;
+	text << s_header;
+	for(unsigned f = 0; f < frameCount; ++f) {
+		text << (f + 1) << endl;
+		text << "root " << (float)f * 0.01f << " 0.000000 0.000000 0.000000 0.000000 0.000000" << endl;
+		text << "upper 0 0 0" << endl;
+		text << "lower " << (float)(f % 90) << endl;
+	}
+
+	const boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+	{
+		std::ofstream file(path.string().c_str(), std::ios::binary);
+		file << text.str();
+	}
+
+	const openanim::AnimationClip clip = asf.loadMotion(path.string());
+	boost::filesystem::remove(path);
+
+	BOOST_REQUIRE_EQUAL(clip.frameCount(), frameCount);
+
+	openanim::Pose pose(asf.sharedHierarchy());
+	const int lower = h.find("lower");
+	for(unsigned f = 0; f < frameCount; f += 331) {
+		clip.sample((float)f / clip.fps(), pose);
+
+		BOOST_CHECK_SMALL(distance(pose[h.find("root")].translation, Imath::V3f((float)f * 0.01f, 0, 0)), 1e-2f);
+
+		// lower rotates around its direction, which moves its y axis
+		const float angle = (float)(f % 90) * (float)M_PI / 180.0f;
+		BOOST_CHECK_SMALL(distance(Imath::V3f(0, 1, 0) * world(pose, lower).rotation, Imath::V3f(0, std::cos(angle), std::sin(angle))), 1e-2f);
+	}
+
+	// an error deep in the file reports its line
+	std::string invalid = text.str();
+	const std::size_t position = invalid.find("lower", invalid.size() / 2);
+	invalid.replace(position, 5, "wrong");
+	const std::size_t line = 1 + std::count(invalid.begin(), invalid.begin() + position, '\n');
+
+	try {
+		parseMotion(asf, invalid);
+		BOOST_ERROR("an invalid file was parsed");
+	}
+	catch(const std::runtime_error& e) {
+		BOOST_CHECK(std::string(e.what()).find("line " + std::to_string(line) + " ") != std::string::npos);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(asf_errors) {
+	const openanim::Asf asf(s_skeleton.c_str(), s_skeleton.size());
+
+	BOOST_CHECK_NO_THROW(parseMotion(asf, s_header + "1\nroot 0 0 0 0 0 0\n2\nlower 1\n"));
+
+	// invalid motions
+	BOOST_CHECK_THROW(parseMotion(asf, s_header), std::runtime_error);
+	BOOST_CHECK_THROW(parseMotion(asf, s_header + "root 0 0 0 0 0 0\n"), std::runtime_error);
+	BOOST_CHECK_THROW(parseMotion(asf, s_header + "1\nhead 0 0 0\n"), std::runtime_error);
+	BOOST_CHECK_THROW(parseMotion(asf, s_header + "1\nroot 0 0 0 0 0 x\n"), std::runtime_error);
+	BOOST_CHECK_THROW(parseMotion(asf, s_header + "1\nroot 0 0 0 0 0 0\n3\nlower 1\n"), std::runtime_error);
+	BOOST_CHECK_THROW(asf.loadMotion("/nonexistent/file.amc"), std::runtime_error);
+
+	// invalid skeletons
+	auto replace = [](const std::string& from, const std::string& to) {
+		std::string result = s_skeleton;
+		result.replace(result.find(from), from.size(), to);
+		return result;
+	};
+
+	BOOST_CHECK_THROW(parseSkeleton(replace("dof rx ry rz", "dof rx rw")), std::runtime_error);
+	BOOST_CHECK_THROW(parseSkeleton(replace("root upper side", "root upper")), std::runtime_error);
+	BOOST_CHECK_THROW(parseSkeleton(replace("upper lower", "upper lower missing")), std::runtime_error);
+	BOOST_CHECK_THROW(parseSkeleton(replace("upper lower", "upper lower side")), std::runtime_error);
+	BOOST_CHECK_THROW(parseSkeleton(replace("root upper side\n    upper lower", "root side\n    upper lower\n    lower upper")), std::runtime_error);
+	BOOST_CHECK_THROW(parseSkeleton(replace("axis 0 0 0 XYZ", "axis 0 0 0 XWZ")), std::runtime_error);
+	BOOST_CHECK_THROW(parseSkeleton(replace("name side", "name upper")), std::runtime_error);
+	BOOST_CHECK_THROW(openanim::Asf("/nonexistent/file.asf"), std::runtime_error);
+}
@@ -0,0 +1,309 @@
+#include "openanim/Skeleton.h"
+#include "openanim/ClipBuilder.h"
+#include "openanim/Asset.h"
+
+#include "Common.h"
+
+#include <sstream>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <limits>
+
+#include <ImathEuler.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+using std::cout;
+using std::endl;
+
+using openanim::Transform;
+using tests::randomSkeleton;
+using tests::makeClip;
+using tests::equal;
+
+namespace {
+	/// reads a value of an asset image at a byte offset
+	template<typename T, typename DATA>
+	T read(const DATA& data, std::size_t offset) {
+		T result;
+		std::memcpy(&result, &data[offset], sizeof(T));
+		return result;
+	}
+
+	/// overwrites a value of an asset image at a byte offset
+	template<typename T, typename DATA>
+	void patch(DATA& data, std::size_t offset, T value) {
+		std::memcpy(&data[offset], &value, sizeof(T));
+	}
+
+	/// checks that an asset holds the same data as the original skeleton and clips
+	void checkAsset(const openanim::Asset& asset, const openanim::Skeleton& s, const std::vector<openanim::AnimationClip>& clips) {
+		BOOST_REQUIRE_EQUAL(asset.hierarchy().size(), s.size());
+		for(std::size_t ji = 0; ji < s.size(); ++ji) {
+			BOOST_CHECK_EQUAL(asset.hierarchy().name(ji), s[ji].name());
+			BOOST_CHECK_EQUAL(asset.hierarchy()[ji].parent, s.pose().hierarchy()[ji].parent);
+			BOOST_CHECK_EQUAL(asset.hierarchy().find(s[ji].name()), (int)ji);
+		}
+		BOOST_CHECK(equal(asset.bindPose(), s.pose()));
+
+		BOOST_REQUIRE_EQUAL(asset.clipCount(), clips.size());
+		for(std::size_t c = 0; c < clips.size(); ++c) {
+			const openanim::AnimationClip& clip = asset.clip(c);
+			BOOST_CHECK_EQUAL(clip.sharedHierarchy(), asset.sharedHierarchy());
+			BOOST_CHECK_EQUAL(clip.frameCount(), clips[c].frameCount());
+			BOOST_CHECK_EQUAL(clip.keyCount(), clips[c].keyCount());
+
+			openanim::Pose p1(asset.sharedHierarchy()), p2(s.pose().sharedHierarchy());
+			for(float t = 0.0f; t < clip.duration(); t += 0.13f) {
+				clip.sample(t, p1);
+				clips[c].sample(t, p2);
+				BOOST_REQUIRE(equal(p1, p2));
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(asset_roundtrip) {
+	const openanim::Skeleton s = randomSkeleton(23);
+
+	std::vector<openanim::AnimationClip> clips;
+	clips.push_back(makeClip(s.pose().sharedHierarchy(), 0.1f));
+	clips.push_back(makeClip(s.pose().sharedHierarchy(), 0.0f));
+	clips.push_back(openanim::ClipBuilder(s.pose().sharedHierarchy(), 30.0f).build());
+
+	const openanim::AnimationClip* clipPointers[] = {&clips[0], &clips[1], &clips[2]};
+
+	std::stringstream stream;
+	openanim::Asset::write(stream, s.pose(), clipPointers, clips.size());
+	const std::string image = stream.str();
+
+	// in-memory image
+	{
+		std::vector<char, openanim::AlignedAllocator<char>> data(image.begin(), image.end());
+		const openanim::Asset asset(data.data(), data.size());
+		checkAsset(asset, s, clips);
+	}
+
+	// memory-mapped file; clips copied from the asset keep the mapping alive
+	const boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+	{
+		std::ofstream file(path.string().c_str(), std::ios::binary);
+		openanim::Asset::write(file, s.pose(), clipPointers, clips.size());
+	}
+
+	openanim::AnimationClip copy;
+	{
+		const openanim::Asset asset(path.string());
+		checkAsset(asset, s, clips);
+
+		copy = asset.clip(0);
+	}
+	boost::filesystem::remove(path);
+
+	openanim::Pose p1(copy.sharedHierarchy()), p2(s.pose().sharedHierarchy());
+	copy.sample(0.5f, p1);
+	clips[0].sample(0.5f, p2);
+	BOOST_CHECK(equal(p1, p2));
+}
+
+BOOST_AUTO_TEST_CASE(asset_validation) {
+	const openanim::Skeleton s = randomSkeleton(5);
+	const openanim::AnimationClip clip = makeClip(s.pose().sharedHierarchy(), 0.1f);
+	const openanim::AnimationClip* clips[] = {&clip};
+
+	std::stringstream stream;
+	openanim::Asset::write(stream, s.pose(), clips, 1);
+	const std::string image = stream.str();
+
+	typedef std::vector<char, openanim::AlignedAllocator<char>> Data;
+
+	// a valid image
+	{
+		const Data data(image.begin(), image.end());
+		BOOST_CHECK_NO_THROW(openanim::Asset(data.data(), data.size()));
+	}
+
+	// wrong magic number
+	{
+		Data data(image.begin(), image.end());
+		data[0] = 'x';
+		BOOST_CHECK_THROW(openanim::Asset(data.data(), data.size()), std::runtime_error);
+	}
+
+	// truncated
+	{
+		const Data data(image.begin(), image.end() - 10);
+		BOOST_CHECK_THROW(openanim::Asset(data.data(), data.size()), std::runtime_error);
+	}
+	{
+		const Data data(image.begin(), image.begin() + 10);
+		BOOST_CHECK_THROW(openanim::Asset(data.data(), data.size()), std::runtime_error);
+	}
+
+	// a different version
+	{
+		Data data(image.begin(), image.end());
+		++data[8];
+		BOOST_CHECK_THROW(openanim::Asset(data.data(), data.size()), std::runtime_error);
+	}
+
+	// section offsets of the header (items, index and clips), the first track of the first clip
+	const std::size_t items = read<std::uint64_t>(image, 48);
+	const std::size_t index = read<std::uint64_t>(image, 64);
+	const std::size_t indexSize = read<std::uint32_t>(image, 32);
+	const std::size_t tracks = read<std::uint64_t>(image, read<std::uint64_t>(image, 88) + 16);
+
+	BOOST_REQUIRE_EQUAL(read<std::int32_t>(image, items + 16 + 4), 0);
+	BOOST_REQUIRE(indexSize >= s.pose().hierarchy().size() * 2 && (indexSize & (indexSize - 1)) == 0);
+	BOOST_REQUIRE(read<std::uint32_t>(image, tracks) <= openanim::AnimationClip::Quantized);
+
+	// invalid parents - below -1, and a second root
+	{
+		Data data(image.begin(), image.end());
+		patch<std::int32_t>(data, items + 16 + 4, -5);
+		BOOST_CHECK_THROW(openanim::Asset(data.data(), data.size()), std::runtime_error);
+	}
+	{
+		Data data(image.begin(), image.end());
+		patch<std::int32_t>(data, items + 16 + 4, -1);
+		BOOST_CHECK_THROW(openanim::Asset(data.data(), data.size()), std::runtime_error);
+	}
+
+	// an index slot referring to a non-existing item
+	{
+		Data data(image.begin(), image.end());
+		patch<std::int32_t>(data, index + 4, 1000);
+		BOOST_CHECK_THROW(openanim::Asset(data.data(), data.size()), std::runtime_error);
+	}
+
+	// an index without an empty slot
+	{
+		Data data(image.begin(), image.end());
+		for(std::size_t i = 0; i < indexSize; ++i)
+			patch<std::int32_t>(data, index + i * 8 + 4, 0);
+		BOOST_CHECK_THROW(openanim::Asset(data.data(), data.size()), std::runtime_error);
+	}
+
+	// a track with an unknown encoding, and with keys out of range
+	{
+		Data data(image.begin(), image.end());
+		patch<std::uint32_t>(data, tracks, 7);
+		BOOST_CHECK_THROW(openanim::Asset(data.data(), data.size()), std::runtime_error);
+	}
+	{
+		Data data(image.begin(), image.end());
+		patch<std::uint32_t>(data, tracks + 8, 1000000);
+		BOOST_CHECK_THROW(openanim::Asset(data.data(), data.size()), std::runtime_error);
+	}
+
+	// invalid clip frame rates
+	const std::size_t clipEntry = read<std::uint64_t>(image, 88);
+	for(float fps : {0.0f, -24.0f, std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity()}) {
+		Data data(image.begin(), image.end());
+		patch<float>(data, clipEntry, fps);
+		BOOST_CHECK_THROW(openanim::Asset(data.data(), data.size()), std::runtime_error);
+	}
+
+	// key counts not matching the track encodings, and invalid key times (on the first quantized track)
+	std::size_t quantized = 0;
+	while(read<std::uint32_t>(image, tracks + quantized * 40) != openanim::AnimationClip::Quantized)
+		++quantized;
+	BOOST_REQUIRE(quantized < s.pose().hierarchy().size() * 2);
+
+	const std::size_t track = tracks + quantized * 40;
+	const std::size_t keysBegin = read<std::uint32_t>(image, track + 4);
+	const std::size_t times = read<std::uint64_t>(image, clipEntry + 24) + keysBegin * 4;
+	{
+		Data data(image.begin(), image.end());
+		patch<std::uint32_t>(data, track + 8, keysBegin + 1);
+		BOOST_CHECK_THROW(openanim::Asset(data.data(), data.size()), std::runtime_error);
+	}
+	{
+		Data data(image.begin(), image.end());
+		patch<std::uint32_t>(data, track, openanim::AnimationClip::Constant);
+		BOOST_CHECK_THROW(openanim::Asset(data.data(), data.size()), std::runtime_error);
+	}
+	{
+		Data data(image.begin(), image.end());
+		patch<std::uint32_t>(data, track, openanim::AnimationClip::Identity);
+		BOOST_CHECK_THROW(openanim::Asset(data.data(), data.size()), std::runtime_error);
+	}
+	{
+		Data data(image.begin(), image.end());
+		patch<std::uint32_t>(data, times + 4, read<std::uint32_t>(image, times));
+		BOOST_CHECK_THROW(openanim::Asset(data.data(), data.size()), std::runtime_error);
+	}
+	{
+		Data data(image.begin(), image.end());
+		patch<std::uint32_t>(data, times, read<std::uint32_t>(image, clipEntry + 4));
+		BOOST_CHECK_THROW(openanim::Asset(data.data(), data.size()), std::runtime_error);
+	}
+
+	// missing file
+	BOOST_CHECK_THROW(openanim::Asset("/nonexistent/file.oanim"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(asset_hierarchy_validation) {
+	typedef std::vector<char, openanim::AlignedAllocator<char>> Data;
+
+	// root, with children a and b; a with child c
+	const std::vector<std::string> names = {"root", "a", "b", "c"};
+	const std::vector<int> parents = {-1, 0, 0, 1};
+
+	auto makeImage = [&](openanim::Hierarchy::Layout layout) {
+		const openanim::Pose pose(std::shared_ptr<const openanim::Hierarchy>(new openanim::Hierarchy(names, parents, NULL, layout)));
+
+		std::stringstream stream;
+		openanim::Asset::write(stream, pose, NULL, 0);
+		return stream.str();
+	};
+
+	// overwrites the parent and the children range of an item
+	auto check = [](const std::string& image, std::size_t i, std::int32_t parent, std::uint32_t begin, std::uint32_t end) {
+		const std::size_t item = read<std::uint64_t>(image, 48) + i * 16;
+
+		Data data(image.begin(), image.end());
+		patch<std::int32_t>(data, item + 4, parent);
+		patch<std::uint32_t>(data, item + 8, begin);
+		patch<std::uint32_t>(data, item + 12, end);
+		BOOST_CHECK_THROW(openanim::Asset(data.data(), data.size()), std::runtime_error);
+	};
+
+	// breadth-first - root {1, 3}, a {3, 4}, b {4, 4}, c {4, 4}
+	{
+		const std::string image = makeImage(openanim::Hierarchy::BreadthFirst);
+		{
+			const Data data(image.begin(), image.end());
+			BOOST_CHECK_NO_THROW(openanim::Asset(data.data(), data.size()));
+		}
+
+		// a range not after the item
+		check(image, 2, 0, 2, 2);
+		// a gap between the children ranges
+		check(image, 0, -1, 1, 2);
+		// an item not covered by any range
+		check(image, 1, 0, 3, 3);
+		// a child with a different parent
+		check(image, 3, 2, 4, 4);
+	}
+
+	// depth-first - root {1, 4}, a {2, 3}, c {3, 3}, b {4, 4}
+	{
+		const std::string image = makeImage(openanim::Hierarchy::DepthFirst);
+		{
+			const Data data(image.begin(), image.end());
+			BOOST_CHECK_NO_THROW(openanim::Asset(data.data(), data.size()));
+		}
+
+		// a subtree not starting right after the item (an endless children() walk)
+		check(image, 2, 1, 0, 0);
+		// a subtree not nested in its parent's
+		check(image, 2, 1, 3, 4);
+		// an item outside of its parent's subtree
+		check(image, 3, 1, 4, 4);
+		// an item outside of the root's subtree
+		check(image, 0, -1, 1, 3);
+	}
+}
@@ -0,0 +1,143 @@
+#include "openanim/Skeleton.h"
+#include "openanim/ClipBuilder.h"
+#include "openanim/BlendGraph.h"
+
+#include "Common.h"
+
+#include <ImathEuler.h>
+
+#include <boost/test/unit_test.hpp>
+
+using std::cout;
+using std::endl;
+
+using openanim::Transform;
+using tests::makeClip;
+using tests::equal;
+
+namespace {
+	openanim::Skeleton makeSkeleton(unsigned jointCount) {
+		openanim::Skeleton s;
+		s.addRoot("root", Transform());
+		for(unsigned a = 1; a < jointCount; ++a) {
+			std::stringstream name;
+			name << "joint_" << a;
+			s.addChild(s[a - 1], Transform(), name.str());
+		}
+
+		return s;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(blend_graph_evaluation) {
+	const openanim::Skeleton s = makeSkeleton(21);
+	const auto& h = s.pose().sharedHierarchy();
+
+	const openanim::AnimationClip walk = makeClip(h, 0.1f);
+	const openanim::AnimationClip run = makeClip(h, 0.3f);
+	const openanim::AnimationClip wave = makeClip(h, 0.05f);
+
+	openanim::BoneMask mask(h);
+	mask.setSubtree(10, 1.0f);
+
+	// (walk, run) blended, with wave masked over the upper part of the chain, and FK
+	openanim::BlendGraph graph(h);
+	const auto walkNode = graph.addClip(walk, true);
+	const auto runNode = graph.addClip(run, true);
+	const auto waveNode = graph.addClip(wave);
+	const auto locomotion = graph.addBlend(walkNode, runNode, 0.3f);
+	const auto upper = graph.addMask(locomotion, waveNode, mask, 0.5f);
+	const auto world = graph.addWorld(upper);
+	BOOST_REQUIRE_EQUAL(graph.size(), 6u);
+
+	graph.setTime(walkNode, 0.5f);
+	graph.setTime(runNode, 0.7f);
+	graph.setTime(waveNode, 0.2f);
+
+	// reference evaluation
+	openanim::Pose p1(h), p2(h), p3(h), local(h), reference(h);
+	walk.sample(0.5f, p1);
+	run.sample(0.7f, p2);
+	wave.sample(0.2f, p3);
+	openanim::blend(p1, p2, 0.3f, local);
+	openanim::blend(local, p3, 0.5f, mask, local);
+	openanim::Kinematics(*h).localToWorld(local, reference);
+
+	BOOST_CHECK(equal(graph.evaluate(world), reference));
+	BOOST_CHECK_EQUAL(graph.computedCount(), 6u);
+
+	// nothing changed - everything is cached
+	BOOST_CHECK(equal(graph.evaluate(world), reference));
+	BOOST_CHECK_EQUAL(graph.computedCount(), 0u);
+
+	// setting the same values doesn't invalidate anything
+	graph.setTime(walkNode, 0.5f);
+	graph.setWeight(locomotion, 0.3f);
+	graph.evaluate(world);
+	BOOST_CHECK_EQUAL(graph.computedCount(), 0u);
+
+	// a single changed clip recomputes only the nodes depending on it
+	graph.setTime(waveNode, 0.4f);
+	wave.sample(0.4f, p3);
+	openanim::blend(p1, p2, 0.3f, local);
+	openanim::blend(local, p3, 0.5f, mask, local);
+	openanim::Kinematics(*h).localToWorld(local, reference);
+
+	BOOST_CHECK(equal(graph.evaluate(world), reference));
+	BOOST_CHECK_EQUAL(graph.computedCount(), 3u);
+
+	// intermediate nodes can be evaluated as outputs as well
+	BOOST_CHECK(equal(graph.evaluate(waveNode), p3));
+	BOOST_CHECK_EQUAL(graph.computedCount(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(blend_graph_pruning) {
+	const openanim::Skeleton s = makeSkeleton(21);
+	const auto& h = s.pose().sharedHierarchy();
+
+	const openanim::AnimationClip walk = makeClip(h, 0.1f);
+	const openanim::AnimationClip run = makeClip(h, 0.3f);
+	const openanim::AnimationClip layer = makeClip(h, 0.2f);
+
+	openanim::BlendGraph graph(h);
+	const auto walkNode = graph.addClip(walk);
+	const auto runNode = graph.addClip(run);
+	const auto layerNode = graph.addClip(layer);
+	const auto locomotion = graph.addBlend(walkNode, runNode, 0.0f);
+	const auto additive = graph.addAdditive(locomotion, layerNode, 0.0f);
+
+	graph.setTime(walkNode, 1.0f);
+	graph.setTime(runNode, 1.0f);
+
+	openanim::Pose p1(h), p2(h);
+	walk.sample(1.0f, p1);
+	run.sample(1.0f, p2);
+
+	// zero weights - only the walk clip is sampled, and passed through both other nodes
+	BOOST_CHECK(equal(graph.evaluate(additive), p1));
+	BOOST_CHECK_EQUAL(graph.computedCount(), 1u);
+
+	// weight 1 - only the run clip
+	graph.setWeight(locomotion, 1.0f);
+	BOOST_CHECK(equal(graph.evaluate(additive), p2));
+	BOOST_CHECK_EQUAL(graph.computedCount(), 1u);
+
+	// changing a pruned input doesn't cause any computation
+	graph.setTime(walkNode, 1.5f);
+	graph.setTime(layerNode, 0.5f);
+	graph.evaluate(additive);
+	BOOST_CHECK_EQUAL(graph.computedCount(), 0u);
+
+	// a full blend of both clips, and the additive layer on top
+	graph.setWeight(locomotion, 0.5f);
+	graph.setWeight(additive, 1.0f);
+
+	openanim::Pose blended(h), l(h), reference(h);
+	walk.sample(1.5f, p1);
+	layer.sample(0.5f, l);
+	openanim::blend(p1, p2, 0.5f, blended);
+	openanim::blendAdditive(blended, l, 1.0f, reference);
+
+	BOOST_CHECK(equal(graph.evaluate(additive), reference));
+	BOOST_CHECK_EQUAL(graph.computedCount(), 4u);
+}
@@ -0,0 +1,174 @@
+#include "openanim/Skeleton.h"
+#include "openanim/Blending.h"
+#include "openanim/Quantization.h"
+
+#include "Common.h"
+
+#include <ImathEuler.h>
+
+#include <boost/test/unit_test.hpp>
+
+using std::cout;
+using std::endl;
+
+using openanim::Transform;
+using tests::EPS;
+using tests::randomTransform;
+using tests::difference;
+
+namespace {
+	// a random pose of a chain of joints; 19 joints to test both the SIMD batches and the scalar tail
+	openanim::Pose randomPose(const std::shared_ptr<const openanim::Hierarchy>& h) {
+		openanim::Pose p(h);
+		for(std::size_t i = 0; i < p.size(); ++i) {
+			p[i] = randomTransform();
+
+			// both hemispheres, to test the sign correction
+			if(rand() % 2)
+				p.rotations()[i] = -p.rotations()[i];
+		}
+		return p;
+	}
+
+	std::shared_ptr<const openanim::Hierarchy> chain() {
+		openanim::Skeleton s;
+		s.addRoot("root", Transform());
+		for(std::size_t a = 1; a < 19; ++a)
+			s.addChild(s[a-1], Transform(), "joint");
+		return s.pose().sharedHierarchy();
+	}
+}
+
+BOOST_AUTO_TEST_CASE(blending_two_way) {
+	const auto h = chain();
+	const openanim::Pose p1 = randomPose(h);
+	const openanim::Pose p2 = randomPose(h);
+
+	openanim::Pose nlerp(h), slerp(h);
+	for(float w = 0.0f; w <= 1.0f; w += 0.125f) {
+		openanim::blend(p1, p2, w, nlerp);
+		openanim::blend(p1, p2, w, slerp, openanim::Slerp);
+
+		for(std::size_t i = 0; i < p1.size(); ++i) {
+			const Imath::V3f t = p1[i].translation + (p2[i].translation - p1[i].translation) * w;
+
+			Imath::Quatf q2 = p2[i].rotation;
+			if((p1[i].rotation ^ q2) < 0.0f)
+				q2 = -q2;
+
+			BOOST_CHECK_SMALL(difference(nlerp[i],
+				Transform(openanim::quantization::nlerp(p1[i].rotation, p2[i].rotation, w), t)), EPS);
+			BOOST_CHECK_SMALL(difference(slerp[i], Transform(Imath::slerp(p1[i].rotation, q2, w), t)), EPS);
+		}
+	}
+
+	// the result can be one of the inputs
+	openanim::Pose p = p1;
+	openanim::blend(p, p2, 0.5f, p);
+	openanim::blend(p1, p2, 0.5f, nlerp);
+	for(std::size_t i = 0; i < p.size(); ++i)
+		BOOST_CHECK_SMALL(difference(p[i], nlerp[i]), EPS);
+}
+
+BOOST_AUTO_TEST_CASE(blending_n_way) {
+	const auto h = chain();
+	const openanim::Pose p1 = randomPose(h);
+	const openanim::Pose p2 = randomPose(h);
+	const openanim::Pose p3 = randomPose(h);
+
+	openanim::Pose result(h), reference(h);
+
+	// two poses with unnormalized weights are equivalent to a two-way blend
+	{
+		const openanim::Pose* poses[] = {&p1, &p2};
+		const float weights[] = {3.0f, 1.0f};
+		openanim::blend(poses, weights, 2, result);
+		openanim::blend(p1, p2, 0.25f, reference);
+
+		for(std::size_t i = 0; i < result.size(); ++i)
+			BOOST_CHECK_SMALL(difference(result[i], reference[i]), EPS);
+	}
+
+	// a single non-zero weight returns the input pose
+	{
+		const openanim::Pose* poses[] = {&p1, &p2, &p3};
+		const float weights[] = {0.0f, 0.0f, 2.0f};
+		openanim::blend(poses, weights, 3, result);
+
+		for(std::size_t i = 0; i < result.size(); ++i)
+			BOOST_CHECK_SMALL(difference(result[i], p3[i]), EPS);
+	}
+
+	// equal weights are independent of the rotation signs of the inputs
+	{
+		openanim::Pose n3 = p3;
+		for(std::size_t i = 0; i < n3.size(); ++i)
+			n3.rotations()[i] = -n3.rotations()[i];
+
+		const openanim::Pose* poses[] = {&p1, &p2, &p3};
+		const openanim::Pose* negated[] = {&p1, &p2, &n3};
+		const float weights[] = {1.0f, 1.0f, 1.0f};
+		openanim::blend(poses, weights, 3, result);
+		openanim::blend(negated, weights, 3, reference);
+
+		for(std::size_t i = 0; i < result.size(); ++i) {
+			BOOST_CHECK_SMALL(difference(result[i], reference[i]), EPS);
+			BOOST_CHECK_SMALL(result[i].rotation.length() - 1.0f, EPS);
+		}
+	}
+
+	// all weights zero return the first pose
+	{
+		const openanim::Pose* poses[] = {&p2, &p3};
+		const float weights[] = {0.0f, 0.0f};
+		openanim::blend(poses, weights, 2, result);
+
+		for(std::size_t i = 0; i < result.size(); ++i)
+			BOOST_CHECK_SMALL(difference(result[i], p2[i]), EPS);
+	}
+
+	// the number of poses is not limited
+	{
+		std::vector<const openanim::Pose*> poses;
+		std::vector<float> weights;
+		for(unsigned a = 0; a < 100; ++a) {
+			poses.push_back(a % 2 ? &p2 : &p1);
+			weights.push_back(0.5f);
+		}
+
+		openanim::blend(poses.data(), weights.data(), poses.size(), result);
+		openanim::blend(p1, p2, 0.5f, reference);
+
+		for(std::size_t i = 0; i < result.size(); ++i)
+			BOOST_CHECK_SMALL(difference(result[i], reference[i]), EPS);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(blending_additive) {
+	const auto h = chain();
+	const openanim::Pose pose = randomPose(h);
+	const openanim::Pose reference = randomPose(h);
+	const openanim::Pose base = randomPose(h);
+
+	openanim::Pose layer(h), result(h);
+	openanim::makeAdditive(pose, reference, layer);
+
+	// applying the difference to the reference returns the original pose
+	openanim::blendAdditive(reference, layer, 1.0f, result);
+	for(std::size_t i = 0; i < result.size(); ++i)
+		BOOST_CHECK_SMALL(difference(result[i], pose[i]), EPS);
+
+	// zero weight returns the base pose
+	openanim::blendAdditive(base, layer, 0.0f, result);
+	for(std::size_t i = 0; i < result.size(); ++i)
+		BOOST_CHECK_SMALL(difference(result[i], base[i]), EPS);
+
+	// partial weight scales the layer rotation
+	openanim::blendAdditive(base, layer, 0.5f, result);
+	for(std::size_t i = 0; i < result.size(); ++i) {
+		const Imath::Quatf delta = openanim::quantization::nlerp(Imath::Quatf(), layer[i].rotation, 0.5f);
+		const Transform expected(base[i].rotation * delta, base[i].translation + layer[i].translation * 0.5f);
+
+		BOOST_CHECK_SMALL(difference(result[i], expected), EPS);
+	}
+}
@@ -0,0 +1,136 @@
+#include "openanim/Skeleton.h"
+#include "openanim/Blending.h"
+#include "openanim/Quantization.h"
+
+#include "Common.h"
+
+#include <ImathEuler.h>
+
+#include <boost/test/unit_test.hpp>
+
+using std::cout;
+using std::endl;
+
+using openanim::Transform;
+using tests::EPS;
+using tests::randomTransform;
+using tests::randomSkeleton;
+using tests::difference;
+
+namespace {
+	bool isDescendant(const openanim::Hierarchy& h, int joint, int root) {
+		for(; joint >= 0; joint = h[joint].parent)
+			if(joint == root)
+				return true;
+		return false;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(bone_mask_subtree) {
+	for(unsigned a = 0; a < 20; ++a) {
+		const openanim::Skeleton s = randomSkeleton(1 + rand() % 100);
+		const openanim::Hierarchy& h = s.pose().hierarchy();
+
+		const int root = rand() % h.size();
+
+		openanim::BoneMask mask(s.pose().sharedHierarchy());
+		BOOST_CHECK(mask.ranges().empty());
+
+		mask.setSubtree(root, 0.5f);
+
+		std::size_t count = 0;
+		for(std::size_t ji = 0; ji < h.size(); ++ji)
+			if(isDescendant(h, ji, root)) {
+				BOOST_CHECK_EQUAL(mask.weight(ji), 0.5f);
+				++count;
+			}
+			else
+				BOOST_CHECK_EQUAL(mask.weight(ji), 0.0f);
+
+		// the ranges cover exactly the masked joints
+		BOOST_CHECK_EQUAL(mask.count(), count);
+
+		std::size_t covered = 0;
+		for(std::size_t r = 0; r < mask.ranges().size(); ++r) {
+			const openanim::BoneMask::Range& range = mask.ranges()[r];
+			BOOST_CHECK(range.begin < range.end);
+			if(r > 0)
+				BOOST_CHECK(mask.ranges()[r-1].end < range.begin);
+
+			for(std::size_t ji = range.begin; ji < range.end; ++ji)
+				BOOST_CHECK(mask.weight(ji) > 0.0f);
+			covered += range.end - range.begin;
+		}
+		BOOST_CHECK_EQUAL(covered, count);
+
+		// the same subtree in the depth-first layout is a single range
+		std::vector<std::size_t> mapping;
+		auto dfs = std::make_shared<const openanim::Hierarchy>(h, openanim::Hierarchy::DepthFirst, &mapping);
+
+		openanim::BoneMask dfsMask(dfs);
+		dfsMask.setSubtree(mapping[root], 0.5f);
+		BOOST_CHECK_EQUAL(dfsMask.count(), count);
+		BOOST_REQUIRE_EQUAL(dfsMask.ranges().size(), 1u);
+		BOOST_CHECK_EQUAL(dfsMask.ranges()[0].begin, mapping[root]);
+	}
+
+	// lookup by name, and overriding weights of a part of the subtree
+	openanim::Skeleton s;
+	s.addRoot("root", Transform());
+	s.addChild(s[0], Transform(), "spine");
+	s.addChild(s[0], Transform(), "leg");
+	s.addChild(s[s.pose().hierarchy().find("spine")], Transform(), "arm");
+
+	openanim::BoneMask mask(s.pose().sharedHierarchy());
+	mask.setSubtree("spine", 1.0f);
+	mask.set(s.pose().hierarchy().find("arm"), 0.25f);
+
+	BOOST_CHECK_EQUAL(mask.count(), 2u);
+	BOOST_CHECK_EQUAL(mask.weight(s.pose().hierarchy().find("spine")), 1.0f);
+	BOOST_CHECK_EQUAL(mask.weight(s.pose().hierarchy().find("arm")), 0.25f);
+	BOOST_CHECK_EQUAL(mask.weight(s.pose().hierarchy().find("leg")), 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE(bone_mask_blending) {
+	const openanim::Skeleton s = randomSkeleton(60);
+	const auto h = s.pose().sharedHierarchy();
+
+	openanim::Pose p1(h), p2(h);
+	for(std::size_t i = 0; i < h->size(); ++i) {
+		p1[i] = randomTransform();
+		p2[i] = randomTransform();
+	}
+
+	openanim::BoneMask mask(h);
+	mask.setSubtree(rand() % h->size(), 1.0f);
+	mask.setSubtree(rand() % h->size(), 0.5f);
+
+	const float weight = 0.75f;
+
+	openanim::Pose result(h), additive(h), layer(h);
+	openanim::blend(p1, p2, weight, mask, result);
+
+	openanim::makeAdditive(p2, p1, layer);
+	openanim::blendAdditive(p1, layer, weight, mask, additive);
+
+	for(std::size_t i = 0; i < h->size(); ++i) {
+		// joints outside the mask keep the first pose
+		const float w = weight * mask.weight(i);
+
+		const Transform expected(
+			openanim::quantization::nlerp(p1[i].rotation, p2[i].rotation, w),
+			p1[i].translation + (p2[i].translation - p1[i].translation) * w);
+		BOOST_CHECK_SMALL(difference(result[i], expected), EPS);
+
+		const Transform expectedAdditive(
+			p1[i].rotation * openanim::quantization::nlerp(Imath::Quatf(), layer[i].rotation, w),
+			p1[i].translation + layer[i].translation * w);
+		BOOST_CHECK_SMALL(difference(additive[i], expectedAdditive), EPS);
+	}
+
+	// in-place masked blend
+	openanim::Pose inplace = p1;
+	openanim::blend(inplace, p2, weight, mask, inplace);
+	for(std::size_t i = 0; i < h->size(); ++i)
+		BOOST_CHECK_SMALL(difference(inplace[i], result[i]), EPS);
+}
@@ -0,0 +1,163 @@
+#include "openanim/Loaders/Bvh.h"
+
+#include <cmath>
+#include <sstream>
+#include <fstream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+using std::cout;
+using std::endl;
+
+namespace {
+	const std::string s_hierarchy =
+		"HIERARCHY\n"
+		"ROOT Hips\n"
+		"{\n"
+		"\tOFFSET 0.00 1e-2 -.5\n"
+		"\tCHANNELS 6 Xposition Yposition Zposition Zrotation Xrotation Yrotation\n"
+		"\tJOINT Left Leg\n"
+		"\t{\n"
+		"\t\tOFFSET +3 -2. 0\n"
+		"\t\tCHANNELS 3 Zrotation Xrotation Yrotation\n"
+		"\t\tEnd Site\n"
+		"\t\t{\n"
+		"\t\t\tOFFSET 0 1 0\n"
+		"\t\t}\n"
+		"\t}\n"
+		"\tJOINT Spine\n"
+		"\t{\n"
+		"\t\tOFFSET 0 1.5E1 0\n"
+		"\t\tCHANNELS 3 Xrotation Yrotation Zrotation\n"
+		"\t}\n"
+		"}\n";
+
+	void parse(const std::string& text) {
+		const openanim::Bvh bvh(text.c_str(), text.size());
+	}
+
+	float distance(const Imath::V3f& v1, const Imath::V3f& v2) {
+		return (v1 - v2).length();
+	}
+}
+
+BOOST_AUTO_TEST_CASE(bvh_hierarchy) {
+	const std::string text = s_hierarchy +
+		"MOTION\n"
+		"Frames: 2\n"
+		"Frame Time: 0.04\n"
+		"1 2 3 0 0 0 0 0 0 0 0 0\r\n"
+		"4 5 6 90 0 0 90 90 0 0 0 45\r\n";
+
+	const openanim::Bvh bvh(text.c_str(), text.size());
+	const openanim::Hierarchy& h = bvh.hierarchy();
+
+	// joints, including the end site
+	BOOST_REQUIRE_EQUAL(h.size(), 4u);
+	const int hips = h.find("Hips");
+	const int leg = h.find("Left Leg");
+	const int end = h.find("Left Leg_end");
+	const int spine = h.find("Spine");
+
+	BOOST_REQUIRE(hips >= 0 && leg >= 0 && end >= 0 && spine >= 0);
+	BOOST_CHECK_EQUAL(h[hips].parent, -1);
+	BOOST_CHECK_EQUAL(h[leg].parent, hips);
+	BOOST_CHECK_EQUAL(h[end].parent, leg);
+	BOOST_CHECK_EQUAL(h[spine].parent, hips);
+
+	// bind pose offsets, in all number formats
+	BOOST_CHECK_EQUAL(bvh.bindPose()[hips].translation, Imath::V3f(0.0f, 0.01f, -0.5f));
+	BOOST_CHECK_EQUAL(bvh.bindPose()[leg].translation, Imath::V3f(3.0f, -2.0f, 0.0f));
+	BOOST_CHECK_EQUAL(bvh.bindPose()[end].translation, Imath::V3f(0.0f, 1.0f, 0.0f));
+	BOOST_CHECK_EQUAL(bvh.bindPose()[spine].translation, Imath::V3f(0.0f, 15.0f, 0.0f));
+	BOOST_CHECK_EQUAL(bvh.bindPose()[hips].rotation, Imath::Quatf());
+
+	// the motion
+	const openanim::AnimationClip& clip = bvh.clip();
+	BOOST_CHECK(clip.sharedHierarchy() == bvh.sharedHierarchy());
+	BOOST_CHECK_EQUAL(clip.frameCount(), 2u);
+	BOOST_CHECK_CLOSE(clip.fps(), 25.0f, 1e-4f);
+
+	openanim::Pose pose(bvh.sharedHierarchy());
+	clip.sample(0.0f, pose);
+
+	// position channels replace the offset, other joints keep their offsets
+	BOOST_CHECK_SMALL(distance(pose[hips].translation, Imath::V3f(1, 2, 3)), 1e-3f);
+	BOOST_CHECK_SMALL(distance(pose[leg].translation, Imath::V3f(3, -2, 0)), 1e-3f);
+	BOOST_CHECK_SMALL(distance(pose[end].translation, Imath::V3f(0, 1, 0)), 1e-3f);
+
+	clip.sample(clip.duration(), pose);
+	BOOST_CHECK_SMALL(distance(pose[hips].translation, Imath::V3f(4, 5, 6)), 1e-3f);
+
+	// a single rotation channel
+	BOOST_CHECK_SMALL(distance(Imath::V3f(1, 0, 0) * pose[hips].rotation, Imath::V3f(0, 1, 0)), 1e-3f);
+
+	// Zrotation 90 followed by Xrotation 90 - the X rotation is applied first
+	BOOST_CHECK_SMALL(distance(Imath::V3f(0, 1, 0) * pose[leg].rotation, Imath::V3f(0, 0, 1)), 1e-3f);
+	BOOST_CHECK_SMALL(distance(Imath::V3f(1, 0, 0) * pose[leg].rotation, Imath::V3f(0, 1, 0)), 1e-3f);
+
+	// Zrotation 45 as the last channel
+	const float s = std::sqrt(0.5f);
+	BOOST_CHECK_SMALL(distance(Imath::V3f(1, 0, 0) * pose[spine].rotation, Imath::V3f(s, s, 0)), 1e-3f);
+}
+
+BOOST_AUTO_TEST_CASE(bvh_file) {
+	// long enough to span many read chunks
+	const unsigned frameCount = 5000;
+
+	std::stringstream text;
+	text << s_hierarchy << "MOTION\nFrames: " << frameCount << "\nFrame Time: 0.0333333\n";
+	for(unsigned f = 0; f < frameCount; ++f)
+		text << (float)f * 0.01f << " 0.000000 " << -(float)f * 0.001f << " " << (float)(f % 360) << " 0 0 0 0 0 0 0 0" << endl;
+
+	const boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+	{
+		std::ofstream file(path.string().c_str(), std::ios::binary);
+		file << text.str();
+	}
+
+	const openanim::Bvh bvh(path.string());
+	boost::filesystem::remove(path);
+
+	BOOST_REQUIRE_EQUAL(bvh.clip().frameCount(), frameCount);
+
+	openanim::Pose pose(bvh.sharedHierarchy());
+	const int hips = bvh.hierarchy().find("Hips");
+	for(unsigned f = 0; f < frameCount; f += 97) {
+		bvh.clip().sample((float)f / bvh.clip().fps(), pose);
+
+		BOOST_CHECK_SMALL(distance(pose[hips].translation, Imath::V3f((float)f * 0.01f, 0, -(float)f * 0.001f)), 1e-2f);
+
+		const float angle = (float)(f % 360) * (float)M_PI / 180.0f;
+		BOOST_CHECK_SMALL(distance(Imath::V3f(1, 0, 0) * pose[hips].rotation, Imath::V3f(std::cos(angle), std::sin(angle), 0)), 1e-2f);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(bvh_errors) {
+	const std::string motion = "MOTION\nFrames: 2\nFrame Time: 0.04\n";
+	const std::string frame = "1 2 3 0 0 0 0 0 0 0 0 0\n";
+
+	BOOST_CHECK_NO_THROW(parse(s_hierarchy + motion + frame + frame));
+
+	// truncated motion, invalid values and structure
+	BOOST_CHECK_THROW(parse(s_hierarchy + motion + frame), std::runtime_error);
+	BOOST_CHECK_THROW(parse(s_hierarchy + motion + frame + "1 2 3 x 0 0 0 0 0 0 0 0\n"), std::runtime_error);
+	BOOST_CHECK_THROW(parse(s_hierarchy + "MOTION\nFrames: 0\nFrame Time: 0.04\n"), std::runtime_error);
+	BOOST_CHECK_THROW(parse(s_hierarchy.substr(0, s_hierarchy.size() / 2)), std::runtime_error);
+	BOOST_CHECK_THROW(parse("HIERARCHY\nROOT a\n{\nOFFSET 0 0 0\nCHANNELS 1 Wrotation\n}\n" + motion), std::runtime_error);
+	BOOST_CHECK_THROW(parse(""), std::runtime_error);
+
+	// missing file
+	BOOST_CHECK_THROW(openanim::Bvh("/nonexistent/file.bvh"), std::runtime_error);
+
+	// the error message contains the line number
+	try {
+		parse(s_hierarchy + motion + frame + "1 2 3 x 0 0 0 0 0 0 0 0\n");
+		BOOST_ERROR("an invalid file was parsed");
+	}
+	catch(const std::runtime_error& e) {
+		BOOST_CHECK(std::string(e.what()).find("line 25") != std::string::npos);
+	}
+}
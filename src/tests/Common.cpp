@@ -0,0 +1,67 @@
+#include "Common.h"
+
+#include <cmath>
+#include <sstream>
+
+#include <ImathEuler.h>
+
+#include <openanim/ClipBuilder.h>
+
+namespace tests {
+
+openanim::Transform randomTransform(float translationRange) {
+	const Imath::Eulerf angles(
+		(float)(rand() % 628) / 100.0f,
+		(float)(rand() % 628) / 100.0f,
+		(float)(rand() % 628) / 100.0f);
+	const Imath::V3f translation(
+		(float)(rand() % 200 - 100) / 100.0f * translationRange,
+		(float)(rand() % 200 - 100) / 100.0f * translationRange,
+		(float)(rand() % 200 - 100) / 100.0f * translationRange);
+
+	return openanim::Transform(angles.toQuat(), translation);
+}
+
+openanim::Skeleton randomSkeleton(unsigned jointCount, float translationRange) {
+	openanim::Skeleton s;
+	s.addRoot("root", randomTransform(translationRange));
+
+	for(unsigned a = 1; a < jointCount; ++a) {
+		std::stringstream name;
+		name << "joint_" << a;
+
+		s.addChild(s[rand() % s.size()], randomTransform(translationRange), name.str());
+	}
+
+	return s;
+}
+
+float difference(const openanim::Transform& t1, const openanim::Transform& t2, float translationRange) {
+	const float sign = (t1.rotation ^ t2.rotation) < 0.0f ? -1.0f : 1.0f;
+	return (t1.translation - t2.translation).length() / translationRange + std::abs(t1.rotation.r - t2.rotation.r * sign) + (t1.rotation.v - t2.rotation.v * sign).length();
+}
+
+bool equal(const openanim::Pose& p1, const openanim::Pose& p2) {
+	if(p1.size() != p2.size())
+		return false;
+
+	for(std::size_t ji = 0; ji < p1.size(); ++ji)
+		if(p1[ji].translation != p2[ji].translation || p1[ji].rotation != p2[ji].rotation)
+			return false;
+	return true;
+}
+
+openanim::AnimationClip makeClip(const std::shared_ptr<const openanim::Hierarchy>& h, float speed, float tolerance) {
+	openanim::ClipBuilder builder(h, 30.0f);
+
+	openanim::Pose pose(h);
+	for(unsigned f = 0; f < 60; ++f) {
+		for(std::size_t ji = 0; ji < pose.size(); ++ji)
+			pose[ji] = openanim::Transform(Imath::Eulerf((float)f * speed, (float)ji * 0.1f, 0).toQuat(), Imath::V3f(0, 1, (float)f * speed));
+		builder.addFrame(pose);
+	}
+
+	return builder.build(tolerance, tolerance);
+}
+
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <memory>
+
+#include <openanim/Skeleton.h>
+#include <openanim/AnimationClip.h>
+
+namespace tests {
+
+/// default tolerance of the comparisons of transformations
+const float EPS = 1e-4f;
+
+/// a random rigid transformation, with translation components in [-translationRange, translationRange)
+openanim::Transform randomTransform(float translationRange = 10.0f);
+
+/// a random tree of jointCount joints with random transformations, built by adding children one by one
+openanim::Skeleton randomSkeleton(unsigned jointCount, float translationRange = 10.0f);
+
+/// difference of two transformations - the distance of translations (relative to translationRange),
+/// and the distance of rotations (q and -q being the same rotation)
+float difference(const openanim::Transform& t1, const openanim::Transform& t2, float translationRange = 1.0f);
+
+/// exact equality of two poses
+bool equal(const openanim::Pose& p1, const openanim::Pose& p2);
+
+/// a clip of 60 frames at 30 fps, with all joints moving and rotating at given speed (compressed with
+/// tolerance, see ClipBuilder::build())
+openanim::AnimationClip makeClip(const std::shared_ptr<const openanim::Hierarchy>& h, float speed, float tolerance = 0.0f);
+
+}
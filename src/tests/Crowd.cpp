@@ -0,0 +1,131 @@
+#include "openanim/Skeleton.h"
+#include "openanim/ClipBuilder.h"
+#include "openanim/Crowd.h"
+#include "openanim/Blending.h"
+
+#include "Common.h"
+
+#include <ImathEuler.h>
+
+#include <tbb/global_control.h>
+
+#include <boost/test/unit_test.hpp>
+
+using std::cout;
+using std::endl;
+
+using openanim::Transform;
+using tests::randomSkeleton;
+using tests::makeClip;
+
+BOOST_AUTO_TEST_CASE(crowd_evaluation) {
+	const openanim::Skeleton s1 = randomSkeleton(30);
+	const openanim::Skeleton s2 = randomSkeleton(13);
+
+	const openanim::AnimationClip walk = makeClip(s1.pose().sharedHierarchy(), 0.1f);
+	const openanim::AnimationClip run = makeClip(s1.pose().sharedHierarchy(), 0.3f);
+	const openanim::AnimationClip idle = makeClip(s2.pose().sharedHierarchy(), 0.05f);
+
+	openanim::Crowd crowd;
+	for(unsigned c = 0; c < 200; ++c) {
+		if(c % 3 == 0) {
+			const std::size_t index = crowd.add(s2.pose().sharedHierarchy());
+			crowd[index].addLayer(idle);
+			crowd[index].setLooping(0, true);
+			crowd[index].setTime(0, (float)c * 0.01f);
+		}
+		else {
+			const std::size_t index = crowd.add(s1.pose().sharedHierarchy());
+			crowd[index].addLayer(walk, 1.0f);
+			crowd[index].addLayer(run, (float)(c % 10) / 10.0f);
+			crowd[index].setTime(1, (float)c * 0.005f);
+		}
+	}
+	BOOST_REQUIRE_EQUAL(crowd.size(), 200u);
+
+	crowd.advance(0.25f);
+	crowd.evaluate();
+
+	// the same result as a serial evaluation
+	const openanim::Kinematics k1(s1.pose().hierarchy()), k2(s2.pose().hierarchy());
+	for(std::size_t c = 0; c < crowd.size(); ++c) {
+		const openanim::Crowd::Character& ch = crowd[c];
+
+		openanim::Pose local(ch.localPose().sharedHierarchy()), world(ch.localPose().sharedHierarchy());
+		if(ch.layerCount() == 1) {
+			openanim::ClipSampler sampler(idle);
+			sampler.setLooping(true);
+			sampler.sample(ch.time(0), local);
+			k2.localToWorld(local, world);
+		}
+		else {
+			openanim::Pose p1(local), p2(local);
+			walk.sample(ch.time(0), p1);
+			run.sample(ch.time(1), p2);
+
+			const openanim::Pose* poses[] = {&p1, &p2};
+			const float weights[] = {ch.weight(0), ch.weight(1)};
+			openanim::blend(poses, weights, 2, local);
+			k1.localToWorld(local, world);
+		}
+
+		for(std::size_t ji = 0; ji < local.size(); ++ji) {
+			BOOST_REQUIRE_EQUAL(ch.localPose()[ji].translation, local[ji].translation);
+			BOOST_REQUIRE_EQUAL(ch.localPose()[ji].rotation, local[ji].rotation);
+			BOOST_REQUIRE_EQUAL(ch.worldPose()[ji].translation, world[ji].translation);
+			BOOST_REQUIRE_EQUAL(ch.worldPose()[ji].rotation, world[ji].rotation);
+		}
+	}
+
+	// the results don't depend on the number of threads
+	std::vector<openanim::Pose> parallel;
+	for(std::size_t c = 0; c < crowd.size(); ++c)
+		parallel.push_back(crowd[c].worldPose());
+
+	{
+		tbb::global_control serial(tbb::global_control::max_allowed_parallelism, 1);
+		crowd.evaluate();
+	}
+
+	for(std::size_t c = 0; c < crowd.size(); ++c)
+		for(std::size_t ji = 0; ji < parallel[c].size(); ++ji) {
+			BOOST_REQUIRE_EQUAL(crowd[c].worldPose()[ji].translation, parallel[c][ji].translation);
+			BOOST_REQUIRE_EQUAL(crowd[c].worldPose()[ji].rotation, parallel[c][ji].rotation);
+		}
+}
+
+BOOST_AUTO_TEST_CASE(crowd_layers) {
+	const openanim::Skeleton s = randomSkeleton(10);
+	const openanim::AnimationClip walk = makeClip(s.pose().sharedHierarchy(), 0.1f);
+	const openanim::AnimationClip run = makeClip(s.pose().sharedHierarchy(), 0.3f);
+
+	openanim::Crowd crowd;
+	const std::size_t index = crowd.add(s.pose().sharedHierarchy());
+
+	// the number of layers is not limited
+	for(unsigned l = 0; l < 50; ++l)
+		crowd[index].addLayer(l % 2 ? run : walk, 0.0f);
+	BOOST_REQUIRE_EQUAL(crowd[index].layerCount(), 50u);
+
+	crowd.advance(0.5f);
+
+	// zero weights of all layers result in the pose of the first layer
+	crowd.evaluate();
+
+	openanim::Pose expected(s.pose().sharedHierarchy());
+	walk.sample(0.5f, expected);
+	for(std::size_t ji = 0; ji < expected.size(); ++ji) {
+		BOOST_CHECK_EQUAL(crowd[index].localPose()[ji].translation, expected[ji].translation);
+		BOOST_CHECK_EQUAL(crowd[index].localPose()[ji].rotation, expected[ji].rotation);
+	}
+
+	// a single weighted layer
+	crowd[index].setWeight(49, 2.0f);
+	crowd.evaluate();
+
+	run.sample(0.5f, expected);
+	for(std::size_t ji = 0; ji < expected.size(); ++ji) {
+		BOOST_CHECK_SMALL((crowd[index].localPose()[ji].translation - expected[ji].translation).length(), 1e-5f);
+		BOOST_CHECK_SMALL(std::abs(std::abs(crowd[index].localPose()[ji].rotation ^ expected[ji].rotation) - 1.0f), 1e-5f);
+	}
+}
@@ -0,0 +1,85 @@
+#include "openanim/Skeleton.h"
+#include "openanim/HalfPose.h"
+
+#include "Common.h"
+
+#include <ImathEuler.h>
+
+#include <boost/test/unit_test.hpp>
+
+using std::cout;
+using std::endl;
+
+using openanim::Transform;
+using tests::randomSkeleton;
+using tests::difference;
+
+namespace {
+	static const float EPS = 2e-3f;
+}
+
+BOOST_AUTO_TEST_CASE(half_pose_roundtrip) {
+	// both the bulk conversion and the scalar tails
+	for(unsigned a = 0; a < 50; ++a) {
+		const openanim::Skeleton s = randomSkeleton(1 + rand() % 100, 10.0f);
+
+		const openanim::HalfPose compressed(s.pose());
+		BOOST_REQUIRE_EQUAL(compressed.size(), s.size());
+		BOOST_CHECK(compressed.isCompatibleWith(s.pose()));
+		BOOST_CHECK_EQUAL(compressed.translationScale(), 1.0f);
+		BOOST_CHECK_EQUAL(compressed.dataSize(), s.size() * 7 * 2);
+
+		openanim::Pose pose(s.pose().sharedHierarchy());
+		compressed.decompress(pose);
+
+		for(std::size_t ji = 0; ji < s.size(); ++ji) {
+			BOOST_REQUIRE_SMALL(difference(pose[ji], s.pose()[ji], 10.0f), EPS);
+			BOOST_REQUIRE_SMALL(difference(compressed[ji], pose[ji], 10.0f), 1e-6f);
+
+			// rotations are renormalized
+			BOOST_REQUIRE_SMALL(pose[ji].rotation.length() - 1.0f, 1e-6f);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(half_pose_exact) {
+	// values representable as halfs survive the roundtrip exactly
+	openanim::Skeleton s;
+	s.addRoot("root", Transform(Imath::V3f(1.5f, -2.0f, 1024.0f)));
+	s.addChild(s[0], Transform(Imath::Quatf(0.0f, 1.0f, 0.0f, 0.0f), Imath::V3f(0.25f, 0.0f, -0.125f)), "child");
+
+	const openanim::HalfPose compressed(s.pose());
+
+	openanim::Pose pose(s.pose().sharedHierarchy());
+	compressed.decompress(pose);
+
+	for(std::size_t ji = 0; ji < s.size(); ++ji) {
+		BOOST_CHECK_EQUAL(pose[ji].translation, s.pose()[ji].translation);
+		BOOST_CHECK_EQUAL(pose[ji].rotation, s.pose()[ji].rotation);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(half_pose_translation_scale) {
+	for(unsigned a = 0; a < 20; ++a) {
+		// translations out of the range of half
+		const openanim::Skeleton s = randomSkeleton(1 + rand() % 100, 1e6f);
+
+		openanim::HalfPose compressed;
+		BOOST_CHECK(compressed.empty());
+
+		compressed.compress(s.pose(), true);
+		BOOST_REQUIRE_EQUAL(compressed.size(), s.size());
+		BOOST_CHECK(compressed.translationScale() > 1.0f);
+
+		openanim::Pose pose(s.pose().sharedHierarchy());
+		compressed.decompress(pose);
+
+		for(std::size_t ji = 0; ji < s.size(); ++ji)
+			BOOST_REQUIRE_SMALL(difference(pose[ji], s.pose()[ji], 1e6f), EPS);
+
+		// an all-zero translation doesn't need scaling
+		openanim::Pose identity(s.pose().sharedHierarchy());
+		compressed.compress(identity, true);
+		BOOST_CHECK_EQUAL(compressed.translationScale(), 1.0f);
+	}
+}
@@ -0,0 +1,74 @@
+#include "openanim/Skeleton.h"
+#include "openanim/Kinematics.h"
+#include "openanim/Instrumentation.h"
+
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+using std::cout;
+using std::endl;
+
+using openanim::Transform;
+
+BOOST_AUTO_TEST_CASE(instrumentation) {
+	namespace instr = openanim::instrumentation;
+
+	instr::reset();
+
+	openanim::Skeleton s;
+	s.addRoot("root", Transform());
+	for(unsigned a = 0; a < 10; ++a)
+		s.addChild(s[0], Transform(), "child");
+
+	const openanim::Skeleton copy = s;
+	const openanim::Kinematics k(s.pose().hierarchy());
+	openanim::Pose world(s.pose().sharedHierarchy());
+	k.localToWorld(s.pose(), world);
+
+	// values recorded by another (finished) thread are included
+	std::thread([&]() {
+		k.localToWorld(s.pose(), world);
+	}).join();
+
+	if(!instr::enabled()) {
+		// nothing is recorded
+		BOOST_CHECK_EQUAL(instr::query("hierarchy/clone").count, 0u);
+		BOOST_CHECK_EQUAL(instr::query("kinematics/local_to_world").count, 0u);
+		return;
+	}
+
+	// each addChild() and addRoot() clones the shared hierarchy
+	BOOST_CHECK_EQUAL(instr::query("hierarchy/clone").count, 11u);
+	BOOST_CHECK_EQUAL(instr::query("hierarchy/add_child").count, 10u);
+	BOOST_CHECK_EQUAL(instr::query("skeleton/copy").count, 1u);
+
+	const instr::Entry fk = instr::query("kinematics/local_to_world");
+	BOOST_CHECK_EQUAL(fk.count, 2u);
+	BOOST_CHECK(fk.seconds > 0.0);
+
+	instr::reset();
+	BOOST_CHECK_EQUAL(instr::query("hierarchy/clone").count, 0u);
+	BOOST_CHECK_EQUAL(instr::query("kinematics/local_to_world").count, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(instrumentation_overflow) {
+	namespace instr = openanim::instrumentation;
+
+	// registering more probes than available never returns an index outside the per-thread storage
+	std::size_t last = 0;
+	for(std::size_t p = 0; p < instr::s_maxProbes + 10; ++p) {
+		last = instr::probe(("test/overflow_" + std::to_string(p)).c_str());
+		BOOST_CHECK(last < instr::s_maxProbes);
+	}
+
+	// the excess probes share a single entry
+	BOOST_CHECK_EQUAL(last, instr::s_maxProbes - 1);
+	BOOST_CHECK_EQUAL(instr::probe("test/overflow_extra"), instr::s_maxProbes - 1);
+	BOOST_CHECK_EQUAL(instr::snapshot().size(), instr::s_maxProbes);
+	BOOST_CHECK_EQUAL(instr::snapshot().back().name, "instrumentation/overflow");
+
+	instr::record(last, 2);
+	BOOST_CHECK_EQUAL(instr::query("instrumentation/overflow").count, 2u);
+	instr::reset();
+}
@@ -0,0 +1,119 @@
+#include "openanim/Skeleton.h"
+#include "openanim/Kinematics.h"
+
+#include "Common.h"
+
+#include <ImathEuler.h>
+
+#include <boost/test/unit_test.hpp>
+
+using std::cout;
+using std::endl;
+
+using openanim::Transform;
+using tests::EPS;
+using tests::randomTransform;
+using tests::randomSkeleton;
+using tests::difference;
+
+namespace {
+	// reference recursive implementation
+	const Transform worldTransform(const openanim::Skeleton::ConstJoint& j) {
+		if(!j.hasParent())
+			return j.tr();
+		return j.tr() * worldTransform(j.parent());
+	}
+}
+
+BOOST_AUTO_TEST_CASE(kinematics_local_to_world) {
+	// both a chain and wider random trees, to test the SIMD batches and the scalar tails
+	for(unsigned a = 0; a < 50; ++a) {
+		const openanim::Skeleton s = randomSkeleton(1 + rand() % 100);
+
+		const openanim::Kinematics fk(s.pose().hierarchy());
+		BOOST_REQUIRE_EQUAL(fk.size(), s.size());
+
+		openanim::Pose world(s.pose().sharedHierarchy());
+		fk.localToWorld(s.pose(), world);
+
+		for(std::size_t ji = 0; ji < s.size(); ++ji)
+			BOOST_REQUIRE_SMALL(difference(world[ji], worldTransform(s[ji])), EPS);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(kinematics_chain) {
+	openanim::Skeleton s;
+	s.addRoot("root", Transform(Imath::V3f(1,0,0)));
+	s.addChild(s[0], Transform(Imath::V3f(1,0,0)), "first");
+	s.addChild(s[1], Transform(Imath::V3f(0,2,0)), "second");
+
+	const openanim::Kinematics fk(s.pose().hierarchy());
+
+	openanim::Pose world(s.pose().sharedHierarchy());
+	fk.localToWorld(s.pose(), world);
+
+	BOOST_CHECK_EQUAL(world[0].translation, Imath::V3f(1,0,0));
+	BOOST_CHECK_EQUAL(world[1].translation, Imath::V3f(2,0,0));
+	BOOST_CHECK_EQUAL(world[2].translation, Imath::V3f(2,2,0));
+}
+
+BOOST_AUTO_TEST_CASE(kinematics_world_to_local) {
+	for(unsigned a = 0; a < 50; ++a) {
+		const openanim::Skeleton s = randomSkeleton(1 + rand() % 100);
+
+		const openanim::Kinematics fk(s.pose().hierarchy());
+
+		openanim::Pose world(s.pose().sharedHierarchy());
+		fk.localToWorld(s.pose(), world);
+
+		// the roundtrip should result in the original local pose
+		openanim::Pose local(s.pose().sharedHierarchy());
+		fk.worldToLocal(world, local);
+
+		for(std::size_t ji = 0; ji < s.size(); ++ji)
+			BOOST_REQUIRE_SMALL(difference(local[ji], s.pose()[ji]), EPS);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(kinematics_world_cache) {
+	for(unsigned a = 0; a < 20; ++a) {
+		openanim::Skeleton s = randomSkeleton(1 + rand() % 100);
+
+		// the first query computes everything
+		for(const auto& j : static_cast<const openanim::Skeleton&>(s))
+			BOOST_CHECK_SMALL(difference(j.world(), worldTransform(j)), EPS);
+
+		// changes through the joint accessors
+		for(unsigned b = 0; b < 3; ++b)
+			s[rand() % s.size()].tr() = randomTransform();
+
+		for(const auto& j : static_cast<const openanim::Skeleton&>(s))
+			BOOST_CHECK_SMALL(difference(j.world(), worldTransform(j)), EPS);
+
+		// changes made through a reference held over a world query require explicit invalidation
+		const openanim::Skeleton& cs = s;
+		const std::size_t changed = rand() % s.size();
+		openanim::TransformRef ref = s[changed].tr();
+		cs.worldPose();
+		ref.translation += Imath::V3f(1, 2, 3);
+		s.invalidate(changed);
+
+		const openanim::Pose& world = cs.worldPose();
+		for(std::size_t ji = 0; ji < s.size(); ++ji)
+			BOOST_CHECK_SMALL(difference(world[ji], worldTransform(cs[ji])), EPS);
+
+		// a copy rebuilds its cache on the first query
+		const openanim::Skeleton copy = s;
+		for(std::size_t ji = 0; ji < s.size(); ++ji)
+			BOOST_CHECK_SMALL(difference(copy[ji].world(), world[ji]), EPS);
+
+		// replacing the whole pose
+		openanim::Pose pose(s.pose().sharedHierarchy());
+		for(std::size_t ji = 0; ji < s.size(); ++ji)
+			pose[ji] = randomTransform();
+		s.mutablePose() = pose;
+
+		for(const auto& j : static_cast<const openanim::Skeleton&>(s))
+			BOOST_CHECK_SMALL(difference(j.world(), worldTransform(j)), EPS);
+	}
+}
@@ -0,0 +1,83 @@
+#include "openanim/Skeleton.h"
+#include "openanim/Palette.h"
+
+#include "Common.h"
+
+#include <ImathEuler.h>
+
+#include <boost/test/unit_test.hpp>
+
+using std::cout;
+using std::endl;
+
+using openanim::Transform;
+using tests::randomTransform;
+using tests::randomSkeleton;
+
+namespace {
+	static const float EPS = 1e-3f;
+}
+
+BOOST_AUTO_TEST_CASE(palette_matrices) {
+	for(unsigned a = 0; a < 20; ++a) {
+		openanim::Skeleton s = randomSkeleton(1 + rand() % 50);
+		const openanim::Pose bind = s.worldPose();
+
+		const openanim::Palette palette(bind);
+		BOOST_REQUIRE_EQUAL(palette.size(), s.size());
+
+		std::vector<float> matrices(palette.size() * openanim::Palette::s_matrixSize);
+
+		// the bind pose itself results in identity matrices
+		palette.writeMatrices(bind, matrices.data());
+		for(std::size_t ji = 0; ji < s.size(); ++ji)
+			for(unsigned r = 0; r < 3; ++r)
+				for(unsigned c = 0; c < 4; ++c)
+					BOOST_CHECK_SMALL(matrices[ji * 12 + r * 4 + c] - (r == c ? 1.0f : 0.0f), EPS);
+
+		// an animated pose
+		for(std::size_t ji = 0; ji < s.size(); ++ji)
+			s[ji].tr() = randomTransform();
+		const openanim::Pose& world = s.worldPose();
+
+		palette.writeMatrices(world, matrices.data());
+		for(std::size_t ji = 0; ji < s.size(); ++ji) {
+			const Imath::M44f expected = bind[ji].toMatrix44().inverse() * world[ji].toMatrix44();
+
+			for(unsigned r = 0; r < 3; ++r)
+				for(unsigned c = 0; c < 4; ++c)
+					BOOST_CHECK_SMALL(matrices[ji * 12 + r * 4 + c] - expected[c][r], EPS);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(palette_dual_quaternions) {
+	for(unsigned a = 0; a < 20; ++a) {
+		openanim::Skeleton s = randomSkeleton(1 + rand() % 50);
+		const openanim::Pose bind = s.worldPose();
+
+		const openanim::Palette palette(bind);
+
+		for(std::size_t ji = 0; ji < s.size(); ++ji)
+			s[ji].tr() = randomTransform();
+		const openanim::Pose& world = s.worldPose();
+
+		std::vector<float> dq(palette.size() * openanim::Palette::s_dualQuaternionSize);
+		palette.writeDualQuaternions(world, dq.data());
+
+		for(std::size_t ji = 0; ji < s.size(); ++ji) {
+			const Transform expected = bind[ji].inverse() * world[ji];
+
+			const float* d = &dq[ji * 8];
+			const Imath::Quatf real(d[3], d[0], d[1], d[2]);
+			const Imath::Quatf dual(d[7], d[4], d[5], d[6]);
+
+			// translation = 2 * dual * conjugate(real)
+			const Imath::Quatf t = dual * ~real;
+
+			BOOST_CHECK_SMALL(std::abs(real ^ expected.rotation) - 1.0f, EPS);
+			BOOST_CHECK_SMALL(t.r, EPS);
+			BOOST_CHECK_SMALL((t.v * 2.0f - expected.translation).length(), EPS);
+		}
+	}
+}
@@ -0,0 +1,63 @@
+#include "openanim/Skeleton.h"
+
+#include <boost/test/unit_test.hpp>
+
+using std::cout;
+using std::endl;
+
+using openanim::Transform;
+
+BOOST_AUTO_TEST_CASE(pose_storage) {
+	openanim::Skeleton s;
+	s.addRoot("root", Transform(Imath::V3f(1,2,3)));
+	s.addChild(s[0], Transform(Imath::Quatf(0,1,0,0), Imath::V3f(4,5,6)), "first");
+	s.addChild(s[0], Transform(Imath::V3f(7,8,9)), "second");
+
+	const openanim::Pose& p = s.pose();
+	BOOST_REQUIRE_EQUAL(p.size(), 3u);
+	BOOST_CHECK(&p.hierarchy() == &s.pose().hierarchy());
+
+	// the arrays are contiguous, aligned and in the hierarchy order
+	BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(p.translations()) % 32, 0u);
+	BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(p.rotations()) % 32, 0u);
+	BOOST_CHECK_EQUAL(p.translations()[0], Imath::V3f(1,2,3));
+	BOOST_CHECK_EQUAL(p.translations()[1], Imath::V3f(4,5,6));
+	BOOST_CHECK_EQUAL(p.translations()[2], Imath::V3f(7,8,9));
+	BOOST_CHECK_EQUAL(p.rotations()[1], Imath::Quatf(0,1,0,0));
+
+	// joint accessors write through to the pose
+	s[2].tr().translation = Imath::V3f(10, 11, 12);
+	BOOST_CHECK_EQUAL(p.translations()[2], Imath::V3f(10,11,12));
+	s[2].tr() = Transform(Imath::V3f(13, 14, 15));
+	BOOST_CHECK_EQUAL(p[2].translation, Imath::V3f(13,14,15));
+}
+
+BOOST_AUTO_TEST_CASE(pose_adopt) {
+	openanim::Skeleton s;
+	s.addRoot("root", Transform());
+	s.addChild(s[0], Transform(), "first");
+
+	// identity pose of the same hierarchy
+	openanim::Pose p(s.pose().sharedHierarchy());
+	BOOST_CHECK(p.isCompatibleWith(s.pose()));
+	BOOST_CHECK_EQUAL(p.size(), 2u);
+	for(std::size_t a = 0; a < p.size(); ++a) {
+		BOOST_CHECK_EQUAL(p[a].translation, Imath::V3f(0,0,0));
+		BOOST_CHECK_EQUAL(p[a].rotation, Imath::Quatf());
+	}
+
+	// adopting the pose by moving does not reallocate the arrays
+	p[1].translation = Imath::V3f(1,2,3);
+	const Imath::V3f* data = p.translations();
+
+	openanim::Skeleton s2(std::move(p));
+	BOOST_CHECK(s2.isCompatibleWith(s));
+	BOOST_CHECK_EQUAL(s2.pose().translations(), data);
+	BOOST_CHECK_EQUAL(s2[1].name(), "first");
+	BOOST_CHECK_EQUAL(s2[1].parent().name(), "root");
+	BOOST_CHECK_EQUAL(s2[1].tr().translation, Imath::V3f(1,2,3));
+
+	// and direct assignment of compatible poses
+	s.mutablePose() = s2.pose();
+	BOOST_CHECK_EQUAL(s[1].tr().translation, Imath::V3f(1,2,3));
+}
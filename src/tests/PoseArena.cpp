@@ -0,0 +1,96 @@
+#include "openanim/Skeleton.h"
+#include "openanim/PoseArena.h"
+#include "openanim/Blending.h"
+
+#include "Common.h"
+
+#include <ImathEuler.h>
+
+#include <boost/test/unit_test.hpp>
+
+using std::cout;
+using std::endl;
+
+using openanim::Transform;
+using tests::randomSkeleton;
+
+BOOST_AUTO_TEST_CASE(pose_arena_allocation) {
+	openanim::PoseArena arena(1024);
+	BOOST_CHECK_EQUAL(arena.capacity(), 0u);
+
+	const openanim::Skeleton s = randomSkeleton(19);
+
+	const Imath::V3f* first = NULL;
+	for(unsigned frame = 0; frame < 3; ++frame) {
+		{
+			openanim::Pose p1(s.pose(), arena);
+			openanim::Pose p2(s.pose().sharedHierarchy(), arena);
+			openanim::Pose result(s.pose().sharedHierarchy(), arena);
+
+			BOOST_CHECK_EQUAL(p1.arena(), &arena);
+			BOOST_CHECK_EQUAL(arena.live(), 6u);
+			BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(p1.translations()) % openanim::PoseArena::s_alignment, 0u);
+			BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(p2.rotations()) % openanim::PoseArena::s_alignment, 0u);
+
+			// after a reset, the same memory is reused
+			if(first == NULL)
+				first = p1.translations();
+			BOOST_CHECK_EQUAL(p1.translations(), first);
+
+			// arena poses work with the pose-producing APIs
+			openanim::blend(p1, p2, 0.0f, result);
+			for(std::size_t ji = 0; ji < s.size(); ++ji) {
+				BOOST_CHECK_EQUAL(p1[ji].translation, s.pose()[ji].translation);
+				BOOST_CHECK_SMALL((result[ji].translation - p1[ji].translation).length(), 1e-4f);
+			}
+
+			// copies are allocated on the heap, assignment keeps the target's storage
+			const openanim::Pose copy = result;
+			BOOST_CHECK(copy.arena() == NULL);
+
+			const Imath::Quatf* rotations = p2.rotations();
+			p2 = copy;
+			BOOST_CHECK_EQUAL(p2.arena(), &arena);
+			BOOST_CHECK_EQUAL(p2.rotations(), rotations);
+
+			// a skeleton created from an arena pose doesn't keep the arena memory
+			const openanim::Skeleton adopted{openanim::Pose(p1, arena)};
+			BOOST_CHECK(adopted.pose().arena() == NULL);
+
+			// neither does a pose move-constructed from an arena pose (or a container holding it)
+			openanim::Pose moved(std::move(result));
+			BOOST_CHECK(moved.arena() == NULL);
+			BOOST_CHECK_EQUAL(moved[0].translation, copy[0].translation);
+
+			std::vector<openanim::Pose> poses;
+			poses.push_back(openanim::Pose(p1, arena));
+			BOOST_CHECK(poses.back().arena() == NULL);
+
+			// while moving a heap pose keeps its data
+			const Imath::V3f* translations = moved.translations();
+			openanim::Pose heap(std::move(moved));
+			BOOST_CHECK_EQUAL(heap.translations(), translations);
+
+			// move assignment keeps the target's storage as well
+			const Imath::V3f* arenaTranslations = p2.translations();
+			p2 = std::move(heap);
+			BOOST_CHECK_EQUAL(p2.arena(), &arena);
+			BOOST_CHECK_EQUAL(p2.translations(), arenaTranslations);
+		}
+
+		BOOST_CHECK_EQUAL(arena.live(), 0u);
+		arena.reset();
+		BOOST_CHECK_EQUAL(arena.used(), 0u);
+	}
+
+	// allocations larger than the block size
+	{
+		const openanim::Skeleton large = randomSkeleton(200);
+		openanim::Pose p(large.pose(), arena);
+		BOOST_CHECK(arena.capacity() >= 200 * (sizeof(Imath::V3f) + sizeof(Imath::Quatf)));
+
+		for(std::size_t ji = 0; ji < large.size(); ++ji)
+			BOOST_CHECK_EQUAL(p[ji].rotation, large.pose()[ji].rotation);
+	}
+	arena.reset();
+}
@@ -0,0 +1,134 @@
+#include "openanim/Skeleton.h"
+#include "openanim/ClipBuilder.h"
+#include "openanim/Serialization.h"
+
+#include "Common.h"
+
+#include <sstream>
+
+#include <ImathEuler.h>
+
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/test/unit_test.hpp>
+
+using std::cout;
+using std::endl;
+
+using openanim::Transform;
+using tests::randomTransform;
+using tests::randomSkeleton;
+using tests::equal;
+
+namespace {
+	bool equal(const openanim::Hierarchy& h1, const openanim::Hierarchy& h2) {
+		if(h1.size() != h2.size() || h1.layout() != h2.layout())
+			return false;
+
+		for(std::size_t i = 0; i < h1.size(); ++i)
+			if(std::string(h1.name(i)) != h2.name(i) || h1[i].parent != h2[i].parent ||
+				h1[i].children_begin != h2[i].children_begin || h1[i].children_end != h2[i].children_end || h2.find(h2.name(i)) != h1.find(h1.name(i)))
+				return false;
+		return true;
+	}
+
+	/// saves and loads skeletons using an archive type
+	template<typename OARCHIVE, typename IARCHIVE>
+	void roundtrip(const std::vector<openanim::Skeleton>& skeletons, std::vector<openanim::Skeleton>& result) {
+		std::stringstream stream;
+		{
+			OARCHIVE out(stream);
+			out << skeletons;
+		}
+
+		IARCHIVE in(stream);
+		in >> result;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(serialization_skeletons) {
+	// two groups of skeletons, each sharing a hierarchy
+	const openanim::Skeleton s1 = randomSkeleton(37);
+	const openanim::Skeleton s2 = randomSkeleton(5);
+
+	std::vector<openanim::Skeleton> skeletons;
+	for(unsigned a = 0; a < 10; ++a) {
+		skeletons.push_back(a % 2 ? s1 : s2);
+		for(std::size_t ji = 0; ji < skeletons.back().size(); ++ji)
+			skeletons.back()[ji].tr() = randomTransform();
+	}
+
+	std::vector<openanim::Skeleton> binary, text;
+	roundtrip<boost::archive::binary_oarchive, boost::archive::binary_iarchive>(skeletons, binary);
+	roundtrip<boost::archive::text_oarchive, boost::archive::text_iarchive>(skeletons, text);
+
+	for(auto* loaded : {&binary, &text}) {
+		BOOST_REQUIRE_EQUAL(loaded->size(), skeletons.size());
+
+		for(std::size_t a = 0; a < skeletons.size(); ++a) {
+			const openanim::Skeleton& s = (*loaded)[a];
+
+			BOOST_CHECK(equal(s.pose().hierarchy(), skeletons[a].pose().hierarchy()));
+			BOOST_CHECK(equal(s.pose(), skeletons[a].pose()));
+
+			// the world cache is valid
+			BOOST_CHECK(equal(s.worldPose(), skeletons[a].worldPose()));
+
+			// the hierarchy sharing is preserved
+			BOOST_CHECK(s.isCompatibleWith((*loaded)[a % 2]));
+			BOOST_CHECK(!s.isCompatibleWith((*loaded)[(a + 1) % 2]));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(serialization_clips) {
+	const openanim::Skeleton s = randomSkeleton(19);
+	const auto& h = s.pose().sharedHierarchy();
+
+	openanim::ClipBuilder builder(h, 30.0f);
+	openanim::Pose pose(h);
+	for(unsigned f = 0; f < 30; ++f) {
+		for(std::size_t ji = 0; ji < pose.size(); ++ji)
+			pose[ji] = Transform(Imath::Eulerf((float)f * 0.1f, (float)ji * 0.1f, 0).toQuat(), Imath::V3f(0, 1, (float)f * 0.1f));
+		builder.addFrame(pose);
+	}
+	const openanim::AnimationClip clip = builder.build(1e-3f, 1e-3f);
+	const openanim::HalfPose compressed(s.pose(), true);
+	const openanim::Transform tr = randomTransform();
+
+	std::stringstream stream;
+	{
+		boost::archive::binary_oarchive out(stream);
+		out << s << clip << compressed << tr;
+	}
+
+	openanim::Skeleton loadedSkeleton;
+	openanim::AnimationClip loadedClip;
+	openanim::HalfPose loadedCompressed;
+	openanim::Transform loadedTr;
+	{
+		boost::archive::binary_iarchive in(stream);
+		in >> loadedSkeleton >> loadedClip >> loadedCompressed >> loadedTr;
+	}
+
+	BOOST_CHECK_EQUAL(loadedTr.translation, tr.translation);
+	BOOST_CHECK_EQUAL(loadedTr.rotation, tr.rotation);
+
+	// all objects share one hierarchy
+	BOOST_CHECK_EQUAL(loadedClip.sharedHierarchy(), loadedSkeleton.pose().sharedHierarchy());
+	BOOST_CHECK(loadedCompressed.isCompatibleWith(loadedSkeleton.pose()));
+
+	BOOST_CHECK_EQUAL(loadedClip.keyCount(), clip.keyCount());
+	openanim::Pose p1(h), p2(loadedClip.sharedHierarchy());
+	for(float t = 0.0f; t < clip.duration(); t += 0.1f) {
+		clip.sample(t, p1);
+		loadedClip.sample(t, p2);
+		BOOST_REQUIRE(equal(p1, p2));
+	}
+
+	compressed.decompress(p1);
+	loadedCompressed.decompress(p2);
+	BOOST_CHECK(equal(p1, p2));
+}
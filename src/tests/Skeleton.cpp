@@ -2,7 +2,10 @@
 #include "openanim/Skeleton.h"
 #undef private
 
-#include <queue>	
+#include <queue>
+#include <map>
+#include <algorithm>
+#include <type_traits>
 
 #include <boost/test/unit_test.hpp>
 
@@ -77,7 +80,7 @@ struct SkeletonTest {
 // the weak test just tests if the parent's ID is lower than children's, and that the children IDs don't overlap
 void weakTest(const openanim::Skeleton& h) {
 	unsigned counter = 0, childId = 1;
-	for(auto& bone : h) {
+	for(auto bone : h) {
 		BOOST_CHECK(bone.children().m_begin > counter);
 
 		BOOST_CHECK(bone.children().m_begin <= bone.children().m_end);
@@ -110,7 +113,7 @@ void strongTest(const openanim::Skeleton& h, const SkeletonTest& test) {
 		BOOST_CHECK_EQUAL(h[a].index(), a);
 		BOOST_CHECK((!h[a].hasParent() && flat[a].parent == -1) || (h.indexOf(h[a].parent()) == (std::size_t)flat[a].parent));
 
-		for(auto& c : h[a].children()) {
+		for(auto c : h[a].children()) {
 			const std::size_t pi = h.indexOf(c.parent());
 			const std::size_t ci = h.indexOf(c);
 			BOOST_CHECK_EQUAL(pi, flat[ci].parent);
@@ -337,3 +340,412 @@ BOOST_AUTO_TEST_CASE(randomized_children) {
 		doTest(h, test);
 	}
 }
+
+BOOST_AUTO_TEST_CASE(bulk_construction) {
+	for(unsigned a=0;a<100;++a) {
+		// the same randomized tree as above, built from a table
+		SkeletonTest test{"root", {}};
+		std::vector<openanim::Skeleton::Entry> table{
+			openanim::Skeleton::Entry{"root", -1, Transform(Imath::V3f(0, 0, 0))}
+		};
+		// table index of each test tree node (in the order of SkeletonTest::operator[])
+		std::vector<std::size_t> tableIndex{0};
+
+		unsigned totalCount = rand()%80;
+		for(unsigned b=0;b<totalCount;++b) {
+			std::stringstream name;
+			name << "joint_" << b;
+
+			std::size_t index = rand() % test.size();
+			test[index].children.push_back(SkeletonTest{name.str(), {}});
+
+			table.push_back(openanim::Skeleton::Entry{name.str(), (int)tableIndex[index], Transform(Imath::V3f(b, 0, 0))});
+
+			// recompute the test tree -> table index mapping
+			std::map<std::string, std::size_t> names;
+			for(std::size_t t=0;t<table.size();++t)
+				names[table[t].name] = t;
+			tableIndex.clear();
+			for(auto& i : test.flatten())
+				tableIndex.push_back(names[i.name]);
+		}
+
+		std::vector<std::size_t> mapping;
+		openanim::Skeleton h(table, &mapping);
+		doTest(h, test);
+
+		BOOST_REQUIRE_EQUAL(mapping.size(), table.size());
+		for(std::size_t t=0;t<table.size();++t) {
+			BOOST_CHECK_EQUAL(h[mapping[t]].name(), table[t].name);
+			BOOST_CHECK_EQUAL(h[mapping[t]].tr().translation, table[t].tr.translation);
+		}
+
+		// the table order should not matter for the structure of the result
+		std::vector<std::size_t> shuffle(table.size());
+		for(std::size_t t=0;t<table.size();++t)
+			shuffle[t] = t;
+		std::random_shuffle(shuffle.begin(), shuffle.end());
+
+		std::vector<std::size_t> inverse(table.size());
+		for(std::size_t t=0;t<table.size();++t)
+			inverse[shuffle[t]] = t;
+
+		std::vector<openanim::Skeleton::Entry> shuffled;
+		for(std::size_t t=0;t<table.size();++t) {
+			shuffled.push_back(table[shuffle[t]]);
+			if(shuffled.back().parent >= 0)
+				shuffled.back().parent = inverse[shuffled.back().parent];
+		}
+
+		openanim::Skeleton h2(shuffled);
+		weakTest(h2);
+		BOOST_REQUIRE_EQUAL(h2.size(), h.size());
+
+		std::map<std::string, std::string> parents;
+		for(auto j : h)
+			parents[j.name()] = j.hasParent() ? j.parent().name() : "";
+		for(auto j : h2)
+			BOOST_CHECK_EQUAL(parents[j.name()], j.hasParent() ? j.parent().name() : "");
+	}
+}
+
+BOOST_AUTO_TEST_CASE(edit_transaction) {
+	// the same randomized tree as above, built inside a single edit
+	for(unsigned a=0;a<100;++a) {
+		SkeletonTest test{"root", {}};
+
+		openanim::Skeleton h;
+		h.addRoot("root", Transform());
+
+		const openanim::Skeleton original = h;
+		{
+			openanim::Skeleton::Edit edit(h);
+
+			// edit entry index of each joint name
+			std::map<std::string, std::size_t> entries{{"root", 0}};
+
+			unsigned totalCount = rand()%80;
+			for(unsigned b=0;b<totalCount;++b) {
+				std::stringstream name;
+				name << "joint_" << b;
+
+				std::size_t index = rand() % test.size();
+				entries[name.str()] = edit.addChild(entries[test[index].name], Transform(), name.str());
+				test[index].children.push_back(SkeletonTest{name.str(), {}});
+			}
+
+			// the skeleton is not modified until the commit
+			BOOST_CHECK(h.isCompatibleWith(original));
+		}
+
+		doTest(h, test);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(edit_structure) {
+	openanim::Skeleton h;
+	h.addRoot("root", Transform());
+	h.addChild(h[0], Transform(), "first");
+	h.addChild(h[0], Transform(), "second");
+	h.addChild(h[1], Transform(Imath::V3f(1,2,3)), "first_a");
+
+	openanim::Skeleton graft;
+	graft.addRoot("graft", Transform());
+	graft.addChild(graft[0], Transform(), "graft_a");
+
+	{
+		openanim::Skeleton::Edit edit(h);
+
+		// reparent first_a under second, remove first
+		edit.reparent(3, 2);
+		edit.remove(1);
+
+		// new root and a grafted subtree
+		const std::size_t newRoot = edit.addRoot("new_root", Transform());
+		const std::size_t grafted = edit.graft(2, graft);
+
+		edit.commit();
+
+		BOOST_CHECK_EQUAL(edit.index(1), -1);
+		BOOST_CHECK_EQUAL(edit.index(newRoot), 0);
+		BOOST_CHECK_EQUAL(h[edit.index(grafted)].name(), "graft");
+		BOOST_CHECK_EQUAL(h[edit.index(3)].tr().translation, Imath::V3f(1,2,3));
+	}
+
+	doTest(h,
+		SkeletonTest{"new_root", {
+			SkeletonTest{"root", {
+				SkeletonTest{"second", {
+					SkeletonTest{"first_a", {}},
+					SkeletonTest{"graft", {
+						SkeletonTest{"graft_a", {}}
+					}}
+				}}
+			}}
+		}}
+	);
+
+	// removing a subtree removes all its descendants
+	{
+		openanim::Skeleton::Edit edit(h);
+		edit.remove(2);
+	}
+
+	doTest(h,
+		SkeletonTest{"new_root", {
+			SkeletonTest{"root", {}}
+		}}
+	);
+
+	// an empty edit keeps the hierarchy instance
+	const openanim::Skeleton unchanged = h;
+	{
+		openanim::Skeleton::Edit edit(h);
+	}
+	BOOST_CHECK(h.isCompatibleWith(unchanged));
+
+	// and so does an edit of transformations only
+	{
+		openanim::Skeleton::Edit edit(h);
+		edit.tr(1).translation = Imath::V3f(4,5,6);
+		edit.commit();
+
+		BOOST_CHECK_EQUAL(edit.index(1), 1);
+	}
+	BOOST_CHECK(h.isCompatibleWith(unchanged));
+	BOOST_CHECK_EQUAL(h[1].tr().translation, Imath::V3f(4,5,6));
+	BOOST_CHECK_EQUAL(h[1].world().translation, Imath::V3f(4,5,6));
+}
+
+BOOST_AUTO_TEST_CASE(name_lookup) {
+	openanim::Skeleton h;
+	BOOST_CHECK_EQUAL(h.pose().hierarchy().find("root"), -1);
+
+	h.addRoot("root", Transform());
+	BOOST_CHECK_EQUAL(h.pose().hierarchy().find("root"), 0);
+
+	for(unsigned a=0;a<200;++a) {
+		std::stringstream name;
+		name << "joint_" << a;
+
+		h.addChild(h[rand() % h.size()], Transform(), name.str());
+	}
+
+	// lookups of both incrementally built and bulk-constructed hierarchies
+	std::vector<openanim::Skeleton::Entry> table;
+	for(auto j : h)
+		table.push_back(openanim::Skeleton::Entry{j.name(), j.hasParent() ? (int)j.parent().index() : -1, Transform()});
+	const openanim::Skeleton h2(table);
+
+	for(const openanim::Skeleton* s : std::vector<const openanim::Skeleton*>{&h, &h2}) {
+		const openanim::Hierarchy& hierarchy = s->pose().hierarchy();
+
+		for(std::size_t a=0;a<s->size();++a) {
+			BOOST_CHECK_EQUAL(hierarchy.find((*s)[a].name()), (int)a);
+			BOOST_CHECK_EQUAL(hierarchy.find(std::string((*s)[a].name())), (int)a);
+			BOOST_CHECK_EQUAL(hierarchy.find((*s)[a].name(), openanim::Hierarchy::hash((*s)[a].name())), (int)a);
+		}
+
+		BOOST_CHECK_EQUAL(hierarchy.find("joint_200"), -1);
+		BOOST_CHECK_EQUAL(hierarchy.find(""), -1);
+		BOOST_CHECK_EQUAL(hierarchy.find("joint_"), -1);
+	}
+
+	// identical names are interned, and lookup returns the first one
+	h.addChild(h[0], Transform(), "joint_10");
+	const openanim::Hierarchy& hierarchy = h.pose().hierarchy();
+	const int first = hierarchy.find("joint_10");
+	BOOST_REQUIRE(first >= 0);
+	for(std::size_t a=0;a<h.size();++a)
+		if(std::string(h[a].name()) == "joint_10") {
+			BOOST_CHECK((int)a >= first);
+			BOOST_CHECK_EQUAL(hierarchy.name(a), hierarchy.name(first));
+		}
+}
+
+BOOST_AUTO_TEST_CASE(copy_and_move) {
+	openanim::Skeleton h;
+	h.addRoot("root", Transform());
+	h.addChild(h[0], Transform(Imath::V3f(1,0,0)), "first");
+	h.addChild(h[0], Transform(Imath::V3f(2,0,0)), "second");
+
+	// children access and modification through the joint proxies
+	BOOST_CHECK_EQUAL(h[0].children()[1].name(), "second");
+	for(auto c : h[0].children())
+		c.tr().translation.y = 5;
+	BOOST_CHECK_EQUAL(h[1].tr().translation, Imath::V3f(1,5,0));
+	BOOST_CHECK_EQUAL(h[2].tr().translation, Imath::V3f(2,5,0));
+
+	// a const skeleton only hands out read-only joints
+	const openanim::Skeleton& constH = h;
+	static_assert(!std::is_convertible<decltype(constH[0]), openanim::Skeleton::Joint>::value, "joints of a const skeleton have to be read-only");
+	static_assert(!std::is_convertible<decltype(*constH.begin()), openanim::Skeleton::Joint>::value, "joints of a const skeleton have to be read-only");
+	static_assert(!std::is_convertible<decltype(constH[0].children()[0]), openanim::Skeleton::Joint>::value, "joints of a const skeleton have to be read-only");
+	static_assert(!std::is_convertible<decltype(constH[1].parent()), openanim::Skeleton::Joint>::value, "joints of a const skeleton have to be read-only");
+	static_assert(std::is_convertible<decltype(h[0]), openanim::Skeleton::ConstJoint>::value, "joints have to be convertible to read-only joints");
+	BOOST_CHECK_EQUAL(constH[0].children()[1].name(), "second");
+	BOOST_CHECK_EQUAL(constH[1].tr().translation, Imath::V3f(1,5,0));
+	BOOST_CHECK_EQUAL(constH.indexOf(h[2]), 2u);
+
+	// joint iterators return the joint proxies by value
+	static_assert(std::is_same<std::iterator_traits<openanim::Skeleton::iterator>::iterator_category, std::input_iterator_tag>::value, "joint iterators are input iterators");
+	static_assert(std::is_same<std::iterator_traits<openanim::Skeleton::iterator>::reference, openanim::Skeleton::Joint>::value, "joint iterators return proxies by value");
+	unsigned count = 0;
+	for(auto it = h.begin(); it != h.end(); ++it, ++count)
+		BOOST_CHECK_EQUAL(it->index(), (*it).index());
+	BOOST_CHECK_EQUAL(count, 3u);
+
+	// a copy is independent of the original
+	openanim::Skeleton copy(h);
+	BOOST_CHECK(copy.isCompatibleWith(h));
+	copy[1].tr().translation = Imath::V3f(3,0,0);
+	BOOST_CHECK_EQUAL(h[1].tr().translation, Imath::V3f(1,5,0));
+	BOOST_CHECK_EQUAL(copy[1].parent().index(), 0u);
+	BOOST_CHECK_EQUAL(copy.indexOf(copy[2]), 2u);
+
+	// reading the pose keeps the world cache, and a copy doesn't copy it
+	copy.worldPose();
+	BOOST_CHECK_EQUAL(copy.pose().size(), 3u);
+	BOOST_CHECK_EQUAL(copy.m_firstDirty, copy.size());
+	const openanim::Skeleton copy2(copy);
+	BOOST_CHECK(copy2.m_dirty.empty());
+	BOOST_CHECK_EQUAL(copy2[1].world().translation, Imath::V3f(3,0,0));
+	copy.mutablePose();
+	BOOST_CHECK_EQUAL(copy.m_firstDirty, 0u);
+
+	// moving keeps the pose data
+	const Imath::V3f* data = copy.pose().translations();
+	openanim::Skeleton moved(std::move(copy));
+	BOOST_CHECK_EQUAL(moved.pose().translations(), data);
+	BOOST_CHECK_EQUAL(moved[1].tr().translation, Imath::V3f(3,0,0));
+	BOOST_CHECK_EQUAL(moved[2].parent().name(), "root");
+
+	// skeletons can be relocated freely in containers
+	std::vector<openanim::Skeleton> skeletons;
+	for(unsigned a=0;a<20;++a)
+		skeletons.push_back(h);
+	for(auto& s : skeletons) {
+		BOOST_CHECK_EQUAL(s.size(), 3u);
+		BOOST_CHECK_EQUAL(s[2].parent().children().size(), 2u);
+		BOOST_CHECK_EQUAL(s.end() - s.begin(), 3);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(depth_first_layout) {
+	for(unsigned a=0;a<20;++a) {
+		openanim::Skeleton s;
+		s.addRoot("root", Transform(Imath::V3f(0, 0, 0)));
+		const unsigned count = rand()%100;
+		for(unsigned b=0;b<count;++b) {
+			std::stringstream name;
+			name << "joint_" << b;
+
+			s.addChild(s[rand() % s.size()], Transform(Imath::V3f(b, 0, 0)), name.str());
+		}
+
+		const openanim::Hierarchy& bfs = s.pose().hierarchy();
+
+		std::vector<std::size_t> mapping;
+		auto dfs = std::make_shared<const openanim::Hierarchy>(bfs, openanim::Hierarchy::DepthFirst, &mapping);
+		BOOST_REQUIRE_EQUAL(dfs->size(), bfs.size());
+		BOOST_CHECK_EQUAL(dfs->layout(), openanim::Hierarchy::DepthFirst);
+
+		// the same joints and parent relationships
+		for(std::size_t i=0;i<bfs.size();++i) {
+			BOOST_CHECK_EQUAL(dfs->name(mapping[i]), bfs.name(i));
+			if(bfs[i].parent >= 0)
+				BOOST_CHECK_EQUAL((*dfs)[mapping[i]].parent, (int)mapping[bfs[i].parent]);
+			else
+				BOOST_CHECK_EQUAL((*dfs)[mapping[i]].parent, -1);
+		}
+
+		// each subtree is a single contiguous range
+		for(std::size_t i=0;i<dfs->size();++i) {
+			BOOST_CHECK((*dfs)[i].parent < (int)i);
+
+			for(std::size_t j=0;j<dfs->size();++j) {
+				bool descendant = false;
+				for(int p = (*dfs)[j].parent; p >= 0 && !descendant; p = (*dfs)[p].parent)
+					descendant = (p == (int)i);
+
+				BOOST_CHECK_EQUAL(descendant, j > i && j < dfs->subtreeEnd(i));
+			}
+		}
+
+		// siblings keep their order
+		for(std::size_t i=0;i<bfs.size();++i)
+			for(std::size_t c=bfs[i].children_begin+1;c<bfs[i].children_end;++c)
+				BOOST_CHECK(mapping[c-1] < mapping[c]);
+
+		// converting back results in the original layout
+		std::vector<std::size_t> back;
+		const openanim::Hierarchy converted(*dfs, openanim::Hierarchy::BreadthFirst, &back);
+		for(std::size_t i=0;i<bfs.size();++i) {
+			BOOST_CHECK_EQUAL(back[mapping[i]], i);
+			BOOST_CHECK_EQUAL(converted[i].parent, bfs[i].parent);
+			BOOST_CHECK_EQUAL(converted[i].children_begin, bfs[i].children_begin);
+			BOOST_CHECK_EQUAL(converted[i].children_end, bfs[i].children_end);
+		}
+
+		// remapped pose
+		const openanim::Pose pose(s.pose(), dfs, mapping);
+		for(std::size_t i=0;i<bfs.size();++i)
+			BOOST_CHECK_EQUAL(pose[mapping[i]].translation, s.pose()[i].translation);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(depth_first_children) {
+	// root -> {a -> {a1, a2}, b}
+	const std::vector<std::string> names = {"root", "a", "b", "a1", "a2"};
+	const std::vector<int> parents = {-1, 0, 0, 1, 1};
+
+	auto dfs = std::make_shared<const openanim::Hierarchy>(names, parents, nullptr, openanim::Hierarchy::DepthFirst);
+	BOOST_REQUIRE_EQUAL(dfs->layout(), openanim::Hierarchy::DepthFirst);
+
+	openanim::Skeleton s((openanim::Pose(dfs)));
+
+	BOOST_REQUIRE_EQUAL(s[0].children().size(), 2u);
+	BOOST_CHECK_EQUAL(s[0].children()[0].name(), "a");
+	BOOST_CHECK_EQUAL(s[0].children()[1].name(), "b");
+
+	const int ja = dfs->find("a");
+	BOOST_REQUIRE_EQUAL(s[ja].children().size(), 2u);
+	BOOST_CHECK_EQUAL(s[ja].children()[0].name(), "a1");
+	BOOST_CHECK_EQUAL(s[ja].children()[1].name(), "a2");
+
+	BOOST_CHECK(s[dfs->find("b")].children().empty());
+	BOOST_CHECK(s[dfs->find("a2")].children().empty());
+
+	std::vector<std::string> children;
+	for(auto c : s[0].children())
+		children.push_back(c.name());
+	BOOST_CHECK(children == std::vector<std::string>({"a", "b"}));
+
+	// the same children as in the breadth-first layout, for random hierarchies
+	for(unsigned a=0;a<20;++a) {
+		openanim::Skeleton bfs;
+		bfs.addRoot("root", Transform(Imath::V3f(0, 0, 0)));
+		const unsigned count = rand()%100;
+		for(unsigned b=0;b<count;++b) {
+			std::stringstream name;
+			name << "joint_" << b;
+
+			bfs.addChild(bfs[rand() % bfs.size()], Transform(Imath::V3f(b, 0, 0)), name.str());
+		}
+
+		std::vector<std::size_t> mapping;
+		openanim::Skeleton converted((openanim::Pose(std::make_shared<const openanim::Hierarchy>(bfs.pose().hierarchy(), openanim::Hierarchy::DepthFirst, &mapping))));
+
+		for(std::size_t i=0;i<bfs.size();++i) {
+			const auto expected = bfs[i].children();
+			const auto result = converted[mapping[i]].children();
+			BOOST_REQUIRE_EQUAL(result.size(), expected.size());
+
+			std::size_t c = 0;
+			for(auto it = result.begin(); it != result.end(); ++it, ++c) {
+				BOOST_CHECK_EQUAL(it->name(), expected[c].name());
+				BOOST_CHECK_EQUAL(it->parent().index(), mapping[i]);
+			}
+		}
+	}
+}
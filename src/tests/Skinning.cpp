@@ -0,0 +1,131 @@
+#include "openanim/Skeleton.h"
+#include "openanim/Skinning.h"
+
+#include "Common.h"
+
+#include <ImathEuler.h>
+
+#include <boost/test/unit_test.hpp>
+
+using std::cout;
+using std::endl;
+
+using openanim::Transform;
+using tests::randomTransform;
+using tests::randomSkeleton;
+
+namespace {
+	static const float EPS = 1e-3f;
+
+	Imath::V3f randomVector() {
+		return Imath::V3f(
+			(float)(rand() % 200 - 100) / 10.0f,
+			(float)(rand() % 200 - 100) / 10.0f,
+			(float)(rand() % 200 - 100) / 10.0f);
+	}
+
+	/// random mesh data - vertex count crossing multiple chunks, with a scalar tail
+	struct Mesh {
+		Mesh(std::size_t jointCount, unsigned influences) : positions(2053), normals(2053), joints(2053 * influences), weights(2053 * influences) {
+			for(std::size_t v = 0; v < positions.size(); ++v) {
+				positions[v] = randomVector();
+				normals[v] = randomVector().normalized();
+
+				for(unsigned i = 0; i < influences; ++i) {
+					joints[v * influences + i] = rand() % jointCount;
+					weights[v * influences + i] = (float)(rand() % 100 + 1);
+				}
+			}
+		}
+
+		std::vector<Imath::V3f> positions, normals;
+		std::vector<int> joints;
+		std::vector<float> weights;
+	};
+}
+
+BOOST_AUTO_TEST_CASE(skinning_linear) {
+	openanim::Skeleton s = randomSkeleton(40);
+	const openanim::Pose bind = s.worldPose();
+
+	for(unsigned influences = 1; influences <= openanim::Skinning::s_maxInfluences; influences *= 2) {
+		const Mesh mesh(s.size(), influences);
+		const openanim::Skinning skinning(bind, mesh.positions.data(), mesh.normals.data(), mesh.positions.size(), mesh.joints.data(), mesh.weights.data(), influences);
+
+		std::vector<Imath::V3f> positions(mesh.positions.size()), normals(mesh.positions.size());
+
+		// the bind pose doesn't deform the mesh
+		skinning.deform(bind, positions.data(), normals.data());
+		for(std::size_t v = 0; v < positions.size(); ++v) {
+			BOOST_CHECK_SMALL((positions[v] - mesh.positions[v]).length(), EPS);
+			BOOST_CHECK_SMALL((normals[v] - mesh.normals[v]).length(), EPS);
+		}
+
+		// weighted sum of rigidly transformed vertices
+		for(std::size_t ji = 0; ji < s.size(); ++ji)
+			s[ji].tr() = randomTransform();
+		const openanim::Pose& world = s.worldPose();
+
+		skinning.deform(world, positions.data(), normals.data());
+		for(std::size_t v = 0; v < positions.size(); ++v) {
+			Imath::V3f p(0, 0, 0), n(0, 0, 0);
+			float sum = 0.0f;
+			for(unsigned i = 0; i < influences; ++i) {
+				const int j = mesh.joints[v * influences + i];
+				const float w = mesh.weights[v * influences + i];
+				const Transform skin = bind[j].inverse() * world[j];
+
+				p += (mesh.positions[v] * skin.rotation + skin.translation) * w;
+				n += (mesh.normals[v] * skin.rotation) * w;
+				sum += w;
+			}
+
+			BOOST_CHECK_SMALL((positions[v] - p / sum).length(), EPS);
+			BOOST_CHECK_SMALL((normals[v] - n.normalized()).length(), EPS);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(skinning_dual_quaternion) {
+	openanim::Skeleton s = randomSkeleton(40);
+	const openanim::Pose bind = s.worldPose();
+
+	for(std::size_t ji = 0; ji < s.size(); ++ji)
+		s[ji].tr() = randomTransform();
+	const openanim::Pose& world = s.worldPose();
+
+	for(unsigned influences = 1; influences <= openanim::Skinning::s_maxInfluences; influences *= 2) {
+		const Mesh mesh(s.size(), influences);
+		const openanim::Skinning skinning(bind, mesh.positions.data(), mesh.normals.data(), mesh.positions.size(), mesh.joints.data(), mesh.weights.data(), influences);
+
+		std::vector<Imath::V3f> positions(mesh.positions.size()), normals(mesh.positions.size());
+		skinning.deform(world, positions.data(), normals.data(), openanim::Skinning::DualQuaternion);
+
+		for(std::size_t v = 0; v < positions.size(); ++v) {
+			// reference dual quaternion blend
+			Imath::Quatf real(0, 0, 0, 0), dual(0, 0, 0, 0), first;
+			for(unsigned i = 0; i < influences; ++i) {
+				const int j = mesh.joints[v * influences + i];
+				float w = mesh.weights[v * influences + i];
+				const Transform skin = bind[j].inverse() * world[j];
+
+				if(i == 0)
+					first = skin.rotation;
+				else if((first ^ skin.rotation) < 0.0f)
+					w = -w;
+
+				real += skin.rotation * w;
+				dual += Imath::Quatf(0.0f, skin.translation * 0.5f) * skin.rotation * w;
+			}
+
+			const float length = real.length();
+			real = real * (1.0f / length);
+			dual = dual * (1.0f / length);
+
+			const Imath::V3f translation = (dual * ~real).v * 2.0f;
+
+			BOOST_CHECK_SMALL((positions[v] - (mesh.positions[v] * real + translation)).length(), EPS);
+			BOOST_CHECK_SMALL((normals[v] - mesh.normals[v] * real).length(), EPS);
+		}
+	}
+}
@@ -1,5 +1,7 @@
 #include "openanim/Transform.h"
 
+#include "Common.h"
+
 #include <ImathEuler.h>
 
 #include <boost/test/unit_test.hpp>
@@ -7,6 +9,8 @@
 using std::cout;
 using std::endl;
 
+using tests::EPS;
+
 const float compareMatrices(const Imath::M44f& m1, const Imath::M44f& m2) {
 	// cout << m1 << endl << m2 << endl << endl;
 
@@ -17,10 +21,6 @@ const float compareMatrices(const Imath::M44f& m1, const Imath::M44f& m2) {
 	return result;
 }
 
-namespace {
-	static const float EPS = 1e-4f;
-}
-
 /////////////
 // tests mainly the correspondence between the transformation class
 // and a 4x4 matrix.
@@ -135,3 +135,32 @@ BOOST_AUTO_TEST_CASE(transform_multiplication) {
 		);
 	}
 }
+
+BOOST_AUTO_TEST_CASE(transform_inverse) {
+	std::vector<std::pair<Imath::Eulerf, Imath::V3f>> data = {
+		{ Imath::Eulerf(0,0,0), Imath::V3f(0,0,0) },
+		{ Imath::Eulerf(0,0,0), Imath::V3f(1,2,3) },
+		{ Imath::Eulerf(-25,20,36), Imath::V3f(0,0,0) },
+		{ Imath::Eulerf(89,-93,63), Imath::V3f(7,6,5) }
+	};
+
+	for(auto& i : data) {
+		const openanim::Transform t(i.first.toQuat(), i.second);
+
+		BOOST_REQUIRE_SMALL(
+			compareMatrices(
+				t.inverse().toMatrix44(),
+				toMatrix44(i).inverse()
+			),
+			EPS
+		);
+
+		BOOST_REQUIRE_SMALL(
+			compareMatrices(
+				(t * t.inverse()).toMatrix44(),
+				Imath::M44f()
+			),
+			EPS
+		);
+	}
+}